@@ -0,0 +1,276 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <pybind11/numpy.h>
+
+#include <riflib/types.hh>
+#include <riflib/RifBase.hh>
+#include <riflib/RifFactory.hh>
+
+#include <utility/io/izstream.hh>
+#include <utility/file/file_sys_util.hh>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// batch scoring of docked positions against a loaded RIF and target grids, no poses involved
+// the bindings library is built without openmp (see apps/rosetta/CMakeLists.txt), so the
+// loops below use std::thread and run with the GIL released
+
+using namespace ::devel::scheme;
+
+namespace py = pybind11;
+
+typedef py::array_t< float, py::array::c_style | py::array::forcecast > FloatArray;
+typedef py::array_t< int32_t, py::array::c_style | py::array::forcecast > IntArray;
+
+
+template< class F >
+void parallel_for_chunks( int64_t n, int nthreads, F const & f ){
+	if( nthreads <= 0 ) nthreads = std::max( 1u, std::thread::hardware_concurrency() );
+	nthreads = (int)std::max<int64_t>( 1, std::min<int64_t>( nthreads, n/1024+1 ) );
+	if( nthreads == 1 ){ f( 0, n ); return; }
+	std::vector<std::thread> threads;
+	int64_t const chunk = ( n + nthreads - 1 ) / nthreads;
+	for( int ith = 0; ith < nthreads; ++ith ){
+		int64_t const beg = ith * chunk, end = std::min( n, beg + chunk );
+		if( beg >= end ) break;
+		threads.emplace_back( [&f,beg,end](){ f( beg, end ); } );
+	}
+	for( auto & t : threads ) t.join();
+}
+
+// accepts (N,4,4) homogeneous or (N,3,4) affine, row major
+int64_t check_xform_array( py::buffer_info const & info ){
+	if( info.ndim != 3 || ( info.shape[1] != 3 && info.shape[1] != 4 ) || info.shape[2] != 4 ){
+		throw std::runtime_error( "xforms must have shape (N,4,4) or (N,3,4)" );
+	}
+	return info.shape[0];
+}
+
+inline EigenXform
+xform_from_array( float const * p ){
+	EigenXform x;
+	for( int i = 0; i < 3; ++i ){
+		for( int j = 0; j < 3; ++j ) x.linear()(i,j) = p[4*i+j];
+		x.translation()[i] = p[4*i+3];
+	}
+	return x;
+}
+
+
+struct PyRif {
+	RifPtr rif_;
+	std::string type_, description_;
+
+	PyRif( std::string const & fname ){
+		if( !utility::file::file_exists( fname ) ) throw std::runtime_error( "no such rif file: " + fname );
+		type_ = get_rif_type_from_file( fname );
+		RifFactoryConfig config;
+		config.rif_type = type_;
+		shared_ptr<RifFactory> rif_factory = create_rif_factory( config );
+		rif_ = rif_factory->create_rif_from_file( fname, description_ );
+		if( !rif_ ) throw std::runtime_error( "rif creation from file failed! " + fname );
+	}
+
+	// returns ( scores[N,max_rots], rotamers[N,max_rots], nrots[N] ), best score first, unused slots are 0 / -1
+	py::tuple
+	score_xforms( FloatArray xforms, int max_rots, int nthreads ) const {
+		py::buffer_info xinfo = xforms.request();
+		int64_t const n = check_xform_array( xinfo );
+		int64_t const stride = xinfo.shape[1] * 4;
+		if( max_rots <= 0 ) throw std::runtime_error( "max_rots must be > 0" );
+
+		FloatArray scores( std::vector<size_t>{ (size_t)n, (size_t)max_rots } );
+		IntArray   rots  ( std::vector<size_t>{ (size_t)n, (size_t)max_rots } );
+		IntArray   nrots ( std::vector<size_t>{ (size_t)n } );
+		float const * xp = (float const *)xinfo.ptr;
+		float   * sp = (float   *)scores.request().ptr;
+		int32_t * rp = (int32_t *)rots  .request().ptr;
+		int32_t * np = (int32_t *)nrots .request().ptr;
+		{
+			py::gil_scoped_release release;
+			RifBase const & rif( *rif_ );
+			parallel_for_chunks( n, nthreads, [&]( int64_t beg, int64_t end ){
+				std::vector< std::pair< float, int > > rotscores;
+				for( int64_t i = beg; i < end; ++i ){
+					rotscores.clear();
+					rif.get_rotamers_for_xform( xform_from_array( xp + i*stride ), rotscores );
+					std::sort( rotscores.begin(), rotscores.end() );
+					int const nr = std::min<int>( max_rots, rotscores.size() );
+					np[i] = nr;
+					for( int k = 0; k < max_rots; ++k ){
+						sp[i*max_rots+k] = k < nr ? rotscores[k].first  : 0.0f;
+						rp[i*max_rots+k] = k < nr ? rotscores[k].second : -1;
+					}
+				}
+			});
+		}
+		return py::make_tuple( scores, rots, nrots );
+	}
+
+	// best single rif score per xform, 0 for empty bins
+	FloatArray
+	best_scores( FloatArray xforms, int nthreads ) const {
+		py::buffer_info xinfo = xforms.request();
+		int64_t const n = check_xform_array( xinfo );
+		int64_t const stride = xinfo.shape[1] * 4;
+		FloatArray scores( std::vector<size_t>{ (size_t)n } );
+		float const * xp = (float const *)xinfo.ptr;
+		float * sp = (float *)scores.request().ptr;
+		{
+			py::gil_scoped_release release;
+			RifBase const & rif( *rif_ );
+			parallel_for_chunks( n, nthreads, [&]( int64_t beg, int64_t end ){
+				std::vector< std::pair< float, int > > rotscores;
+				for( int64_t i = beg; i < end; ++i ){
+					rotscores.clear();
+					rif.get_rotamers_for_xform( xform_from_array( xp + i*stride ), rotscores );
+					float best = 0.0f;
+					for( auto const & rs : rotscores ) best = std::min( best, rs.first );
+					sp[i] = best;
+				}
+			});
+		}
+		return scores;
+	}
+
+	py::array_t<uint64_t>
+	bin_keys( FloatArray xforms, int nthreads ) const {
+		py::buffer_info xinfo = xforms.request();
+		int64_t const n = check_xform_array( xinfo );
+		int64_t const stride = xinfo.shape[1] * 4;
+		py::array_t<uint64_t> keys( std::vector<size_t>{ (size_t)n } );
+		float const * xp = (float const *)xinfo.ptr;
+		uint64_t * kp = (uint64_t *)keys.request().ptr;
+		{
+			py::gil_scoped_release release;
+			RifBase const & rif( *rif_ );
+			parallel_for_chunks( n, nthreads, [&]( int64_t beg, int64_t end ){
+				for( int64_t i = beg; i < end; ++i ) kp[i] = rif.get_bin_key( xform_from_array( xp + i*stride ) );
+			});
+		}
+		return keys;
+	}
+};
+
+
+// per-atom-type target grids, as cached by rif_dock_test / rifgen (*.rosetta_field.gz, *.rf.gz)
+struct PyTargetGrids {
+	std::vector< shared_ptr< VoxelArray > > grids_; // indexed by atype
+
+	void load_grid( int atype, std::string const & fname ){
+		if( atype < 0 ) throw std::runtime_error( "atype must be >= 0" );
+		if( !utility::file::file_exists( fname ) ) throw std::runtime_error( "no such grid file: " + fname );
+		shared_ptr< VoxelArray > grid = make_shared< VoxelArray >();
+		utility::io::izstream in( fname, std::ios::binary );
+		grid->load( in );
+		in.close();
+		if( atype >= (int)grids_.size() ) grids_.resize( atype+1 );
+		grids_[atype] = grid;
+	}
+
+	bool has_grid( int atype ) const { return atype >= 0 && atype < (int)grids_.size() && grids_[atype]; }
+
+	inline float energy( float const * xyz, int32_t atype ) const {
+		if( atype < 0 || atype >= (int)grids_.size() || !grids_[atype] ) return 0.0f;
+		return grids_[atype]->at( xyz[0], xyz[1], xyz[2] );
+	}
+
+	// coords (N,3), atypes (N,) -> per atom energies (N,)
+	FloatArray
+	atom_energies( FloatArray coords, IntArray atypes, int nthreads ) const {
+		py::buffer_info cinfo = coords.request(), tinfo = atypes.request();
+		if( cinfo.ndim != 2 || cinfo.shape[1] != 3 ) throw std::runtime_error( "coords must have shape (N,3)" );
+		if( tinfo.ndim != 1 || tinfo.shape[0] != cinfo.shape[0] ) throw std::runtime_error( "atypes must have shape (N,)" );
+		int64_t const n = cinfo.shape[0];
+		FloatArray energies( std::vector<size_t>{ (size_t)n } );
+		float const * cp = (float const *)cinfo.ptr;
+		int32_t const * tp = (int32_t const *)tinfo.ptr;
+		float * ep = (float *)energies.request().ptr;
+		{
+			py::gil_scoped_release release;
+			parallel_for_chunks( n, nthreads, [&]( int64_t beg, int64_t end ){
+				for( int64_t i = beg; i < end; ++i ) ep[i] = energy( cp + 3*i, tp[i] );
+			});
+		}
+		return energies;
+	}
+
+	// coords (P,A,3), atypes (A,) shared by all poses -> total energy per pose (P,)
+	FloatArray
+	pose_energies( FloatArray coords, IntArray atypes, int nthreads ) const {
+		py::buffer_info cinfo = coords.request(), tinfo = atypes.request();
+		if( cinfo.ndim != 3 || cinfo.shape[2] != 3 ) throw std::runtime_error( "coords must have shape (P,A,3)" );
+		if( tinfo.ndim != 1 || tinfo.shape[0] != cinfo.shape[1] ) throw std::runtime_error( "atypes must have shape (A,)" );
+		int64_t const npose = cinfo.shape[0], natom = cinfo.shape[1];
+		FloatArray energies( std::vector<size_t>{ (size_t)npose } );
+		float const * cp = (float const *)cinfo.ptr;
+		int32_t const * tp = (int32_t const *)tinfo.ptr;
+		float * ep = (float *)energies.request().ptr;
+		{
+			py::gil_scoped_release release;
+			parallel_for_chunks( npose, nthreads, [&]( int64_t beg, int64_t end ){
+				for( int64_t ip = beg; ip < end; ++ip ){
+					float const * pose_xyz = cp + ip*natom*3;
+					float e = 0.0f;
+					for( int64_t ia = 0; ia < natom; ++ia ) e += energy( pose_xyz + 3*ia, tp[ia] );
+					ep[ip] = e;
+				}
+			});
+		}
+		return energies;
+	}
+};
+
+
+PYBIND11_DECLARE_HOLDER_TYPE(T, std::shared_ptr<T>);
+
+PYBIND11_PLUGIN(_pysetta_riflib) {
+    py::module m( "_pysetta_riflib", R"doc(rif and target grid batch scoring
+
+    import numpy as np
+    from pysetta.riflib import Rif, TargetGrids
+
+    rif = Rif( "rif_64_target_sca0.8_noKR.rif.gz_BOUND_256.0.xrif.gz" )
+    x = np.tile( np.eye(4,dtype='f4'), (1000,1,1) )
+    scores, rots, nrots = rif.score_xforms( x, max_rots=4 )
+
+    grids = TargetGrids()
+    for atype in range(1,23):
+        grids.load_grid( atype, "__RF_target.pdb_CEN_trhash12345_resl0.25_osamp2_replonlybdry__atype%i.rosetta_field.gz"%atype )
+    coords = np.zeros( (10,50,3), dtype='f4' ) # 10 poses of 50 atoms
+    atypes = np.full( 50, 6, dtype='i4' )     # rosetta atom type of each atom
+    e = grids.pose_energies( coords, atypes ) # (10,) energies
+)doc" );
+
+	py::class_< PyRif, std::shared_ptr<PyRif> >( m, "Rif" )
+		.def( py::init< std::string const & >(), py::arg("fname") )
+		.def_readonly( "type", &PyRif::type_ )
+		.def_readonly( "description", &PyRif::description_ )
+		.def( "size"     , [](PyRif const & r){ return r.rif_->size(); } )
+		.def( "cart_resl", [](PyRif const & r){ return r.rif_->cart_resl(); } )
+		.def( "ang_resl" , [](PyRif const & r){ return r.rif_->ang_resl(); } )
+		.def( "score_xforms", &PyRif::score_xforms,
+			"(N,4,4) xforms -> (scores[N,max_rots], rotamers[N,max_rots], nrots[N]), best first",
+			py::arg("xforms"), py::arg("max_rots") = 8, py::arg("nthreads") = 0 )
+		.def( "best_scores", &PyRif::best_scores, "(N,4,4) xforms -> best rif score per xform",
+			py::arg("xforms"), py::arg("nthreads") = 0 )
+		.def( "bin_keys", &PyRif::bin_keys, "(N,4,4) xforms -> rif bin key per xform",
+			py::arg("xforms"), py::arg("nthreads") = 0 )
+	;
+
+	py::class_< PyTargetGrids, std::shared_ptr<PyTargetGrids> >( m, "TargetGrids" )
+		.def( py::init<>() )
+		.def( "load_grid", &PyTargetGrids::load_grid, "load the cached grid for one atom type",
+			py::arg("atype"), py::arg("fname") )
+		.def( "has_grid", &PyTargetGrids::has_grid )
+		.def( "atom_energies", &PyTargetGrids::atom_energies, "(N,3) coords, (N,) atypes -> (N,) energies",
+			py::arg("coords"), py::arg("atypes"), py::arg("nthreads") = 0 )
+		.def( "pose_energies", &PyTargetGrids::pose_energies, "(P,A,3) coords, (A,) atypes -> (P,) energies",
+			py::arg("coords"), py::arg("atypes"), py::arg("nthreads") = 0 )
+	;
+
+    return m.ptr();
+}
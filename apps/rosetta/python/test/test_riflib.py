@@ -0,0 +1,36 @@
+# checks the pysetta.riflib bindings without needing a rif or grid files;
+# run with the installed pysetta on PYTHONPATH: python test_riflib.py
+import numpy as np
+from pysetta.riflib import Rif, TargetGrids
+
+def raises( f, *args ):
+	try:
+		f( *args )
+	except RuntimeError:
+		return True
+	return False
+
+grids = TargetGrids()
+assert not grids.has_grid( 1 )
+assert not grids.has_grid( -1 )
+assert raises( grids.load_grid, 1, "no_such_grid_file.rosetta_field.gz" )
+assert raises( grids.load_grid, -1, "no_such_grid_file.rosetta_field.gz" )
+
+# atom types without a loaded grid contribute zero energy
+coords = np.random.rand( 10, 50, 3 ).astype( 'f4' )
+atypes = np.arange( 50, dtype='i4' )
+e = grids.pose_energies( coords, atypes )
+assert e.shape == (10,)
+assert np.all( e == 0 )
+e = grids.atom_energies( coords[0], atypes, nthreads=2 )
+assert e.shape == (50,)
+assert np.all( e == 0 )
+
+assert raises( grids.pose_energies, coords[0], atypes )
+assert raises( grids.pose_energies, coords, atypes[:10] )
+assert raises( grids.atom_energies, coords, atypes )
+assert raises( grids.atom_energies, coords[0], atypes[:10] )
+
+assert raises( Rif, "no_such_rif_file.xrif.gz" )
+
+print( "test_riflib ok" )
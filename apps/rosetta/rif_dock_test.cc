@@ -46,6 +46,7 @@
 	// #include <scheme/actor/BackboneActor.hh>
 	// #include <scheme/actor/VoxelActor.hh>
 	#include <scheme/kinematics/Director.hh>
+	#include <scheme/util/MemoryPlacement.hh>
 	// #include <scheme/kinematics/SceneBase.hh>
 	// #include <scheme/nest/pmap/OriTransMap.hh>
 	// #include <scheme/numeric/rand_xform.hh>
@@ -84,6 +85,7 @@
 	#include <riflib/rifdock_tasks/HSearchTasks.hh>
 	#include <riflib/rifdock_tasks/SetFaModeTasks.hh>
 	#include <riflib/rifdock_tasks/HackPackTasks.hh>
+	#include <riflib/rifdock_tasks/GridMinTasks.hh>
 	#include <riflib/rifdock_tasks/RosettaScoreAndMinTasks.hh>
 	#include <riflib/rifdock_tasks/CompileAndFilterResultsTasks.hh>
 	#include <riflib/rifdock_tasks/OutputResultsTasks.hh>
@@ -453,6 +455,8 @@ int main(int argc, char *argv[]) {
 		}
 	}
 
+	::scheme::util::MemoryPlacement const big_table_placement( opt.rif_numa_interleave, opt.rif_huge_pages );
+
 	std::vector< VoxelArrayPtr > target_field_by_atype;
 	std::vector< std::vector< VoxelArrayPtr > > target_bounding_by_atype;
 	{
@@ -533,6 +537,18 @@ int main(int argc, char *argv[]) {
 				}
 			}
 		}
+		if( big_table_placement.any() ){
+			size_t nbytes = 0;
+			std::vector< VoxelArrayPtr > grids( target_field_by_atype );
+			for( auto const & grids_at_resl : target_bounding_by_atype ) grids.insert( grids.end(), grids_at_resl.begin(), grids_at_resl.end() );
+			for( VoxelArrayPtr vap : grids ){
+				if( vap == nullptr ) continue;
+				size_t const grid_bytes = vap->num_elements() * sizeof( *vap->data() );
+				if( ::scheme::util::place_memory( vap->data(), grid_bytes, big_table_placement ) ) nbytes += grid_bytes;
+			}
+			std::cout << "numa interleave: " << opt.rif_numa_interleave << " huge pages: " << opt.rif_huge_pages
+			          << " applied to " << ::devel::scheme::KMGT( nbytes ) << "B of target grids" << std::endl;
+		}
 	}
 
 
@@ -660,6 +676,15 @@ int main(int argc, char *argv[]) {
 				}
 				rif_ptr = rif_factory->create_rif_from_file( rif_file, rif_dscr );
 				runtime_assert_msg( rif_ptrs[i_readmap] , "rif creation from file failed! " + rif_file );
+				if( opt.rif_prefilter_bits_per_key > 0 && ! rif_ptr->has_prefilter() ){
+					rif_ptr->build_prefilter( opt.rif_prefilter_bits_per_key );
+				}
+				if( big_table_placement.any() && ! rif_ptr->place_memory( big_table_placement ) ){
+					#ifdef USE_OPENMP
+					#pragma omp critical
+					#endif
+					std::cout << "WARNING: numa / huge page placement not (fully) applied to " << rif_file << std::endl;
+				}
 				if( opt.VERBOSE ){
 					#ifdef USE_OPENMP
 					#pragma omp critical
@@ -862,6 +887,8 @@ int main(int argc, char *argv[]) {
 	}
 
 
+    expand_silent_scaffold_fnames( opt );
+
     if( 0 == opt.scaffold_fnames.size() ){
         std::cout << "WARNING: NO SCAFFOLDS!!!!!!" << std::endl;
     }
@@ -890,6 +917,8 @@ int main(int argc, char *argv[]) {
 
 			runtime_assert( rot_index_p );
 			std::string scafftag = utility::file_basename( utility::file::file_basename( scaff_fname ) );
+			std::string silent_fname, silent_tag;
+			if ( split_silent_scaffold_fname( scaff_fname, silent_fname, silent_tag ) ) scafftag = silent_scaffold_tag( silent_fname, silent_tag );
 
 			std::cout << "/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////" << std::endl;
 			std::cout << "/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////" << std::endl;
@@ -926,6 +955,10 @@ int main(int argc, char *argv[]) {
 
 
 			shared_ptr<std::vector<EigenXform>> seeding_positions = setup_seeding_positions( opt, pd, scaffold_provider, iscaff );
+			bool const fft_seeded = ! seeding_positions && opt.fft_seed_npeaks > 0;
+			if ( fft_seeded ) {
+				seeding_positions = setup_fft_seeding_positions( opt, pd, scaffold_provider, target_field_by_atype, pose_center(target) );
+			}
 
 			if ( opt.dump_scaff_bb_hbond_rays ) dump_bbhbond_actors( test_data_cache );
 
@@ -962,6 +995,10 @@ int main(int argc, char *argv[]) {
 
             	rso_config.ignore_rifres_if_worse_than = opt.ignore_rifres_if_worse_than;
 
+            	if ( opt.hsearch_bounded_scoring ) {
+            		rso_config.score_cut_per_thread = make_shared<std::vector<float>>( omp_max_threads_1(), 9e9 );
+            	}
+
 
             if ( opt.require_satisfaction > 0 && rif_ptrs.back()->has_sat_data_slots() ) {
             	if ( ! donor_acceptors_from_file && opt.num_hotspots == 0 ) {
@@ -1059,6 +1096,12 @@ int main(int argc, char *argv[]) {
 	                search_diameter = 4.0;
 				}
 
+				// fft seeds already place the scaffold, only search locally around them
+				if ( fft_seeded ) {
+					target_center = F3(0, 0, 0);
+					search_diameter = opt.fft_seed_search_diameter;
+				}
+
 				double cart_grid = resl0*hsearch_scale_factor/sqrt(3); // 1.5 is a big hack here.... 2 would be more "correct"
 				double hackysin = std::min( 1.0, resl0*hsearch_scale_factor/2.0/ body_radius );
 
@@ -1095,6 +1138,10 @@ int main(int argc, char *argv[]) {
 				std::cout << "cartcen to corner (cart. covering radius): " << sqrt(3.0)*cart_grid/2.0 << std::endl;
 				nest_director = make_shared<RifDockNestDirector>( rot_resl_deg0, lb, ub, nc, 1 );
 				std::cout << "NestDirector:" << endl << *nest_director << endl;
+				if ( opt.ori_cache_max_MB > 0 ) {
+					int n_cached = nest_director->init_ori_cache( RESLS.size()-1, size_t(opt.ori_cache_max_MB)*1024*1024 );
+					std::cout << "orientation tables cached for resls 0-" << n_cached-1 << " of " << RESLS.size() << std::endl;
+				}
 				std::cout << "nest size0:    " << nest_director->size(0, RifDockIndex()).nest_index << std::endl;
 				std::cout << "size of search space: ~" << float(nest_director->size(0, RifDockIndex()).nest_index)*1024.0*1024.0*1024.0 << " grid points" << std::endl;
 
@@ -1112,7 +1159,7 @@ int main(int argc, char *argv[]) {
 					director_list.push_back( make_shared<RifDockScaffoldDirector>(scaffold_provider, 1 ) );
 				}
 				if ( seeding_positions ) {
-					director_list.push_back( make_shared<RifDockSeedingDirector>(seeding_positions, 1, -1 ) );
+					director_list.push_back( make_shared<RifDockSeedingDirector>(seeding_positions, 1, fft_seeded ? opt.fft_seed_ori_resl : -1 ) );
 				}
 
 				director = make_shared<RifDockDirector>(director_list);
@@ -1209,14 +1256,14 @@ int main(int argc, char *argv[]) {
 					}
 
 
-					SearchPointWithRots result;
+					std::vector< std::pair<intRot,intRot> > rotamers;
 
 					if ( packing_objectives.size() ) {
-						float score = packing_objectives.back()->score_with_rotamers(*scene_minimal, result.rotamers());
+						float score = packing_objectives.back()->score_with_rotamers(*scene_minimal, rotamers);
 						std::cout << "Packing score: " << score << std::endl;
 
 						std::cout << "Packing rotamers: " << std::endl;
-						for ( std::pair<intRot,intRot> pair : result.rotamers() ) {
+						for ( std::pair<intRot,intRot> pair : rotamers ) {
 							int l_ires = pair.first;
 							int irot = pair.second;
 							int g_ires = test_data_cache->scaffres_l2g_p->at( l_ires );
@@ -1250,7 +1297,7 @@ int main(int argc, char *argv[]) {
 							bb_positions.push_back( scene_minimal->template get_actor<BBActor>(1,i_actor).position() );
 						}
 
-						std::vector<float> unsat_scores = unsat_manager->get_buried_unsats( initial_burial, result.rotamers(), bb_positions, rot_tgt_scorer );
+						std::vector<float> unsat_scores = unsat_manager->get_buried_unsats( initial_burial, rotamers, bb_positions, rot_tgt_scorer );
 						unsat_manager->print_buried_unsats( unsat_scores );
 
 
@@ -1323,7 +1370,9 @@ int main(int argc, char *argv[]) {
 
 					task_list.push_back(make_shared<HSearchInit>( ));
 					for ( int i = 0; i <= final_resl; i++ ) {
-						task_list.push_back(make_shared<HSearchScoreAtReslTask>( i, i, opt.tether_to_input_position_cut ));
+						// bounded scoring only where the beam is pruned right after and nothing else reorders it
+						uint64_t bounded_keep = opt.hsearch_bounded_scoring && ! opt.hack_pack_during_hsearch && i < final_resl ? opt.beam_size / opt.DIMPOW2 : 0;
+						task_list.push_back(make_shared<HSearchScoreAtReslTask>( i, i, opt.tether_to_input_position_cut, bounded_keep ));
 
 						if (opt.hack_pack_during_hsearch) {
 							task_list.push_back(make_shared<SortByScoreTask>( ));
@@ -1355,6 +1404,10 @@ int main(int argc, char *argv[]) {
 					task_list.push_back(make_shared<HackPackTask>(  final_resl, final_resl, opt.hackpack_score_cut )); 
 				}
 
+				if ( opt.grid_min && opt.hack_pack ) {
+					task_list.push_back(make_shared<GridMinTask>( final_resl, final_resl, grid_min_opts_from_rifdock_opt( opt ), opt.grid_min_keep ));
+				}
+
 				bool do_rosetta_score = opt.rosetta_score_fraction > 0 || opt.rosetta_score_then_min_below_thresh > -9e8 || opt.rosetta_score_at_least > 0;
 				     do_rosetta_score = do_rosetta_score && opt.hack_pack;
 				bool do_rosetta_min   = rdd.opt.rosetta_min_fraction > 0.0 && do_rosetta_score;
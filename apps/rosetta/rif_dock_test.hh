@@ -45,6 +45,10 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
     OPT_1GRP_KEY(  Real        , rif_dock, max_beam_multiplier )
     OPT_1GRP_KEY(  Boolean     , rif_dock, multiply_beam_by_seeding_positions )
     OPT_1GRP_KEY(  Boolean     , rif_dock, multiply_beam_by_scaffolds )
+    OPT_1GRP_KEY(  Integer     , rif_dock, ori_cache_max_MB )
+    OPT_1GRP_KEY(  Real        , rif_dock, rif_prefilter_bits_per_key )
+    OPT_1GRP_KEY(  Boolean     , rif_dock, rif_numa_interleave )
+    OPT_1GRP_KEY(  Boolean     , rif_dock, rif_huge_pages )
 	OPT_1GRP_KEY(  Real        , rif_dock, search_diameter )
 	OPT_1GRP_KEY(  Real        , rif_dock, hsearch_scale_factor )
 
@@ -56,6 +60,8 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 	OPT_1GRP_KEY(  Boolean     , rif_dock, output_full_scaffold )
     OPT_1GRP_KEY(  Boolean     , rif_dock, outputlite )
 	OPT_1GRP_KEY(  Boolean     , rif_dock, parallelwrite )
+    OPT_1GRP_KEY(  Integer     , rif_dock, output_threads )
+    OPT_1GRP_KEY(  String      , rif_dock, output_archive )
 	OPT_1GRP_KEY(  Boolean     , rif_dock, outputsilent )
 	OPT_1GRP_KEY(  Integer     , rif_dock, n_pdb_out )
     OPT_1GRP_KEY(  Integer     , rif_dock, n_pdb_out_global )
@@ -78,10 +84,17 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 
 	OPT_1GRP_KEY(  Boolean     , rif_dock, hack_pack )
 	OPT_1GRP_KEY(  Boolean     , rif_dock, hack_pack_during_hsearch )
+	OPT_1GRP_KEY(  Boolean     , rif_dock, hsearch_bounded_scoring )
+	OPT_1GRP_KEY(  Boolean     , rif_dock, hsearch_locality_order )
 	OPT_1GRP_KEY(  Real        , rif_dock, hack_pack_frac )
 	OPT_1GRP_KEY(  Real        , rif_dock, pack_iter_mult )
 	OPT_1GRP_KEY(  Integer     , rif_dock, pack_n_iters )
 	OPT_1GRP_KEY(  Real       , rif_dock, hackpack_score_cut )
+	OPT_1GRP_KEY(  Boolean     , rif_dock, grid_min )
+	OPT_1GRP_KEY(  Real        , rif_dock, grid_min_max_translation )
+	OPT_1GRP_KEY(  Real        , rif_dock, grid_min_max_rotation )
+	OPT_1GRP_KEY(  Integer     , rif_dock, grid_min_iterations )
+	OPT_1GRP_KEY(  Integer     , rif_dock, grid_min_keep )
 	OPT_1GRP_KEY(  Real        , rif_dock, hbond_weight )
     OPT_1GRP_KEY(  Real        , rif_dock, scaff_bb_hbond_weight )
     OPT_1GRP_KEY(  Boolean     , rif_dock, dump_scaff_bb_hbond_rays )
@@ -223,6 +236,7 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
     OPT_1GRP_KEY(  String      , rif_dock, scaff_search_mode )
     OPT_1GRP_KEY(  String      , rif_dock, nineA_cluster_path )
     OPT_1GRP_KEY(  String      , rif_dock, nineA_baseline_range )
+    OPT_1GRP_KEY(  String      , rif_dock, nineA_mapped_cache )
 
     OPT_1GRP_KEY(  Integer     , rif_dock, low_cut_site )
     OPT_1GRP_KEY(  Integer     , rif_dock, high_cut_site )
@@ -240,6 +254,7 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 
     OPT_1GRP_KEY(  Boolean     , rif_dock, include_parent )
     OPT_1GRP_KEY(  Boolean     , rif_dock, use_parent_body_energies )
+    OPT_1GRP_KEY(  Real        , rif_dock, incremental_body_energies_tolerance )
 
     OPT_1GRP_KEY(  Integer     , rif_dock, dive_resl )
     OPT_1GRP_KEY(  Integer     , rif_dock, pop_resl )
@@ -259,6 +274,10 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
     OPT_1GRP_KEY(  Integer     , rif_dock, patchdock_top_ranks )
     OPT_1GRP_KEY(  Boolean     , rif_dock, seeding_by_patchdock )
     OPT_1GRP_KEY(  Boolean     , rif_dock, apply_seeding_xform_after_centering )
+    OPT_1GRP_KEY(  Integer     , rif_dock, fft_seed_npeaks )
+    OPT_1GRP_KEY(  Real        , rif_dock, fft_seed_resl )
+    OPT_1GRP_KEY(  Real        , rif_dock, fft_seed_ori_resl )
+    OPT_1GRP_KEY(  Real        , rif_dock, fft_seed_search_diameter )
     OPT_1GRP_KEY(  String      , rif_dock, xform_pos )
     OPT_1GRP_KEY(  Integer     , rif_dock, rosetta_score_each_seeding_at_least )
     OPT_1GRP_KEY(  Real        , rif_dock, cluster_score_cut )
@@ -350,6 +369,10 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 			NEW_OPT(  rif_dock::max_beam_multiplier, "Maximum beam multiplier", 1 );
 			NEW_OPT(  rif_dock::multiply_beam_by_seeding_positions, "Multiply beam size by number of seeding positions", false);
 			NEW_OPT(  rif_dock::multiply_beam_by_scaffolds, "Multiply beam size by number of scaffolds", true);
+            NEW_OPT(  rif_dock::ori_cache_max_MB, "Memory budget for precomputed per-resolution orientation tables used by the nest director, 0 disables", 512 );
+            NEW_OPT(  rif_dock::rif_prefilter_bits_per_key, "Bits per key of the bloom prefilter built for each loaded RIF that rejects empty-bin lookups before the hash probe, 0 disables", 10.0 );
+            NEW_OPT(  rif_dock::rif_numa_interleave, "Interleave the pages of the loaded RIFs and target grids over all NUMA nodes so every socket reads them at the same speed", false );
+            NEW_OPT(  rif_dock::rif_huge_pages, "Back the loaded RIFs and target grids with transparent huge pages to cut TLB misses on lookups", false );
 			NEW_OPT(  rif_dock::max_rf_bounding_ratio, "" , 4 );
 			NEW_OPT(  rif_dock::make_bounding_plot_data, "" , false );
 			NEW_OPT(  rif_dock::align_output_to_scaffold, "" , false );
@@ -358,6 +381,8 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 			NEW_OPT(  rif_dock::output_full_scaffold, "", false );
             NEW_OPT(  rif_dock::outputlite, "Write the output structures as compressed silent files", false );
 	    NEW_OPT(  rif_dock::parallelwrite, "Write the output structures using all available threads", false );
+            NEW_OPT(  rif_dock::output_threads, "Number of background threads that gzip and write the output pdb, resfile and allrifrots files. 0 writes them on the compute threads", 0 );
+            NEW_OPT(  rif_dock::output_archive, "Also append every output result (tag, position, rotamers, scores) to this indexed binary file. Meant as an alternative to many small files on shared filesystems", "" );
 			NEW_OPT(  rif_dock::outputsilent, "", false );
 			NEW_OPT(  rif_dock::n_pdb_out, "" , 10 );
             NEW_OPT(  rif_dock::n_pdb_out_global, "Normally n_pdb_out applies to each seeding position, this caps the global", -1);
@@ -373,10 +398,17 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 
 			NEW_OPT(  rif_dock::hack_pack, "" , true );
 			NEW_OPT(  rif_dock::hack_pack_during_hsearch, "hackpack during hsearch", false );
+			NEW_OPT(  rif_dock::hsearch_bounded_scoring, "abandon hsearch samples once their rif score bound can no longer make the beam", false );
+			NEW_OPT(  rif_dock::hsearch_locality_order, "score each hsearch stage in spatial order of the scaffold placements so neighboring samples share rif and grid cache lines; results keep their original order", false );
 			NEW_OPT(  rif_dock::hack_pack_frac, "" , 0.2 );
 			NEW_OPT(  rif_dock::pack_iter_mult, "" , 2.0 );
 			NEW_OPT(  rif_dock::pack_n_iters, "" , 1 );
 			NEW_OPT(  rif_dock::hackpack_score_cut, "", 0);
+			NEW_OPT(  rif_dock::grid_min, "Before rosetta scoring, rigid-body minimize each hack-packed result in the interpolated target fields, repack and rescore it at the new position, and keep the move if the score improved", false );
+			NEW_OPT(  rif_dock::grid_min_max_translation, "Max distance in angstroms -grid_min may move the scaffold", 1.0 );
+			NEW_OPT(  rif_dock::grid_min_max_rotation, "Max rotation in degrees -grid_min may apply about the scaffold centroid", 3.0 );
+			NEW_OPT(  rif_dock::grid_min_iterations, "Max steepest descent steps of -grid_min", 50 );
+			NEW_OPT(  rif_dock::grid_min_keep, "After -grid_min, keep only this many of the best results (0 keeps all)", 0 );
 			NEW_OPT(  rif_dock::hbond_weight, "" , 2.0 );
             NEW_OPT(  rif_dock::scaff_bb_hbond_weight, "" , 0.0 );
             NEW_OPT(  rif_dock::dump_scaff_bb_hbond_rays, "Dump scaffold backbone hydrogen bond rays", false );
@@ -526,6 +558,7 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 			NEW_OPT(  rif_dock::scaff_search_mode, "Which scaffold mode and HSearch do you want? Options: default, morph_dive_pop, nineA_baseline", "default");
 			NEW_OPT(  rif_dock::nineA_cluster_path, "Path to cluster database for nineA_baseline.", "" );
 			NEW_OPT(  rif_dock::nineA_baseline_range, "format cdindex:low-high (python range style)", "");
+			NEW_OPT(  rif_dock::nineA_mapped_cache, "Binary copy of the nineA cluster tables that is memory mapped instead of parsing the text tables. Written from nineA_cluster_path if it doesn't exist yet. If empty, nineA_cluster_path/kcenters_stats_al1.mapped is used when present", "" );
 
 			NEW_OPT(  rif_dock::low_cut_site, "The low cut point for fragment insertion, this res and the previous get minimized.", 0 );
 			NEW_OPT(  rif_dock::high_cut_site, "The high cut point for fragment insertion, this res and the next get minimized.", 0 );
@@ -543,6 +576,7 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
 
 			NEW_OPT(  rif_dock::include_parent, "Include parent fragment in diversified scaffolds.", false );
 			NEW_OPT(  rif_dock::use_parent_body_energies, "Don't recalculate 1-/2-body energies for fragment insertions", false );
+			NEW_OPT(  rif_dock::incremental_body_energies_tolerance, "Build 1-/2-body energies of morphed scaffolds from the parent's, recomputing only residues whose backbone moved more than this many angstroms (and their neighbors). <0 disables", -1 );
 
 			NEW_OPT(  rif_dock::dive_resl , "Dive to this depth before diversifying", 5 );
 			NEW_OPT(  rif_dock::pop_resl , "Return to this depth after diversifying", 4 );
@@ -562,6 +596,10 @@ OPT_1GRP_KEY(     StringVector , rif_dock, scaffolds )
             NEW_OPT(  rif_dock::patchdock_top_ranks, "only use the top solutions of patchdock to do refinement, the default is to use all of them", 99999);
             NEW_OPT(  rif_dock::seeding_by_patchdock, "The format of seeding file can be either Rosetta Xform or raw patchdock outputs", true );
             NEW_OPT(  rif_dock::apply_seeding_xform_after_centering, "Apply the seeding position xforms after moving scaffold to center", false );
+            NEW_OPT(  rif_dock::fft_seed_npeaks, "Generate this many seeding positions by FFT correlation of the scaffold backbone against the target fields, 0 disables", 0 );
+            NEW_OPT(  rif_dock::fft_seed_resl, "Grid spacing of the FFT seeding search", 1.0 );
+            NEW_OPT(  rif_dock::fft_seed_ori_resl, "Orientation spacing in degrees of the FFT seeding search, also the rotation allowed around each seed", 20.0 );
+            NEW_OPT(  rif_dock::fft_seed_search_diameter, "Cartesian search diameter around each FFT seed", 4.0 );
             NEW_OPT(  rif_dock::xform_pos, "" , "" );
             NEW_OPT(  rif_dock::rosetta_score_each_seeding_at_least, "", -1 );
             NEW_OPT(  rif_dock::cluster_score_cut, "", 0);
@@ -632,6 +670,10 @@ struct RifDockOpt
     float       max_beam_multiplier                  ;
     bool        multiply_beam_by_seeding_positions   ;
     bool        multiply_beam_by_scaffolds           ;
+    int         ori_cache_max_MB                     ;
+    float       rif_prefilter_bits_per_key           ;
+    bool        rif_numa_interleave                  ;
+    bool        rif_huge_pages                       ;
 	bool        replace_all_with_ala_1bre            ;
 	bool        lowres_sterics_cbonly                ;
 	float       tether_to_input_position_cut         ;
@@ -706,6 +748,8 @@ struct RifDockOpt
 	bool        output_full_scaffold                 ;
     bool        outputlite                           ;
     bool 	parallelwrite				 ;	
+    int         output_threads                       ;
+    std::string output_archive                       ;
 	bool        outputsilent                         ;
 	bool        pdb_info_pikaa                       ;
     bool        pdb_info_pssm                        ;
@@ -736,6 +780,8 @@ struct RifDockOpt
 	float       rf_resl                              ;
 	bool        hack_pack                            ;
 	bool        hack_pack_during_hsearch             ;
+	bool        hsearch_bounded_scoring              ;
+	bool        hsearch_locality_order               ;
 	int         rf_oversample                        ;
 
 	int         rotrf_oversample                     ;
@@ -747,6 +793,11 @@ struct RifDockOpt
 	float       pack_iter_mult                       ;
 	int         pack_n_iters                         ;
 	float       hackpack_score_cut                   ;
+	bool        grid_min                             ;
+	float       grid_min_max_translation             ;
+	float       grid_min_max_rotation                ;
+	int         grid_min_iterations                  ;
+	int         grid_min_keep                        ;
 	float       hbond_weight                         ;
     float       scaff_bb_hbond_weight                ;
     bool        dump_scaff_bb_hbond_rays             ;
@@ -811,6 +862,7 @@ struct RifDockOpt
     std::string scaff_search_mode					 ;
     std::string nineA_cluster_path					 ;
     std::string nineA_baseline_range				 ;
+    std::string nineA_mapped_cache                   ;
 
     int         low_cut_site                         ;
     int         high_cut_site                        ;
@@ -828,6 +880,7 @@ struct RifDockOpt
 
     bool        include_parent                       ;
     bool        use_parent_body_energies             ;
+    float       incremental_body_energies_tolerance  ;
 
     int         dive_resl                            ;
     int         pop_resl                             ;
@@ -849,6 +902,10 @@ struct RifDockOpt
     float       keep_top_clusters_frac               ;
     bool        seeding_by_patchdock                 ;
     bool        apply_seeding_xform_after_centering  ;
+    int         fft_seed_npeaks                      ;
+    float       fft_seed_resl                        ;
+    float       fft_seed_ori_resl                    ;
+    float       fft_seed_search_diameter             ;
     float       patchdock_min_sasa                   ;
     int         patchdock_top_ranks                  ;
 
@@ -920,6 +977,10 @@ struct RifDockOpt
         max_beam_multiplier                    = option[rif_dock::max_beam_multiplier                ]();
 		multiply_beam_by_seeding_positions     = option[rif_dock::multiply_beam_by_seeding_positions ]();
 		multiply_beam_by_scaffolds             = option[rif_dock::multiply_beam_by_scaffolds         ]();        
+        ori_cache_max_MB                       = option[rif_dock::ori_cache_max_MB                     ]();
+        rif_prefilter_bits_per_key             = option[rif_dock::rif_prefilter_bits_per_key           ]();
+        rif_numa_interleave                    = option[rif_dock::rif_numa_interleave                  ]();
+        rif_huge_pages                         = option[rif_dock::rif_huge_pages                       ]();
 		replace_all_with_ala_1bre              = option[rif_dock::replace_all_with_ala_1bre          ]();
 
 		target_pdb                             = option[rif_dock::target_pdb                         ]();
@@ -989,6 +1050,8 @@ struct RifDockOpt
 		output_full_scaffold                   = option[rif_dock::output_full_scaffold                  ]();
         outputlite                                     = option[rif_dock::outputlite                            ]();
 	parallelwrite                                  = option[rif_dock::parallelwrite                         ]();
+        output_threads                         = option[rif_dock::output_threads                       ]();
+        output_archive                         = option[rif_dock::output_archive                       ]();
 		outputsilent                           = option[rif_dock::outputsilent                          ]();
 		pdb_info_pikaa                         = option[rif_dock::pdb_info_pikaa                        ]();
         pdb_info_pssm                          = option[rif_dock::pdb_info_pssm                         ]();
@@ -1017,6 +1080,8 @@ struct RifDockOpt
 		rf_resl                                = option[rif_dock::rf_resl                               ]();
 		hack_pack                              = option[rif_dock::hack_pack                             ]();
 		hack_pack_during_hsearch               = option[rif_dock::hack_pack_during_hsearch              ]();
+		hsearch_bounded_scoring                = option[rif_dock::hsearch_bounded_scoring               ]();
+		hsearch_locality_order                 = option[rif_dock::hsearch_locality_order                ]();
 
 		rf_oversample                          = option[rif_dock::rf_oversample                         ]();
 		redundancy_filter_mag                  = option[rif_dock::redundancy_filter_mag                 ]();
@@ -1030,6 +1095,11 @@ struct RifDockOpt
 		pack_iter_mult                         = option[rif_dock::pack_iter_mult                        ]();
 		pack_n_iters                           = option[rif_dock::pack_n_iters                          ]();
 		hackpack_score_cut                     = option[rif_dock::hackpack_score_cut                    ]();
+		grid_min                               = option[rif_dock::grid_min                             ]();
+		grid_min_max_translation               = option[rif_dock::grid_min_max_translation             ]();
+		grid_min_max_rotation                  = option[rif_dock::grid_min_max_rotation                ]();
+		grid_min_iterations                    = option[rif_dock::grid_min_iterations                  ]();
+		grid_min_keep                          = option[rif_dock::grid_min_keep                        ]();
 		hbond_weight                           = option[rif_dock::hbond_weight                          ]();
         scaff_bb_hbond_weight                  = option[rif_dock::scaff_bb_hbond_weight                 ]();
         dump_scaff_bb_hbond_rays               = option[rif_dock::dump_scaff_bb_hbond_rays              ]();
@@ -1087,6 +1157,7 @@ struct RifDockOpt
 		scaff_search_mode					   = option[rif_dock::scaff_search_mode   				    ]();
 		nineA_cluster_path					   = option[rif_dock::nineA_cluster_path                    ]();
 		nineA_baseline_range				   = option[rif_dock::nineA_baseline_range                  ]();
+		nineA_mapped_cache                     = option[rif_dock::nineA_mapped_cache                    ]();
 
 		low_cut_site                           = option[rif_dock::low_cut_site                          ]();
 		high_cut_site                          = option[rif_dock::high_cut_site                         ]();
@@ -1103,6 +1174,7 @@ struct RifDockOpt
 
         include_parent                         = option[rif_dock::include_parent                        ]();
         use_parent_body_energies               = option[rif_dock::use_parent_body_energies              ]();
+        incremental_body_energies_tolerance    = option[rif_dock::incremental_body_energies_tolerance  ]();
 
         dive_resl                              = option[rif_dock::dive_resl                             ]();
         pop_resl                               = option[rif_dock::pop_resl                              ]();
@@ -1116,6 +1188,10 @@ struct RifDockOpt
 
 		seeding_by_patchdock                    = option[rif_dock::seeding_by_patchdock                 ]();
         apply_seeding_xform_after_centering     = option[rif_dock::apply_seeding_xform_after_centering  ]();
+        fft_seed_npeaks                        = option[rif_dock::fft_seed_npeaks                      ]();
+        fft_seed_resl                          = option[rif_dock::fft_seed_resl                        ]();
+        fft_seed_ori_resl                      = option[rif_dock::fft_seed_ori_resl                    ]();
+        fft_seed_search_diameter               = option[rif_dock::fft_seed_search_diameter             ]();
         xform_fname                             = option[rif_dock::xform_pos                            ]();
         rosetta_score_each_seeding_at_least     = option[rif_dock::rosetta_score_each_seeding_at_least  ]();
         cluster_score_cut                       = option[rif_dock::cluster_score_cut                    ]();
@@ -83,6 +83,8 @@ OPT_1GRP_KEY( StringVector, rifgen, donres )
 	OPT_1GRP_KEY( Real          , rifgen, rif_apo_dump_fraction )
 	OPT_1GRP_KEY( StringVector  , rifgen, data_cache_dir )
 	OPT_1GRP_KEY( Integer       , rifgen, hbgeom_max_cache )
+	OPT_1GRP_KEY( Boolean       , rifgen, hbgeom_mapped_cache )
+	OPT_1GRP_KEY( Boolean       , rifgen, hbond_dedup_bins )
 	OPT_1GRP_KEY( Real          , rifgen, rosetta_field_resl )
 	OPT_1GRP_KEY( RealVector    , rifgen, search_resolutions )
 	OPT_1GRP_KEY( Real          , rifgen, hash_cart_resl )
@@ -95,6 +97,7 @@ OPT_1GRP_KEY( StringVector, rifgen, donres )
 	OPT_1GRP_KEY( Real          , rifgen, hash_preallocate_mult )
 	OPT_1GRP_KEY( Real          , rifgen, score_cut_adjust )
 	OPT_1GRP_KEY( String        , rifgen, outfile )
+	OPT_1GRP_KEY( Real          , rifgen, prefilter_bits_per_key )
 	OPT_1GRP_KEY( String        , rifgen, outdir )
 	OPT_1GRP_KEY( StringVector  , rifgen, test_structures )
 	OPT_1GRP_KEY( Real          , rifgen, max_rf_bounding_ratio )
@@ -172,6 +175,8 @@ OPT_1GRP_KEY( StringVector, rifgen, donres )
 		NEW_OPT(  rifgen::rif_apo_dump_fraction            , "" , 0.0001 );
 		NEW_OPT(  rifgen::data_cache_dir                   , "" , utility::vector1<std::string>(1,"./") );
 		NEW_OPT(  rifgen::hbgeom_max_cache                 , "max number of geom files to load at once", -1 );
+		NEW_OPT(  rifgen::hbgeom_mapped_cache              , "keep all hbond geometries in one uncompressed file in data_cache_dir, mapped read only and shared between processes", true );
+		NEW_OPT(  rifgen::hbond_dedup_bins                 , "score only the sample nearest the rif bin center when several hbond_cart_sample_hack samples of one hbond geometry share a bin", false );
 		NEW_OPT(  rifgen::rosetta_field_resl               , "" , 0.5 );
 		NEW_OPT(  rifgen::search_resolutions               , "" , utility::vector1<core::Real>() );
 		NEW_OPT(  rifgen::hash_cart_resl                   , "" , 0.2 );
@@ -184,6 +189,7 @@ OPT_1GRP_KEY( StringVector, rifgen, donres )
 		NEW_OPT(  rifgen::apores                           , "" , utility::vector1<std::string>() );
 		NEW_OPT(  rifgen::hash_preallocate_mult            , "" , 1.0 );
 		NEW_OPT(  rifgen::outfile                          , "" , "default_rif_hier_outfile.rif.gz" );
+		NEW_OPT(  rifgen::prefilter_bits_per_key           , "store a bloom prefilter of this many bits per key in the rif files, 0 for none" , 0.0 );
 		NEW_OPT(  rifgen::outdir                           , "" , "./default_rif_hier_outdir" );
 		NEW_OPT(  rifgen::test_structures                  , "" , utility::vector1<std::string>() );
 		NEW_OPT(  rifgen::max_rf_bounding_ratio            , "" , 4 );
@@ -320,6 +326,7 @@ make_bounding_grids(
 		std::string description = oss_description.str();
 
 		fname = fname_base+tag+"RIF_"+digits + ".xmap.gz";
+		if( option[rifgen::prefilter_bits_per_key]() > 0 ) new_rif->build_prefilter( option[rifgen::prefilter_bits_per_key]() );
 		utility::io::ozstream out( fname );
 		new_rif->save( out, description );
 		out.close();
@@ -401,6 +408,8 @@ std::shared_ptr<::devel::scheme::RifBase> init_rif_and_generators(
 			hbgenopts.dump_bindentate_hbonds = option[ rifgen::dump_bidentate_hbonds ]();
 			hbgenopts.report_aa_count = option[ rifgen::report_aa_count ]();
 			hbgenopts.hbgeom_max_cache = option[ rifgen::hbgeom_max_cache ]();
+			hbgenopts.hbgeom_mapped_cache = option[ rifgen::hbgeom_mapped_cache ]();
+			hbgenopts.hbond_dedup_bins = option[ rifgen::hbond_dedup_bins ]();
 
 			rif_generators_out.push_back(
 				::scheme::make_shared<devel::scheme::rif::RifGeneratorSimpleHbonds>(
@@ -975,6 +984,8 @@ int main(int argc, char *argv[]) {
 
 
 
+			if( option[rifgen::prefilter_bits_per_key]() > 0 ) rif->build_prefilter( option[rifgen::prefilter_bits_per_key]() );
+
 			// make bounding grids
 			#ifdef USE_OPENMP
 			#pragma omp parallel for schedule(dynamic,1)
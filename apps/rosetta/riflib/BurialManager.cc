@@ -159,6 +159,15 @@ fill_voxel_near_xyz_cone( BurialVoxelArray & grid, Eigen::Vector3f const & ca, E
 void
 BurialManager::set_target_neighbors( core::pose::Pose const & pose ) {
     target_burial_grid_ = generate_burial_grid( pose, opts_.target_method, opts_.target_distance_cutoff, opts_.skip_sasa_for_res );
+    update_target_burial_counts();
+}
+
+void
+BurialManager::update_target_burial_counts() {
+    target_burial_counts_.resize( target_burial_points_.size() );
+    for ( int i_pt = 0; i_pt < target_burial_points_.size(); i_pt++ ) {
+        target_burial_counts_[i_pt] = target_burial_grid_->at( target_burial_points_[i_pt] );
+    }
 }
 
 shared_ptr<BurialVoxelArray>
@@ -444,14 +453,23 @@ BurialManager::get_burial_count(
 std::vector<float>
 BurialManager::get_burial_weights( EigenXform const & scaff_transform, shared_ptr<BurialVoxelArray> const & scaff_grid) const {
 
+    runtime_assert( target_burial_counts_.size() == target_burial_points_.size() );
+
     EigenXform const & scaff_inv_transform = scaff_transform.inverse();
+    const float scaff_scale = opts_.target_burial_cutoff / opts_.scaffold_burial_cutoff;
     std::vector<float> weights( target_burial_points_.size() );
 
 
     for ( int i_pt = 0; i_pt < target_burial_points_.size(); i_pt ++ ) {
 
-        const float burial_count = get_burial_count( target_burial_points_[i_pt], scaff_inv_transform, scaff_grid ) 
+        // same sum as get_burial_count() but with the target half cached. the scaffold can only add
+        //  burial, so points the target alone buries skip the scaffold lookup
+        const float target_count = target_burial_counts_[i_pt];
+        float burial_count = target_count - unburial_adjust_[i_pt];
+        if ( burial_count < opts_.target_burial_cutoff && scaff_grid ) {
+            burial_count = ( target_count + scaff_grid->at( scaff_inv_transform * target_burial_points_[i_pt] ) * scaff_scale )
                                     - unburial_adjust_[i_pt];
+        }
 
         // if (debug_) std::cout << "Burial: iheavy: " << i_pt << " count: " << burial_count << std::endl;
         const float burial = burial_count >= opts_.target_burial_cutoff ? 1.0 : 0.0; 
@@ -480,6 +498,9 @@ int
 BurialManager::remove_heavy_atom( int heavy_atom_no ) {
     target_burial_points_.erase( target_burial_points_.begin() + heavy_atom_no );
     unburial_adjust_.erase( unburial_adjust_.begin() + heavy_atom_no );
+    if ( ! target_burial_counts_.empty() ) {
+        target_burial_counts_.erase( target_burial_counts_.begin() + heavy_atom_no );
+    }
 
     runtime_assert( target_burial_points_.size() == unburial_adjust_.size() );
     return target_burial_points_.size();
@@ -148,6 +148,9 @@ struct BurialManager {
     int
     remove_heavy_atom( int heavy_atom_no );
 
+    void
+    update_target_burial_counts();
+
 // private:
 
     BurialOpts opts_;
@@ -156,6 +159,7 @@ struct BurialManager {
     // std::vector< HBondRay > donor_acceptors_;
     std::vector< Eigen::Vector3f > target_burial_points_;
     std::vector< float > unburial_adjust_;
+    std::vector< float > target_burial_counts_;  // target_burial_grid_ at each point, constant per target
     // std::vector<int> target_neighbor_counts_;
     // std::vector<int> other_neighbor_counts_;
 
@@ -17,12 +17,16 @@
 #include <core/pose/xyzStripeHashPose.hh>
 #include <utility/file/file_sys_util.hh>
 
+#include <limits>
+
 
 namespace devel {
 namespace scheme {
 
 // constrain codes, maybe I should move it to a separate file.
 
+class CompiledCstSet;
+
 class CstBase
 {
 public:
@@ -31,12 +35,97 @@ public:
     virtual bool apply(devel::scheme::EigenXform const & trans) = 0;
     virtual void reset() = 0;
     virtual shared_ptr<CstBase> clone() = 0;
+    // add this constraint to a CompiledCstSet, after init. false if it can't be, then apply() is used
+    virtual bool compile( CompiledCstSet & ) const { return false; }
     virtual ~CstBase() {};
 };
 
 
 typedef shared_ptr<CstBase> CstBaseOP;
 
+
+// all constraints of one scaffold, flattened after init so a search point costs one pass over
+// plain arrays. pair distances are checked first, squared, for every constraint at once, then the
+// pose hash lookups, which share a single inverse of the xform. the first failure ends it.
+class CompiledCstSet
+{
+public:
+    // AtomPairCst: pass iff lo2 < |x*scaffold_point - target_point|^2 < hi2
+    std::vector<float> sx, sy, sz, tx, ty, tz, lo2, hi2;
+
+    // AtomToPoseCst and RayToPoseCst: points are tested against a hashed pose in the other frame.
+    // with close, the group passes iff any point clashes, otherwise iff none does
+    struct HashGroup {
+        core::pose::xyzStripeHashPoseOP hashed_pose;
+        bool point_on_target; // points are moved into the scaffold frame by x.inverse()
+        bool close;
+        std::vector<Eigen::Vector3f> points;
+    };
+    std::vector<HashGroup> hash_groups;
+
+    // constraints that don't compile, applied as is
+    std::vector<CstBaseOP> uncompiled;
+
+    void clear() {
+        sx.clear(); sy.clear(); sz.clear(); tx.clear(); ty.clear(); tz.clear(); lo2.clear(); hi2.clear();
+        hash_groups.clear();
+        uncompiled.clear();
+    }
+
+    bool empty() const { return sx.empty() && hash_groups.empty() && uncompiled.empty(); }
+
+    void add_pair( Eigen::Vector3f const & scaff, Eigen::Vector3f const & tgt, float lo, float hi ) {
+        sx.push_back( scaff[0] ); sy.push_back( scaff[1] ); sz.push_back( scaff[2] );
+        tx.push_back( tgt[0] ); ty.push_back( tgt[1] ); tz.push_back( tgt[2] );
+        lo2.push_back( lo < 0 ? -1.0f : lo*lo );
+        hi2.push_back( hi*hi );
+    }
+
+    void compile( std::vector<CstBaseOP> const & csts ) {
+        clear();
+        for ( CstBaseOP const & cst : csts ) {
+            if ( ! cst->compile( *this ) ) uncompiled.push_back( cst );
+        }
+    }
+
+    bool apply( devel::scheme::EigenXform const & x ) const {
+        if ( sx.size() ) {
+            float const r00 = x.linear()(0,0), r01 = x.linear()(0,1), r02 = x.linear()(0,2);
+            float const r10 = x.linear()(1,0), r11 = x.linear()(1,1), r12 = x.linear()(1,2);
+            float const r20 = x.linear()(2,0), r21 = x.linear()(2,1), r22 = x.linear()(2,2);
+            float const t0 = x.translation()[0], t1 = x.translation()[1], t2 = x.translation()[2];
+            int fails = 0;
+            for ( size_t i = 0; i < sx.size(); ++i ) {
+                float const dx = r00*sx[i] + r01*sy[i] + r02*sz[i] + t0 - tx[i];
+                float const dy = r10*sx[i] + r11*sy[i] + r12*sz[i] + t1 - ty[i];
+                float const dz = r20*sx[i] + r21*sy[i] + r22*sz[i] + t2 - tz[i];
+                float const d2 = dx*dx + dy*dy + dz*dz;
+                fails += !( d2 > lo2[i] && d2 < hi2[i] );
+            }
+            if ( fails ) return false;
+        }
+        if ( hash_groups.size() ) {
+            devel::scheme::EigenXform const xinv = x.inverse();
+            for ( HashGroup const & g : hash_groups ) {
+                devel::scheme::EigenXform const & move = g.point_on_target ? xinv : x;
+                bool any_clash = false;
+                for ( Eigen::Vector3f const & p : g.points ) {
+                    Eigen::Vector3f const v = move * p;
+                    if ( g.hashed_pose->clash( numeric::xyzVector<core::Real>( v[0], v[1], v[2] ) ) ) {
+                        any_clash = true;
+                        break;
+                    }
+                }
+                if ( any_clash != g.close ) return false;
+            }
+        }
+        for ( CstBaseOP const & cst : uncompiled ) {
+            if ( ! cst->apply( x ) ) return false;
+        }
+        return true;
+    }
+};
+
 class AtomPairCst: public CstBase
 {
 private:
@@ -107,6 +196,11 @@ public:
         return;
     }
     void init(core::pose::Pose const & target, core::pose::Pose const & scaffold, double resl) { resolution = resl; }
+    bool compile( CompiledCstSet & set ) const {
+        if ( close ) set.add_pair( scaffold_atom_coor, target_atom_coor, -1.0, distance + resolution );
+        else         set.add_pair( scaffold_atom_coor, target_atom_coor, distance - resolution, std::numeric_limits<float>::max() );
+        return true;
+    }
     bool apply(devel::scheme::EigenXform const & trans)
     {
         Eigen::Vector3f v = trans * scaffold_atom_coor;
@@ -214,6 +308,16 @@ public:
         }
         return;
     }
+    bool compile( CompiledCstSet & set ) const {
+        if (!hashed_pose) return true; // always passes
+        CompiledCstSet::HashGroup g;
+        g.hashed_pose = hashed_pose;
+        g.point_on_target = atom_on_target;
+        g.close = close;
+        g.points.push_back( atom_coor );
+        set.hash_groups.push_back( g );
+        return true;
+    }
     bool apply(devel::scheme::EigenXform const & trans)
     {
         if (!hashed_pose) return true;
@@ -353,6 +457,17 @@ public:
         
     }
     
+    bool compile( CompiledCstSet & set ) const {
+        if (!hashed_pose || ray_coors.size() == 0) return true; // always passes
+        CompiledCstSet::HashGroup g;
+        g.hashed_pose = hashed_pose;
+        g.point_on_target = atom_on_target;
+        g.close = close;
+        g.points = ray_coors;
+        set.hash_groups.push_back( g );
+        return true;
+    }
+
     bool apply(devel::scheme::EigenXform const & trans)
     {
         bool clash = true;
@@ -14,6 +14,7 @@
 #include <riflib/rifdock_typedefs.hh>
 
 #include "scheme/util/SimpleArray.hh"
+#include "scheme/objective/voxel/VoxelNeighborList.hh"
 #include <riflib/RotamerGenerator.hh>
 #include <riflib/ScoreRotamerVsTarget.hh>
 
@@ -59,12 +60,10 @@ struct HydrophobicManager {
     typedef uint16_t Hyd;
     static int const CACHE_MAX_HYD = std::numeric_limits<Hyd>::max();
 
-    typedef ::scheme::util::SimpleArray<3,size_t> Indices;
-    typedef Eigen::Vector3f Bounds;
-    Bounds lb_,ub_,cs_;
+    typedef ::scheme::objective::voxel::VoxelNeighborList<Hyd,float> VoxelMap;
+    typedef typename VoxelMap::Span Hyds;
 
     const float max_interaction_range_ = 7.0;   // It's actually 6.0, but just to be safe
-    size_t max_hyds_;
 
     const std::set<char> hydrophobic_name1s_ {'A', 'C', 'F', 'I', 'L', 'M', 'P', 'T', 'V', 'W', 'Y'}; 
     std::vector<core::Size> hydrophobic_res_;
@@ -75,25 +74,13 @@ struct HydrophobicManager {
     std::vector<bool> rif_pi_map_;
 
 
-    std::vector<Hyd> voxel_map_;
+    VoxelMap voxel_map_;
 
-    // This only actually needs 1. But include a few extra in case it accidentally gets written to
-    std::vector<Hyd> OOB_LIST = {CACHE_MAX_HYD, CACHE_MAX_HYD, CACHE_MAX_HYD, CACHE_MAX_HYD, CACHE_MAX_HYD, CACHE_MAX_HYD};
-
-    Indices shape_;
-
-
-    Bounds cat_lb_,cat_ub_,cat_cs_;
     std::vector<core::Size> cation_res_;
-    std::vector<Hyd> cation_voxel_map_;
-    Indices cation_shape_;
-    size_t cation_max_hyds_;
+    VoxelMap cation_voxel_map_;
 
-    Bounds lig_lb_,lig_ub_,lig_cs_;
     std::vector<std::vector<std::pair<core::Size, core::Size>>> lig_res_;
-    std::vector<Hyd> lig_voxel_map_;
-    Indices lig_shape_;
-    size_t lig_max_hyds_;
+    VoxelMap lig_voxel_map_;
 
 
     shared_ptr< RotamerIndex > rot_index_p;
@@ -120,10 +107,7 @@ struct HydrophobicManager {
         std::vector<std::string> const & ligand_hyd_res,
         bool dump_voxels
     ) : 
-    rot_index_p( rot_index_p_in ),
-    shape_(Indices(0, 0, 0)),
-    cation_shape_(Indices(0, 0, 0)),
-    lig_shape_(Indices(0, 0, 0))
+    rot_index_p( rot_index_p_in )
     {
 
         rif_atype_map_ = get_rif_atype_map();
@@ -133,30 +117,30 @@ struct HydrophobicManager {
 
         identify_hydrophobic_residues( target, target_res );
         prepare_bounds( target );
-        std::vector<std::vector<Hyd>> early_map = first_pass_fill( target );
-        create_and_fill_voxel_map( early_map );
+        fill( target );
+        std::cout << "Max hydrophobics at one voxel: " << voxel_map_.max_per_voxel_ << std::endl;
 
 
         identify_cation_residues( target, target_res );
         if ( cation_res_.size() > 0 ) {
             cation_prepare_bounds( target );
-            std::vector<std::set<Hyd>> cation_early_map = cation_first_pass_fill( target );
-            cation_create_and_fill_voxel_map( cation_early_map );
+            cation_fill( target );
+            std::cout << "Max cations at one voxel: " << cation_voxel_map_.max_per_voxel_ << std::endl;
         }
 
         if ( ligand_hyd_res.size() > 0 ) {
 
             lig_parse_hyd( target, ligand_hyd_res );
             lig_prepare_bounds( target );
-            std::vector<std::vector<Hyd>> lig_early_map = lig_first_pass_fill( target );
-            lig_create_and_fill_voxel_map( lig_early_map );
+            lig_fill( target );
+            std::cout << "Max ligand hydrophobics at one voxel: " << lig_voxel_map_.max_per_voxel_ << std::endl;
         }
 
 
         if ( dump_voxels ) {
-            dump_filled_voxels("hyd_voxels.pdb", shape_, voxel_map_, max_hyds_, lb_, cs_ );
-            dump_filled_voxels("cation_voxels.pdb", cation_shape_, cation_voxel_map_, cation_max_hyds_, cat_lb_, cat_cs_ );
-            dump_filled_voxels("lig_voxels.pdb", lig_shape_, lig_voxel_map_, lig_max_hyds_, lig_lb_, lig_cs_ );
+            dump_filled_voxels("hyd_voxels.pdb", voxel_map_ );
+            dump_filled_voxels("cation_voxels.pdb", cation_voxel_map_ );
+            dump_filled_voxels("lig_voxels.pdb", lig_voxel_map_ );
         }
 
 
@@ -242,28 +226,15 @@ struct HydrophobicManager {
             ubs[i] += max_interaction_range_;
         }
 
-        lb_ = lbs;
-        ub_ = ubs;
-        cs_ = Eigen::Vector3f( 0.5, 0.5, 0.5 );
-
-        Indices extents = floats_to_index( ub_ );
-        shape_ = extents + Indices(1);
+        voxel_map_.init( lbs, ubs, Eigen::Vector3f( 0.5, 0.5, 0.5 ) );
 
     }
 
-    std::vector<std::vector<Hyd>>
-    first_pass_fill( core::pose::Pose const & target ) {
-
-        std::vector<std::vector<Hyd>> early_map;
-
-        size_t elements = shape_[0] * shape_[1] * shape_[2];
-        // std::cout << shape_ << std::endl;
-        // std::cout << floats_to_index( ub_ ) << std::endl;
-        // std::cout << elements << " " << index_to_map_index( floats_to_index( ub_ ) ) << std::endl;
-        runtime_assert( elements - 1 == index_to_map_index( floats_to_index( ub_ ) ) );
-
-        early_map.resize(elements);
+    void
+    fill( core::pose::Pose const & target ) {
 
+        // pull the coordinates out serially, the voxel map is then filled in parallel
+        std::vector<std::vector<Eigen::Vector3f>> hyd_atoms( hydrophobic_res_.size() );
         for ( Hyd ihyd = 0; ihyd < hydrophobic_res_.size(); ihyd++ ) {
             core::conformation::Residue const & res = target.residue(hydrophobic_res_[ihyd]);
 
@@ -272,86 +243,57 @@ struct HydrophobicManager {
 
                 numeric::xyzVector<core::Real> _xyz = res.xyz( atno );
                 Eigen::Vector3f xyz; xyz[0] = _xyz[0]; xyz[1] = _xyz[1]; xyz[2] = _xyz[2];
+                hyd_atoms[ihyd].push_back( xyz );
+            }
+        }
+
+        fill_hydrophobic_shells( voxel_map_, hyd_atoms );
+    }
+
+    // Each atom adds its item to the voxels between 3.0 and 4.8 A away, so an item shows up
+    //  once per atom in range
+    void
+    fill_hydrophobic_shells( VoxelMap & voxel_map, std::vector<std::vector<Eigen::Vector3f>> const & atoms_per_item ) const {
+
+        VoxelMap::Bounds const & lb = voxel_map.lb_;
+        VoxelMap::Bounds const & ub = voxel_map.ub_;
+
+        voxel_map.build( atoms_per_item.size(), [&]( size_t ihyd, std::vector<uint32_t> & out ) {
+
+            for ( Eigen::Vector3f const & xyz : atoms_per_item[ihyd] ) {
 
                 Eigen::Vector3f lbs( xyz[0] - max_interaction_range_, xyz[1] - max_interaction_range_, xyz[2] - max_interaction_range_ );
                 Eigen::Vector3f ubs( xyz[0] + max_interaction_range_, xyz[1] + max_interaction_range_, xyz[2] + max_interaction_range_ );
 
                 const float low_rad_sq = 3.0f*3.0f;
-                const float med_rad_sq = 4.5f*4.5f;
                 const float long_rad_sq = 4.8f*4.8f;
 
-                const float step = cs_[0];
+                const float step = voxel_map.cs_[0];
 
                 Eigen::Vector3f worker;
 
                 for ( float x = lbs[0] - step/2; x < ubs[0] + step; x += step ) {
-                    if ( x < lb_[0] || x > ub_[0] ) continue;
+                    if ( x < lb[0] || x > ub[0] ) continue;
                     worker[0] = x;
 
                     for ( float y = lbs[1] - step/2; y < ubs[1] + step; y += step ) {
-                        if ( y < lb_[1] || y > ub_[1] ) continue;
+                        if ( y < lb[1] || y > ub[1] ) continue;
                         worker[1] = y;
 
                         for ( float z = lbs[2] - step/2; z < ubs[2] + step; z += step ) {
-                            if ( z < lb_[2] || z > ub_[2] ) continue;
+                            if ( z < lb[2] || z > ub[2] ) continue;
                             worker[2] = z;
 
                             const float squared_dist = ( xyz - worker ).squaredNorm();
 
-                            if ( squared_dist < low_rad_sq ) {
-                                // do nothing
-                            } else if ( squared_dist < med_rad_sq ) {
-                                size_t offset = index_to_map_index( floats_to_index( worker ) );
-                                early_map.at(offset).push_back( ihyd );
-                                // early_map.at(offset).push_back( ihyd );
-                            } else if ( squared_dist < long_rad_sq ) {
-                                size_t offset = index_to_map_index( floats_to_index( worker ) );
-                                early_map.at(offset).push_back( ihyd );
-                            } else {
-                                // do nothing
+                            if ( squared_dist >= low_rad_sq && squared_dist < long_rad_sq ) {
+                                out.push_back( voxel_map.index_to_map_index( voxel_map.floats_to_index( worker ) ) );
                             }
                         }
                     }
                 }
             }
-        }
-        return early_map;
-    }
-
-
-
-    void
-    create_and_fill_voxel_map( std::vector<std::vector<Hyd>> const & early_map ) {
-
-        max_hyds_ = 0;
-
-        for ( std::vector<Hyd> these_hyds : early_map ) {
-            max_hyds_ = std::max<size_t>( max_hyds_, these_hyds.size() );
-        }
-
-        std::cout << "Max hydrophobics at one voxel: " << max_hyds_ << std::endl;
-
-        // max_hyds_ is 1 too big. This means that the receiver can always loop until they hit a CACHE_MAX_HYD
-        max_hyds_ += 1;
-
-        voxel_map_.resize( max_hyds_ * shape_[0] * shape_[1] * shape_[2], CACHE_MAX_HYD );
-
-        // We already asserted the two maps have the same size, so just array fill
-        for ( size_t imap = 0; imap < early_map.size(); imap++ ) {
-
-            std::vector<Hyd> these_hyds = early_map[imap];
-            bool wrote_a_null = false;
-            for ( size_t idx = 0; idx < max_hyds_; idx++ ) {
-                size_t offset = imap * max_hyds_ + idx;
-                if ( idx < these_hyds.size() ) {
-                    voxel_map_.at(offset) = these_hyds.at(idx);
-                } else {
-                    voxel_map_.at(offset) = CACHE_MAX_HYD;
-                    wrote_a_null = true;
-                }
-            }
-            runtime_assert( wrote_a_null );     // Redundancy. Make sure each list is terminated
-        }
+        });
     }
 
 ///////////////////////////// CATION PI ////////////////////////////
@@ -394,36 +336,20 @@ struct HydrophobicManager {
             ubs[i] += max_interaction_range_;
         }
 
-        cat_lb_ = lbs;
-        cat_ub_ = ubs;
-        cat_cs_ = Eigen::Vector3f( 0.5, 0.5, 0.5 );
-
-        Indices extents = cation_floats_to_index( cat_ub_ );
-        cation_shape_ = extents + Indices(1);
+        cation_voxel_map_.init( lbs, ubs, Eigen::Vector3f( 0.5, 0.5, 0.5 ) );
 
     }
 
-    std::vector<std::set<Hyd>>
-    cation_first_pass_fill( core::pose::Pose const & target ) {
-
-        std::vector<std::set<Hyd>> early_map;
-
-        size_t elements = cation_shape_[0] * cation_shape_[1] * cation_shape_[2];
-        // std::cout << shape_ << std::endl;
-        // std::cout << floats_to_index( ub_ ) << std::endl;
-        // std::cout << elements << " " << index_to_map_index( floats_to_index( ub_ ) ) << std::endl;
-        runtime_assert( elements - 1 == cation_index_to_map_index( cation_floats_to_index( cat_ub_ ) ) );
-
-        early_map.resize(elements);
+    void
+    cation_fill( core::pose::Pose const & target ) {
 
+        // pull the coordinates out serially, the voxel map is then filled in parallel
+        std::vector<Eigen::Vector3f> czs, normals;
         for ( Hyd ihyd = 0; ihyd < cation_res_.size(); ihyd++ ) {
             core::conformation::Residue const & res = target.residue(cation_res_[ihyd]);
 
             numeric::xyzVector<core::Real> _xyz;
 
-            _xyz = res.xyz("NE");
-            Eigen::Vector3f ne; ne[0] = _xyz[0]; ne[1] = _xyz[1]; ne[2] = _xyz[2];
-
             _xyz = res.xyz("CZ");
             Eigen::Vector3f cz; cz[0] = _xyz[0]; cz[1] = _xyz[1]; cz[2] = _xyz[2];
 
@@ -436,6 +362,18 @@ struct HydrophobicManager {
             Eigen::Vector3f normal = ( nh2 - cz ).cross( nh1 - cz );
             normal /= normal.norm();
 
+            czs.push_back( cz );
+            normals.push_back( normal );
+        }
+
+        VoxelMap::Bounds const & lb = cation_voxel_map_.lb_;
+        VoxelMap::Bounds const & ub = cation_voxel_map_.ub_;
+
+        cation_voxel_map_.build( cation_res_.size(), [&]( size_t ihyd, std::vector<uint32_t> & out ) {
+
+            Eigen::Vector3f const & cz = czs[ihyd];
+            Eigen::Vector3f const & normal = normals[ihyd];
+
 //https://stackoverflow.com/questions/47932955/how-to-check-if-a-3d-point-is-inside-a-cylinder
 
             // Define a cylinder with radius 2.2 A from the center of ARG
@@ -459,20 +397,20 @@ struct HydrophobicManager {
             Eigen::Vector3f lbs( cz[0] - max_interaction_range_, cz[1] - max_interaction_range_, cz[2] - max_interaction_range_ );
             Eigen::Vector3f ubs( cz[0] + max_interaction_range_, cz[1] + max_interaction_range_, cz[2] + max_interaction_range_ );
 
-            const float step = cs_[0];
+            const float step = cation_voxel_map_.cs_[0];
 
             Eigen::Vector3f worker;
                                                                     // way over-sample
             for ( float x = lbs[0] - step/2; x < ubs[0] + step; x += step/4.0 ) {
-                if ( x < lb_[0] || x > ub_[0] ) continue;
+                if ( x < lb[0] || x > ub[0] ) continue;
                 worker[0] = x;
 
                 for ( float y = lbs[1] - step/2; y < ubs[1] + step; y += step/4.0 ) {
-                    if ( y < lb_[1] || y > ub_[1] ) continue;
+                    if ( y < lb[1] || y > ub[1] ) continue;
                     worker[1] = y;
 
                     for ( float z = lbs[2] - step/2; z < ubs[2] + step; z += step/4.0 ) {
-                        if ( z < lb_[2] || z > ub_[2] ) continue;
+                        if ( z < lb[2] || z > ub[2] ) continue;
                         worker[2] = z;
 
                         // Cylinder 1
@@ -480,14 +418,13 @@ struct HydrophobicManager {
                         // Test between planes
                         if ( (worker - cy1_p1).dot( -cy1_p1_min_p2) >= 0 ) {
                         if ( (worker - cy1_p2).dot(  cy1_p1_min_p2) >= 0 ) {
-                        if ( 
-                            ( ( worker - cy1_p1).cross( -cy1_p1_min_p2 ) ).norm() 
+                        if (
+                            ( ( worker - cy1_p1).cross( -cy1_p1_min_p2 ) ).norm()
                                                     /
                                             cy1_p1_min_p2_norm                       <= radius
                                                     ) {
 
-                            size_t offset = cation_index_to_map_index( cation_floats_to_index( worker ) );
-                            early_map.at(offset).insert( ihyd );
+                            out.push_back( cation_voxel_map_.index_to_map_index( cation_voxel_map_.floats_to_index( worker ) ) );
 
                         }
                         }
@@ -498,14 +435,13 @@ struct HydrophobicManager {
                         if ( (worker - cy2_p1).dot( -cy2_p1_min_p2) >= 0 ) {
                         if ( (worker - cy2_p2).dot(  cy2_p1_min_p2) >= 0 ) {
                         // Test inside curved space
-                        if ( 
-                            ( ( worker - cy2_p1).cross( -cy2_p1_min_p2 ) ).norm() 
+                        if (
+                            ( ( worker - cy2_p1).cross( -cy2_p1_min_p2 ) ).norm()
                                                     /
                                             cy2_p1_min_p2_norm                       <= radius
                                                     ) {
 
-                            size_t offset = cation_index_to_map_index( cation_floats_to_index( worker ) );
-                            early_map.at(offset).insert( ihyd );
+                            out.push_back( cation_voxel_map_.index_to_map_index( cation_voxel_map_.floats_to_index( worker ) ) );
 
                         }
                         }
@@ -514,51 +450,7 @@ struct HydrophobicManager {
                     }
                 }
             }
-            
-        }
-        return early_map;
-    }
-
-
-
-    void
-    cation_create_and_fill_voxel_map( std::vector<std::set<Hyd>> const & early_map ) {
-
-        cation_max_hyds_ = 0;
-
-        for ( std::set<Hyd> these_hyds : early_map ) {
-            cation_max_hyds_ = std::max<size_t>( cation_max_hyds_, these_hyds.size() );
-        }
-
-        std::cout << "Max cations at one voxel: " << cation_max_hyds_ << std::endl;
-
-        // max_hyds_ is 1 too big. This means that the receiver can always loop until they hit a CACHE_MAX_HYD
-        cation_max_hyds_ += 1;
-
-        cation_voxel_map_.resize( cation_max_hyds_ * cation_shape_[0] * cation_shape_[1] * cation_shape_[2], CACHE_MAX_HYD );
-
-        // We already asserted the two maps have the same size, so just array fill
-        for ( size_t imap = 0; imap < early_map.size(); imap++ ) {
-
-            std::set<Hyd> these_hyds_set = early_map[imap];
-            std::vector<Hyd> these_hyds;
-            for ( Hyd hyd : these_hyds_set ) {
-                these_hyds.push_back(hyd);
-            }
-
-
-            bool wrote_a_null = false;
-            for ( size_t idx = 0; idx < cation_max_hyds_; idx++ ) {
-                size_t offset = imap * cation_max_hyds_ + idx;
-                if ( idx < these_hyds.size() ) {
-                    cation_voxel_map_.at(offset) = these_hyds.at(idx);
-                } else {
-                    cation_voxel_map_.at(offset) = CACHE_MAX_HYD;
-                    wrote_a_null = true;
-                }
-            }
-            runtime_assert( wrote_a_null );     // Redundancy. Make sure each list is terminated
-        }
+        }, true ); // each arg at most once per voxel
     }
 
 
@@ -641,120 +533,24 @@ struct HydrophobicManager {
             ubs[i] += max_interaction_range_;
         }
 
-        lig_lb_ = lbs;
-        lig_ub_ = ubs;
-        lig_cs_ = Eigen::Vector3f( 0.5, 0.5, 0.5 );
-
-        Indices extents = lig_floats_to_index( lig_ub_ );
-        lig_shape_ = extents + Indices(1);
+        lig_voxel_map_.init( lbs, ubs, Eigen::Vector3f( 0.5, 0.5, 0.5 ) );
 
     }
 
-    std::vector<std::vector<Hyd>>
-    lig_first_pass_fill( core::pose::Pose const & target ) {
-
-        std::vector<std::vector<Hyd>> early_map;
-
-        size_t elements = lig_shape_[0] * lig_shape_[1] * lig_shape_[2];
-        // std::cout << shape_ << std::endl;
-        // std::cout << floats_to_index( ub_ ) << std::endl;
-        // std::cout << elements << " " << index_to_map_index( floats_to_index( ub_ ) ) << std::endl;
-        runtime_assert( elements - 1 == lig_index_to_map_index( lig_floats_to_index( lig_ub_ ) ) );
-
-        early_map.resize(elements);
+    void
+    lig_fill( core::pose::Pose const & target ) {
 
-        
+        std::vector<std::vector<Eigen::Vector3f>> lig_atoms( lig_res_.size() );
         for ( Hyd ihyd = 0; ihyd < lig_res_.size(); ihyd++ ) {
+            for ( std::pair<core::Size, core::Size> const & this_atom : lig_res_[ ihyd ] ) {
 
-            std::vector<std::pair<core::Size, core::Size>> const & this_res = lig_res_[ ihyd ];
-
-            for ( std::pair<core::Size, core::Size> const & this_atom : this_res ) {
-
-                core::conformation::Residue const & res = target.residue(this_atom.first);
-
-                numeric::xyzVector<core::Real> _xyz = res.xyz( this_atom.second );
+                numeric::xyzVector<core::Real> _xyz = target.residue(this_atom.first).xyz( this_atom.second );
                 Eigen::Vector3f xyz; xyz[0] = _xyz[0]; xyz[1] = _xyz[1]; xyz[2] = _xyz[2];
-
-                Eigen::Vector3f lbs( xyz[0] - max_interaction_range_, xyz[1] - max_interaction_range_, xyz[2] - max_interaction_range_ );
-                Eigen::Vector3f ubs( xyz[0] + max_interaction_range_, xyz[1] + max_interaction_range_, xyz[2] + max_interaction_range_ );
-
-                const float low_rad_sq = 3.0f*3.0f;
-                const float med_rad_sq = 4.5f*4.5f;
-                const float long_rad_sq = 4.8f*4.8f;
-
-                const float step = lig_cs_[0];
-
-                Eigen::Vector3f worker;
-
-                for ( float x = lbs[0] - step/2; x < ubs[0] + step; x += step ) {
-                    if ( x < lig_lb_[0] || x > lig_ub_[0] ) continue;
-                    worker[0] = x;
-
-                    for ( float y = lbs[1] - step/2; y < ubs[1] + step; y += step ) {
-                        if ( y < lig_lb_[1] || y > lig_ub_[1] ) continue;
-                        worker[1] = y;
-
-                        for ( float z = lbs[2] - step/2; z < ubs[2] + step; z += step ) {
-                            if ( z < lig_lb_[2] || z > lig_ub_[2] ) continue;
-                            worker[2] = z;
-
-                            const float squared_dist = ( xyz - worker ).squaredNorm();
-
-                            if ( squared_dist < low_rad_sq ) {
-                                // do nothing
-                            } else if ( squared_dist < med_rad_sq ) {
-                                size_t offset = lig_index_to_map_index( lig_floats_to_index( worker ) );
-                                early_map.at(offset).push_back( ihyd );
-                                // early_map.at(offset).push_back( ihyd );
-                            } else if ( squared_dist < long_rad_sq ) {
-                                size_t offset = lig_index_to_map_index( lig_floats_to_index( worker ) );
-                                early_map.at(offset).push_back( ihyd );
-                            } else {
-                                // do nothing
-                            }
-                        }
-                    }
-                }
+                lig_atoms[ihyd].push_back( xyz );
             }
         }
-        return early_map;
-    }
-
-
-
-    void
-    lig_create_and_fill_voxel_map( std::vector<std::vector<Hyd>> const & early_map ) {
-
-        lig_max_hyds_ = 0;
-
-        for ( std::vector<Hyd> these_hyds : early_map ) {
-            lig_max_hyds_ = std::max<size_t>( lig_max_hyds_, these_hyds.size() );
-        }
-
-        std::cout << "Max ligand hydrophobics at one voxel: " << lig_max_hyds_ << std::endl;
-
-        // max_hyds_ is 1 too big. This means that the receiver can always loop until they hit a CACHE_MAX_HYD
-        lig_max_hyds_ += 1;
-
-        lig_voxel_map_.resize( lig_max_hyds_ * lig_shape_[0] * lig_shape_[1] * lig_shape_[2], CACHE_MAX_HYD );
-
-        // We already asserted the two maps have the same size, so just array fill
-        for ( size_t imap = 0; imap < early_map.size(); imap++ ) {
-
-            std::vector<Hyd> these_hyds = early_map[imap];
 
-            bool wrote_a_null = false;
-            for ( size_t idx = 0; idx < lig_max_hyds_; idx++ ) {
-                size_t offset = imap * lig_max_hyds_ + idx;
-                if ( idx < these_hyds.size() ) {
-                    lig_voxel_map_.at(offset) = these_hyds.at(idx);
-                } else {
-                    lig_voxel_map_.at(offset) = CACHE_MAX_HYD;
-                    wrote_a_null = true;
-                }
-            }
-            runtime_assert( wrote_a_null );     // Redundancy. Make sure each list is terminated
-        }
+        fill_hydrophobic_shells( lig_voxel_map_, lig_atoms );
     }
 
 
@@ -782,20 +578,10 @@ struct HydrophobicManager {
             if ( ! rif_hydrophobic_map_.at(atom.type()) ) continue;
             typename Atom::Position pos = bbpos * atom.position();
 
-            std::vector<Hyd>::const_iterator hyds_iter = this->at( pos );
-
-            Hyd this_hyd = 0;
-            while ( (this_hyd = *(hyds_iter++)) != CACHE_MAX_HYD ) {
-                total_sum ++;
-            }
+            total_sum += voxel_map_.at( pos ).size();
 
             if ( lig_res_.size() > 0 ) {
-                std::vector<Hyd>::const_iterator lig_hyds_iter = this->lig_at( pos );
-
-                Hyd lig_this_hyd = 0;
-                while ( (lig_this_hyd = *(lig_hyds_iter++)) != CACHE_MAX_HYD ) {
-                    lig_total_sum ++;
-                }
+                lig_total_sum += lig_voxel_map_.at( pos ).size();
             }
         }
             
@@ -850,10 +636,7 @@ struct HydrophobicManager {
                 typename Atom::Position pos = bbpos * atom.position();
 
                 // STANDARD
-                std::vector<Hyd>::const_iterator hyds_iter = this->at( pos );
-
-                Hyd this_hyd = 0;
-                while ( (this_hyd = *(hyds_iter++)) != CACHE_MAX_HYD ) {
+                for ( Hyd this_hyd : voxel_map_.at( pos ) ) {
                     hyd_counts[this_hyd] ++;
                     this_irot_count++;
                     if (with_whom.count(this_hyd) == 0) {
@@ -865,17 +648,12 @@ struct HydrophobicManager {
 
                 // LIGAND
                 if ( lig_res_.size() > 0 ) {
-                    std::vector<Hyd>::const_iterator lig_hyds_iter = this->lig_at( pos );
-
-                    Hyd lig_this_hyd = 0;
-                    while ( (lig_this_hyd = *(lig_hyds_iter++)) != CACHE_MAX_HYD ) {
+                    for ( Hyd lig_this_hyd : lig_voxel_map_.at( pos ) ) {
                         lig_hyd_counts[lig_this_hyd] ++;
                         this_irot_count++;
-                        if (lig_with_whom.count(this_hyd) == 0) {
-                           lig_with_whom[this_hyd] = 1;
-                        } else {
-                            lig_with_whom[this_hyd] += 1;
-                        }
+                        // This has always been keyed on the end of the standard list rather than
+                        //  lig_this_hyd, so all ligand contacts of a rotamer count as one partner
+                        lig_with_whom[CACHE_MAX_HYD] += 1;
                     }
                 }
             }
@@ -969,10 +747,7 @@ struct HydrophobicManager {
 
                     typename Atom::Position pos = bbpos * atom.position();
 
-                    std::vector<Hyd>::const_iterator hyds_iter = this->cat_at( pos );
-
-                    Hyd this_hyd = 0;
-                    while ( (this_hyd = *(hyds_iter++)) != CACHE_MAX_HYD ) {
+                    for ( Hyd this_hyd : cation_voxel_map_.at( pos ) ) {
                         if ( this_irot_counts.count( this_hyd ) == 0) {
                             this_irot_counts[ this_hyd ] = 1;
                         } else {
@@ -1042,173 +817,21 @@ struct HydrophobicManager {
 
 
 
-    template<class Floats> Indices floats_to_index(Floats const & f) const {
-        Indices ind;
-        for(int i = 0; i < 3; ++i){
-            float tmp = ((f[i]-lb_[i])/cs_[i]);
-            ind[i] = tmp;
-        }
-        return ind;
-    }
-
-    size_t index_to_map_index( Indices const & ind ) const {
-
-        size_t accum = ind[0];
-        accum = accum * shape_[1] + ind[1];
-        accum = accum * shape_[2] + ind[2];
-
-        return accum;
-
-    }
-
-    size_t index_to_offset( Indices const & ind ) const {
-
-        return index_to_map_index( ind ) * max_hyds_;
-
-    }
-
-
-
-
-    template<class Floats> Indices cation_floats_to_index(Floats const & f) const {
-        Indices ind;
-        for(int i = 0; i < 3; ++i){
-            float tmp = ((f[i]-cat_lb_[i])/cat_cs_[i]);
-            ind[i] = tmp;
-        }
-        return ind;
-    }
-
-    size_t cation_index_to_map_index( Indices const & ind ) const {
-
-        size_t accum = ind[0];
-        accum = accum * cation_shape_[1] + ind[1];
-        accum = accum * cation_shape_[2] + ind[2];
-
-        return accum;
-
-    }
-
-    size_t cation_index_to_offset( Indices const & ind ) const {
-
-        return cation_index_to_map_index( ind ) * cation_max_hyds_;
-
-    }
-
-
-    template<class Floats> Indices lig_floats_to_index(Floats const & f) const {
-        Indices ind;
-        for(int i = 0; i < 3; ++i){
-            float tmp = ((f[i]-lig_lb_[i])/lig_cs_[i]);
-            ind[i] = tmp;
-        }
-        return ind;
-    }
-
-    size_t lig_index_to_map_index( Indices const & ind ) const {
-
-        size_t accum = ind[0];
-        accum = accum * lig_shape_[1] + ind[1];
-        accum = accum * lig_shape_[2] + ind[2];
-
-        return accum;
-
-    }
-
-    size_t lig_index_to_offset( Indices const & ind ) const {
-
-        return lig_index_to_map_index( ind ) * lig_max_hyds_;
-
-    }
-    // template<class Floats>
-    // std::vector<Hyd>::const_iterator
-    // operator[](Floats const & floats) const { 
-    //     Indices ind = floats_to_index(floats);
-    //     return voxel_map_.cbegin() + index_to_offset(ind);
-    // }
-
-    // template<class Floats>
-    // std::vector<Hyd>::iterator
-    // operator[](Floats const & floats){
-    //     Indices ind = floats_to_index(floats);
-    //     return voxel_map_.begin() + index_to_offset(ind);
-    // }
-
-    std::vector<Hyd>::const_iterator 
-    at( float f, float g, float h ) const {
-        Indices idx = floats_to_index( Bounds( f, g, h ) );
-        if( idx[0] < shape_[0] && idx[1] < shape_[1] && idx[2] < shape_[2] )
-            return voxel_map_.cbegin() + index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-    template<class V>
-    std::vector<Hyd>::const_iterator
-    at( V const & v ) const {
-        Indices idx = floats_to_index( Bounds( v[0], v[1], v[2] ) );
-        if( idx[0] < shape_[0] && idx[1] < shape_[1] && idx[2] < shape_[2] )
-            return voxel_map_.cbegin() + index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-    std::vector<Hyd>::const_iterator 
-    cat_at( float f, float g, float h ) const {
-        Indices idx = cation_floats_to_index( Bounds( f, g, h ) );
-        if( idx[0] < cation_shape_[0] && idx[1] < cation_shape_[1] && idx[2] < cation_shape_[2] )
-            return cation_voxel_map_.cbegin() + cation_index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-    template<class V>
-    std::vector<Hyd>::const_iterator
-    cat_at( V const & v ) const {
-        Indices idx = cation_floats_to_index( Bounds( v[0], v[1], v[2] ) );
-        if( idx[0] < cation_shape_[0] && idx[1] < cation_shape_[1] && idx[2] < cation_shape_[2] )
-            return cation_voxel_map_.cbegin() + cation_index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-    std::vector<Hyd>::const_iterator 
-    lig_at( float f, float g, float h ) const {
-        Indices idx = lig_floats_to_index( Bounds( f, g, h ) );
-        if( idx[0] < lig_shape_[0] && idx[1] < lig_shape_[1] && idx[2] < lig_shape_[2] )
-            return lig_voxel_map_.cbegin() + lig_index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-    template<class V>
-    std::vector<Hyd>::const_iterator
-    lig_at( V const & v ) const {
-        Indices idx = lig_floats_to_index( Bounds( v[0], v[1], v[2] ) );
-        if( idx[0] < lig_shape_[0] && idx[1] < lig_shape_[1] && idx[2] < lig_shape_[2] )
-            return lig_voxel_map_.cbegin() + lig_index_to_offset(idx);
-        else return OOB_LIST.cbegin();
-    }
-
-
-
-
-
     void
-    dump_filled_voxels( std::string const & fname, Indices const & shape, std::vector<Hyd> const & map,
-                int max_hyds, Bounds const & lb, Bounds const & cs ) {
+    dump_filled_voxels( std::string const & fname, VoxelMap const & map ) {
 
         core::Size iatom = 1;
 
         std::ofstream out( fname );
 
-        for ( core::Size ix = 0; ix < shape[0]; ix++ ) {
-            float x = (ix + 0.5)*cs[0] + lb[0];
-            for ( core::Size iy = 0; iy < shape[1]; iy++ ) {
-                float y = (iy + 0.5)*cs[1] + lb[1];
-                for ( core::Size iz = 0; iz < shape[2]; iz++ ) {
-                    float z = (iz + 0.5)*cs[2] + lb[2];
-
-                    size_t accum = ix;
-                    accum = accum * shape[1] + iy;
-                    accum = accum * shape[2] + iz;
+        VoxelMap::Indices idx;
+        for ( idx[0] = 0; idx[0] < map.shape_[0]; idx[0]++ ) {
+            for ( idx[1] = 0; idx[1] < map.shape_[1]; idx[1]++ ) {
+                for ( idx[2] = 0; idx[2] < map.shape_[2]; idx[2]++ ) {
+                    VoxelMap::Bounds center = map.indices_to_center( idx );
+                    float x = center[0], y = center[1], z = center[2];
 
-                    if ( map.at( accum * max_hyds) != CACHE_MAX_HYD ) {
+                    if ( ! map.at( center ).empty() ) {
                         char buf[128];
                         snprintf(buf,128,"%s%5i %4s %3s %c%4i    %8.3f%8.3f%8.3f%6.2f%6.2f %11s\n",
                             "HETATM",
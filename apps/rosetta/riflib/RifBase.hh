@@ -15,6 +15,7 @@
 #include <string>
 #include <vector>
 #include <boost/any.hpp>
+#include <scheme/util/MemoryPlacement.hh>
 #include <boost/iterator/iterator_facade.hpp>
 #include <riflib/RotamerGenerator.hh>
 
@@ -89,6 +90,9 @@ struct RifBase
     virtual int   num_sat_data_slots() const = 0;
     virtual int   sizeof_sat_data_slot() const = 0;
     virtual void  clear_sats() = 0;
+	virtual void  build_prefilter( float bits_per_key ) = 0;
+	virtual bool  has_prefilter() const = 0;
+	virtual bool  place_memory( ::scheme::util::MemoryPlacement const & placement ) const = 0;
 
 	template< class XMap > bool get_xmap_ptr( shared_ptr<XMap> & xmap_ptr );
 	template< class XMap > bool get_xmap_const_ptr( shared_ptr<XMap const> & xmap_ptr ) const;
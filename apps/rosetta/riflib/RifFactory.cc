@@ -160,6 +160,10 @@ public:
         return sat1_sat2;
     }
 
+	void build_prefilter( float bits_per_key ) override { xmap_ptr_->build_prefilter( bits_per_key ); }
+	bool has_prefilter() const override { return xmap_ptr_->has_prefilter(); }
+	bool place_memory( ::scheme::util::MemoryPlacement const & placement ) const override { return xmap_ptr_->place_memory( placement ); }
+
 	size_t size() const override { return xmap_ptr_->size(); }
 	float load_factor() const override { return xmap_ptr_->map_.size()*1.f/xmap_ptr_->map_.bucket_count(); }
 	size_t mem_use()    const override { return xmap_ptr_->mem_use(); }
@@ -1285,8 +1289,22 @@ std::string get_rif_type_from_file( std::string fname )
 		
         
         std::vector<bool> pdbinfo_req_req_satisfied_; // has this pdbinfo:req been satisfied yet
+
+        // bounded scoring, see ScoreBBActorVsRIF::init_for_bounded_scoring
+        std::vector<float> const * res_bound_ = nullptr;
+        float bound_cut_ = 9e9;
+        float bound_partial_ = 0;   // rif score of the residues done so far
+        float bound_remaining_ = 0; // optimistic score of the residues still to come, plus the clash bound
+        bool bound_pruned_ = false;
         
 	};
+	struct ScoreBBActorvsRIFBounds {
+		// the onebody energies these were computed from. the weak_ptr tells a freed table from a new one at the same address
+		std::vector<std::vector<float> > const * onebody = nullptr;
+		::scheme::weak_ptr< std::vector<std::vector<float> > > onebody_wp;
+		std::vector<float> res_bound; // best possible score of each residue, local numbering
+		float total = 0;              // sum of res_bound plus the best possible clash score
+	};
 
 	template< class BBActor, class RIF, class VoxelArrayPtr >
 	struct ScoreBBActorVsRIF
@@ -1323,10 +1341,16 @@ std::string get_rif_type_from_file( std::string fname )
         std::vector< int > requirements_;
         int max_req_no_ = 0;
 
+        // bounded scoring
+        shared_ptr< std::vector<float> > score_cut_per_thread_;
+        float rif_score_lb_ = 0;
+        std::vector<float> clash_lb_by_atype_;
+        std::vector< shared_ptr< ScoreBBActorvsRIFBounds > > boundsperthread_;
+
 	private:
 		shared_ptr<RIF const> rif_ = nullptr;
 	public:
-		VoxelArrayPtr target_proximity_test_grid_ = nullptr;
+		VoxelOccupancyCOP target_proximity_test_grid_;
 		RifScoreRotamerVsTarget rot_tgt_scorer_;
 		std::vector<int> always_available_rotamers_;
 
@@ -1387,6 +1411,70 @@ std::string get_rif_type_from_file( std::string fname )
 			}
 		}
 
+		///@brief lets a thread abandon a sample once it can no longer score below
+		///       (*score_cut_per_thread)[thread], see HSearchScoreAtReslTask. the score of an abandoned sample
+		///       is still above the cut, but is not its true score. residue bounds are the best rif score
+		///       anywhere in the rif (sat bonuses included) plus the best onebody energy of the residue;
+		///       the clash term is bounded by the most negative value of each atom type's grid. call after
+		///       sat_bonus_ is set; only valid if the other terms of the objective can't go below zero
+		void init_for_bounded_scoring(
+			shared_ptr< std::vector<float> > score_cut_per_thread,
+			std::vector< VoxelArrayPtr > const & clash_grids
+		){
+			runtime_assert( rif_ );
+			runtime_assert( !packing_ );
+			score_cut_per_thread_ = score_cut_per_thread;
+
+			rif_score_lb_ = 0;
+			typename RIF::Value::Decoded decoded;
+			for( auto const & v : rif_->map_ ){
+				v.second.decode( decoded );
+				for( int i_rs = 0; i_rs < decoded.size(); ++i_rs ) rif_score_lb_ = std::min( rif_score_lb_, decoded.score(i_rs) );
+			}
+			float lb = rif_score_lb_;
+			for( int i = 0; i < sat_bonus_.size(); ++i ){
+				if( sat_bonus_override_.at(i) ) lb = std::min( lb, sat_bonus_[i] );
+				else                            lb = std::min( lb, rif_score_lb_ + sat_bonus_[i] );
+			}
+			rif_score_lb_ = lb;
+
+			clash_lb_by_atype_.assign( clash_grids.size(), 0 );
+			for( int itype = 0; itype < clash_grids.size(); ++itype ){
+				if( !clash_grids[itype] || itype > ::scheme::actor::N_ATYPE ) continue; // these are clamped at 0
+				float const * data = clash_grids[itype]->data();
+				clash_lb_by_atype_[itype] = std::min( 0.0f, *std::min_element( data, data + clash_grids[itype]->num_elements() ) );
+			}
+
+			boundsperthread_.clear();
+			for( int i  = 0; i < ::devel::scheme::omp_max_threads_1(); ++i ){
+				boundsperthread_.push_back( make_shared<ScoreBBActorvsRIFBounds>() );
+			}
+		}
+
+		template<class Scene>
+		ScoreBBActorvsRIFBounds const & get_bounds( Scene const & scene, ScaffoldDataCache const & data_cache ) const
+		{
+			ScoreBBActorvsRIFBounds & bounds = *boundsperthread_.at( ::devel::scheme::omp_thread_num() );
+			if( bounds.onebody == data_cache.local_onebody_p.get() && !bounds.onebody_wp.expired() ) return bounds;
+
+			std::vector<std::vector<float> > const & onebody = *data_cache.local_onebody_p;
+			bounds.onebody = data_cache.local_onebody_p.get();
+			bounds.onebody_wp = data_cache.local_onebody_p;
+			bounds.res_bound.resize( onebody.size() );
+			bounds.total = 0;
+			for( int ires = 0; ires < onebody.size(); ++ires ){
+				float best1b = 9e9;
+				for( float e : onebody[ires] ) best1b = std::min( best1b, e );
+				bounds.res_bound[ires] = std::min( 0.0f, rif_score_lb_ + best1b );
+				bounds.total += bounds.res_bound[ires];
+			}
+			for( int ia = 0; ia < scene.template num_actors<SimpleAtom>(1); ++ia ){
+				int const itype = scene.template get_actor<SimpleAtom>(1,ia).type();
+				if( itype < clash_lb_by_atype_.size() ) bounds.total += clash_lb_by_atype_[itype];
+			}
+			return bounds;
+		}
+
 		template<class Scene, class Config>
 		void pre( Scene const & scene, Result & result, Scratch & scratch, Config const & config ) const
 		{
@@ -1435,6 +1523,15 @@ std::string get_rif_type_from_file( std::string fname )
                 
             }
 
+			if( score_cut_per_thread_ ){
+				scratch.bound_cut_ = score_cut_per_thread_->at( ::devel::scheme::omp_thread_num() );
+				if( scratch.bound_cut_ < 9e9 ){
+					ScoreBBActorvsRIFBounds const & bounds = get_bounds( scene, *data_cache );
+					scratch.res_bound_ = &bounds.res_bound;
+					scratch.bound_remaining_ = bounds.total;
+				}
+			}
+
 			if( !packing_ ) return;
 
 			// Added by brian ////////////////////////
@@ -1460,30 +1557,31 @@ std::string get_rif_type_from_file( std::string fname )
 		{
             if ( CB_too_close_manager_ ) scratch.cb_too_close_score_ += CB_too_close_manager_->get_CB_penalty( bb.position() );
 
-			if( target_proximity_test_grid_ && target_proximity_test_grid_->at( bb.position().translation() ) == 0.0 ){
-				return 0.0;
+			if( scratch.bound_pruned_ ) return 0.0;
+
+			if( target_proximity_test_grid_ && !target_proximity_test_grid_->at( bb.position().translation() ) ){
+				return bound_residue( bb.index_, 0.0, scratch );
 			}
 
 			const bool want_sats = scratch.burial_manager_;
 
 			typename RIF::Value const & rotscores = rif_->operator[]( bb.position() );
-			static int const Nrots = RIF::Value::N;
 			int const ires = bb.index_;
 			float bestsc = 0.0;
+			// unpack all rotamers/scores/sat flags of this bin at once
+			typename RIF::Value::Decoded decoded;
+			rotscores.decode( decoded );
             // loop over rotamers that we found in the rif
-			for( int i_rs = 0; i_rs < Nrots; ++i_rs ){
-				if( rotscores.empty(i_rs) ) {
-					break;
-				}
+			for( int i_rs = 0; i_rs < decoded.size(); ++i_rs ){
 				
                 // which irot did we get?
-                int irot = rotscores.rotamer(i_rs);
+                int irot = decoded.rotamer(i_rs);
                 if ( scratch.allowed_irots_ && ! scratch.allowed_irots_->at(ires)[irot] ) continue;
 
 				float const rot1be = (*scratch.rotamer_energies_1b_).at(ires).at(irot);
-				float score_rot_v_target = rotscores.score(i_rs);
+				float score_rot_v_target = decoded.score(i_rs);
 
-                bool rotamer_satisfies = rotscores.do_i_satisfy_anything(i_rs);
+                bool rotamer_satisfies = decoded.do_i_satisfy_anything(i_rs);
                 float sat_bonus = 0;
                 bool skip_scoring = false;
                 if ( rotamer_satisfies && sat_bonus_.size() > 0 ) {
@@ -1683,7 +1781,18 @@ std::string get_rif_type_from_file( std::string fname )
                 scratch.hackpack_->res_rots_.at(nres-1).second.front().second = 123460-2000; // big, but not so big it throws an error
             }
 
-			return bestsc;
+			return bound_residue( ires, bestsc, scratch );
+		}
+
+		///@brief bounded scoring bookkeeping once residue ires scored sc. the slack covers rounding in the sums
+		float bound_residue( int ires, float sc, Scratch & scratch ) const
+		{
+			if( scratch.res_bound_ ){
+				scratch.bound_partial_ += sc;
+				scratch.bound_remaining_ -= (*scratch.res_bound_)[ires];
+				scratch.bound_pruned_ = scratch.bound_partial_ + scratch.bound_remaining_ > scratch.bound_cut_ + 0.001f;
+			}
+			return sc;
 		}
 
 		template<class Scene, class Config>
@@ -2003,7 +2112,7 @@ std::string get_rif_type_from_file( std::string fname )
         typedef ScoreBBHBondActorvsRIFResult Result;
         typedef std::pair<RIFAnchor,BBHBondActor> Interaction;
         
-        VoxelArrayPtr target_proximity_test_grid_ = nullptr;
+        VoxelOccupancyCOP target_proximity_test_grid_;
         RifScoreRotamerVsTarget rot_tgt_scorer_;
         bool initialized_ = false;
         bool packing_ = false;
@@ -2032,7 +2141,7 @@ std::string get_rif_type_from_file( std::string fname )
 
             if ( ! initialized_ ) return 0.0; // this is to block lower resolutions
 
-            // if( target_proximity_test_grid_ && target_proximity_test_grid_->at( bbh.hbond_rays().front().horb_cen ) == 0.0 ){
+            // if( target_proximity_test_grid_ && !target_proximity_test_grid_->at( bbh.hbond_rays().front().horb_cen ) ){
             //     return 0.0;
             // }
 
@@ -2064,11 +2173,8 @@ std::string get_rif_type_from_file( std::string fname )
                 Eigen::Vector3f super_far_away(1e5, 1e5, 1e5);
 
                 for ( auto const & ray : bbh.hbond_rays() ) {
-                    std::vector<Sat>::const_iterator sats_iter =  rot_tgt_scorer_.target_acceptor_cache_->at( ray.horb_cen );
+                    for ( Sat don_or_acc : rot_tgt_scorer_.target_acceptor_cache_->at( ray.horb_cen ) ) {
 
-                    Sat don_or_acc = 0;
-                    while ( (don_or_acc = *(sats_iter++)) != DonorAcceptorCache::CACHE_MAX_SAT ) {
-  
                         don_or_acc += adder;
                         scratch.is_satisfied_.at(don_or_acc ) = true;
                         any = true;
@@ -2110,8 +2216,7 @@ std::string get_rif_type_from_file( std::string fname )
         typedef ScoreBBSasaActorvsRIFResult Result;
         typedef std::pair<RIFAnchor,BBSasaActor> Interaction;
 
-        shared_ptr<BurialVoxelArray> sasa_grid_;
-        float threshold_;
+        VoxelOccupancyCOP sasa_grid_; // where the sasa grid is above threshold
         float multiplier_;
         bool initialized_ = false;
 
@@ -2127,8 +2232,8 @@ std::string get_rif_type_from_file( std::string fname )
             float threshold,
             float multiplier
         ){
-            sasa_grid_ = sasa_grid;
-            threshold_ = threshold;
+            sasa_grid_ = nullptr;
+            if ( sasa_grid ) sasa_grid_ = make_shared<VoxelOccupancy>( *sasa_grid, [threshold]( float v ){ return v > threshold; } );
             multiplier_ = multiplier;
             initialized_ = true;
         }
@@ -2142,9 +2247,7 @@ std::string get_rif_type_from_file( std::string fname )
 
             for ( Eigen::Vector3f const & pt : bbs.sasa_points() ) {
 
-                float grid_score = sasa_grid_->at( pt );
-
-                if ( grid_score > threshold_ ) {
+                if ( sasa_grid_->at( pt ) ) {
                     score += 1;
                 }
 
@@ -2311,6 +2414,13 @@ struct RifFactoryImpl :
 		std::vector<ObjectivePtr> & packing_objectives
 	) const {
 
+		// the proximity tests only ask where the CH3 bounding grids are nonzero
+		std::vector<VoxelOccupancyCOP> target_proximity( 3 );
+		for( int i_tptg = 0; i_tptg < 3 && i_tptg < config.target_bounding_by_atype->size(); ++i_tptg ){
+			VoxelArrayPtr grid = config.target_bounding_by_atype->at(i_tptg).at(5);
+			if( grid ) target_proximity[i_tptg] = make_shared<VoxelOccupancy>( *grid, []( float v ){ return v != 0.0f; } );
+		}
+
 		for( int i_so = 0; i_so < config.rif_ptrs.size(); ++i_so ){
 			if( i_so <= config.rif_ptrs.size()-1 ){
 				if ( config.rif_ptrs[i_so] == nullptr ) continue;
@@ -2321,7 +2431,7 @@ struct RifFactoryImpl :
 					// std::cout << "resl " << config.resolutions[i_so] << " using target_prox_grid " << config.resolutions[i_tptg] << std::endl;
 					// use vdw grids as tgt proximity measure, use CH3 atom
 					objective->objective.template get_objective<MyScoreBBActorRIF>().target_proximity_test_grid_ =
-						config.target_bounding_by_atype->at(i_tptg).at(5);
+						target_proximity.at(i_tptg);
 				}
                 dynamic_cast<MySceneObjectiveRIF&>(*objective).objective.template
                     get_objective<MyScoreBBActorRIF>().ignore_rifres_if_worse_than = config.ignore_rifres_if_worse_than;
@@ -2418,6 +2528,16 @@ struct RifFactoryImpl :
             dynamic_cast<MySceneObjectiveRIF&>(*op).objective.template get_objective<MyScoreBBActorRIF>().sat_bonus_ = config.sat_bonus;
             dynamic_cast<MySceneObjectiveRIF&>(*op).objective.template get_objective<MyScoreBBActorRIF>().sat_bonus_override_ = config.sat_bonus_override;
 		}
+
+        // Bounded scoring needs every other term to be bounded too. The bbhbond, sasa, burial and atoms_close_together
+        //  terms only live on the last objective, so that one always scores in full
+        if ( config.score_cut_per_thread ) {
+            for( int i_obj = 0; i_obj+1 < objectives.size(); ++i_obj ){
+                MySceneObjectiveRIF & objective = dynamic_cast<MySceneObjectiveRIF&>(*objectives[i_obj]);
+                objective.objective.template get_objective<MyScoreBBActorRIF>().init_for_bounded_scoring(
+                    config.score_cut_per_thread, config.target_bounding_by_atype->at( objective.config ) );
+            }
+        }
 		// dynamic_cast<MySceneObjectiveRIF&>(*packing_objective).objective.template get_objective<MyScoreBBActorRIF>().rotamer_energies_1b_ = config.local_onebody;
 		// dynamic_cast<MySceneObjectiveRIF&>(*packing_objective).objective.template get_objective<MyScoreBBActorRIF>().scaffold_rotamers_ = config.local_rotamers;
 
@@ -2432,7 +2552,7 @@ struct RifFactoryImpl :
             local_packopts.rescore_rots_before_insertion = i_so == packing_objectives.size() - 1;
 
     		dynamic_cast<MySceneObjectiveRIF&>(*packing_objective).objective.template get_objective<MyScoreBBActorRIF>()
-    							.target_proximity_test_grid_ = config.target_bounding_by_atype->at(2).at(5);
+    							.target_proximity_test_grid_ = target_proximity.at(2);
     		dynamic_cast<MySceneObjectiveRIF&>(*packing_objective).objective.template get_objective<MyScoreBBActorRIF>().init_for_packing(
     			// *config.local_twobody,
     			config.rot_index_p,
@@ -2444,13 +2564,13 @@ struct RifFactoryImpl :
         // Only want to do BBHbonds at highest resl otherwise they are meaningless
         if ( objectives.size() ) {
             dynamic_cast<MySceneObjectiveRIF&>(*objectives.back()).objective.template get_objective<MyScoreBBHBondActorRIF>()
-                                    .target_proximity_test_grid_ = config.target_bounding_by_atype->at(2).at(5);
+                                    .target_proximity_test_grid_ = target_proximity.at(2);
             dynamic_cast<MySceneObjectiveRIF&>(*objectives.back()).objective.template get_objective<MyScoreBBHBondActorRIF>()
                                     .init( config.rot_tgt_scorer, config.scaff_bb_hbond_weight, false );
         }
         if ( packing_objectives.back() ) {
             dynamic_cast<MySceneObjectiveRIF&>(*packing_objectives.back()).objective.template get_objective<MyScoreBBHBondActorRIF>()
-                                    .target_proximity_test_grid_ = config.target_bounding_by_atype->at(2).at(5);
+                                    .target_proximity_test_grid_ = target_proximity.at(2);
             dynamic_cast<MySceneObjectiveRIF&>(*packing_objectives.back()).objective.template get_objective<MyScoreBBHBondActorRIF>()
                                     .init( config.rot_tgt_scorer, config.scaff_bb_hbond_weight, true );
         }
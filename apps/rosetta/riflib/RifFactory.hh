@@ -144,6 +144,7 @@ struct RifSceneObjectiveConfig
     std::vector< std::vector<bool> > pdbinfo_req_active_requirements;
     std::vector<float> sat_bonus;
     std::vector<bool> sat_bonus_override;
+    shared_ptr<std::vector<float>> score_cut_per_thread; // bounded hsearch scoring, cut of each thread, 9e9 = off
 
 };
 
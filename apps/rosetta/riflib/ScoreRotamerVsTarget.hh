@@ -248,10 +248,7 @@ struct ScoreRotamerVsTarget {
             if ( target_donor_cache_ ) {
 
                 typedef typename DonorAcceptorCache::Sat Sat;
-                std::vector<Sat>::const_iterator sats_iter = target_donor_cache_->at( hr_rot_acc.horb_cen );
-
-                Sat i_hr_tgt_don = 0;
-                while ( (i_hr_tgt_don = *(sats_iter++)) != DonorAcceptorCache::CACHE_MAX_SAT ) {
+                for ( Sat i_hr_tgt_don : target_donor_cache_->at( hr_rot_acc.horb_cen ) ) {
 
                     /////////////// DUPLICATE CODE ///////////////////////////////////////////
                     HBondRay const & hr_tgt_don = target_donors_.at(i_hr_tgt_don);
@@ -328,10 +325,7 @@ struct ScoreRotamerVsTarget {
             if ( target_acceptor_cache_ ) {
 
                 typedef typename DonorAcceptorCache::Sat Sat;
-                std::vector<Sat>::const_iterator sats_iter =  target_acceptor_cache_->at( hr_rot_don.horb_cen );
-
-                Sat i_hr_tgt_acc = 0;
-                while ( (i_hr_tgt_acc = *(sats_iter++)) != DonorAcceptorCache::CACHE_MAX_SAT ) {
+                for ( Sat i_hr_tgt_acc : target_acceptor_cache_->at( hr_rot_don.horb_cen ) ) {
 
                     /////////////// DUPLICATE CODE ///////////////////////////////////////////
                     HBondRay const & hr_tgt_acc = target_acceptors_.at(i_hr_tgt_acc);
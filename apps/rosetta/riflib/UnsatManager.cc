@@ -322,6 +322,7 @@ UnsatManager::set_target_donors_acceptors(
     target_donors_acceptors_.insert( target_donors_acceptors_.end(), target_acceptors.begin(), target_acceptors.end());
     num_donors_ = target_donors.size();
 
+    update_heavy_atom_per_sat();
 
     if (debug_) {
         for ( int i = 0; i < target_heavy_atoms_.size(); i++ ) {
@@ -388,6 +389,18 @@ UnsatManager::add_target_sat(
 }
 
 
+// sat -> heavy atom, -1 for sats whose heavy atom was removed
+void
+UnsatManager::update_heavy_atom_per_sat() {
+    heavy_atom_per_sat_.assign( target_donors_acceptors_.size(), -1 );
+    for ( int ih = 0; ih < target_heavy_atoms_.size(); ih++ ) {
+        for ( int sat : target_heavy_atoms_[ih].sat_groups ) {
+            runtime_assert( sat < heavy_atom_per_sat_.size() );
+            heavy_atom_per_sat_[sat] = ih;
+        }
+    }
+}
+
 bool
 UnsatManager::validate_heavy_atoms() {
     bool good = true;
@@ -566,6 +579,7 @@ UnsatManager::patch_heavy_atoms( int resid, std::string const & heavy_atom, hbon
             }
             int remaining = burial_manager->remove_heavy_atom( heavy_atom_no );
             runtime_assert( target_heavy_atoms_.size() == remaining );
+            update_heavy_atom_per_sat();
             break;
         }
         case hbond::NOT_BURIED: {
@@ -967,6 +981,8 @@ UnsatManager::prepare_packer(
 ) {
     runtime_assert( burial_weights.size() == target_heavy_atoms_.size() );
     runtime_assert( pre_and_bb_satisfied.size() == target_presatisfied_.size());
+    runtime_assert( heavy_atom_per_sat_.size() == target_donors_acceptors_.size() );
+    runtime_assert( pre_and_bb_satisfied.size() <= heavy_atom_per_sat_.size() );
 
     if (debug_) {
 
@@ -1001,11 +1017,13 @@ UnsatManager::prepare_packer(
     float zerobody_penalty = 0;
     zerobody_penalty += score_offset_;
 
-    // satisfiers are the index of a rotamer in to_pack_rots_
-    // -1 is the target
-    std::vector<std::vector<std::vector<int>>> per_heavy_per_orb_satisfiers( burial_weights.size() );
-
-    std::vector<int> heavy_atom_per_sat( target_donors_acceptors_.size(), -1 );
+    // the sat -> heavy atom map only changes when heavy atoms are patched, so it is built once
+    //  up front. here we only need to know which of those heavy atoms are buried this time
+    auto buried_heavy_atom = [&]( int sat ) -> int {
+        const int heavy_atom_no = heavy_atom_per_sat_[sat];
+        if ( heavy_atom_no == -1 || burial_weights[heavy_atom_no] == 0 ) return -1;
+        return heavy_atom_no;
+    };
 
 
 ////////////////////////////////////////////////////////////////////////
@@ -1026,8 +1044,7 @@ UnsatManager::prepare_packer(
                     << " heavy atom: " << ih << std::endl;
 
     // 3. Find all orbitals of said heavy atoms
-        for ( int sat : ha.sat_groups ) heavy_atom_per_sat[sat] = ih;
-
+    //      (heavy_atom_per_sat_ / buried_heavy_atom())
     }
 
         
@@ -1036,16 +1053,34 @@ UnsatManager::prepare_packer(
     // 4. Identify all of their satisfiers (including scaffold backbone and target)
     // 5.   Assign P0 as a bonus to all satisfiers
 
-    std::vector<std::vector<int>> sat_satsifiers( target_donors_acceptors_.size() );
+    //       satisfiers are the index of a rotamer in to_pack_rots_, -1 is the target
+    //       only the sats of buried heavy atoms are looked at below, so only those are stored.
+    //       the lists are csr style in member buffers, so nothing is allocated per pack:
+    //       the satisfiers of isat are sat_satisfiers_[sat_satisfier_offsets_[isat]] up to [isat+1]
+    //       and are ordered target first, then by ipack
+
+    const int nsats = heavy_atom_per_sat_.size();
+    sat_satisfier_offsets_.assign( nsats + 1, 0 );
+    for ( int isat = 0; isat < pre_and_bb_satisfied.size(); isat++ ) {
+        if ( pre_and_bb_satisfied[isat] && buried_heavy_atom( isat ) > -1 ) sat_satisfier_offsets_[isat+1]++;
+    }
+    for ( ToPackRot const & to_pack_rot : to_pack_rots_ ) {
+        if ( to_pack_rot.sat1 > -1 && buried_heavy_atom( to_pack_rot.sat1 ) > -1 ) sat_satisfier_offsets_[to_pack_rot.sat1+1]++;
+        if ( to_pack_rot.sat2 > -1 && buried_heavy_atom( to_pack_rot.sat2 ) > -1 ) sat_satisfier_offsets_[to_pack_rot.sat2+1]++;
+    }
+    for ( int isat = 0; isat < nsats; isat++ ) sat_satisfier_offsets_[isat+1] += sat_satisfier_offsets_[isat];
+    sat_satisfiers_.resize( sat_satisfier_offsets_[nsats] );
+    sat_satisfier_cursor_.assign( sat_satisfier_offsets_.begin(), sat_satisfier_offsets_.end() - 1 );
 
     //       first find target presatisfiers
 
     for ( int isat = 0; isat < pre_and_bb_satisfied.size(); isat++ ) {
         if ( pre_and_bb_satisfied[isat] ) {
-            sat_satsifiers[isat].push_back(-1);
 
-            const int heavy_atom_no = heavy_atom_per_sat[isat];
+            const int heavy_atom_no = buried_heavy_atom( isat );
             if ( heavy_atom_no > -1 ) {
+                sat_satisfiers_[ sat_satisfier_cursor_[isat]++ ] = -1;
+
                 const int heavy_atom_type = target_heavy_atoms_[heavy_atom_no].AType;
                 const float weight = burial_weights[heavy_atom_no];
                 zerobody_penalty += - total_first_twob_[heavy_atom_type][1] * weight * unsat_score_scalar_;
@@ -1062,10 +1097,10 @@ UnsatManager::prepare_packer(
         ToPackRot & to_pack_rot = to_pack_rots_[ipack];
 
         if ( to_pack_rot.sat1 > -1 ) {
-            sat_satsifiers[to_pack_rot.sat1].push_back(ipack);
 
-            const int heavy_atom_no = heavy_atom_per_sat[to_pack_rot.sat1];
+            const int heavy_atom_no = buried_heavy_atom( to_pack_rot.sat1 );
             if ( heavy_atom_no > -1 ) {
+                sat_satisfiers_[ sat_satisfier_cursor_[to_pack_rot.sat1]++ ] = ipack;
                 const int heavy_atom_type = target_heavy_atoms_[heavy_atom_no].AType;
                 const float weight = burial_weights[heavy_atom_no];
                 to_pack_rot.score += - total_first_twob_[heavy_atom_type][1] * weight * unsat_score_scalar_;
@@ -1076,10 +1111,10 @@ UnsatManager::prepare_packer(
         }
 
         if ( to_pack_rot.sat2 > -1 ) {
-            sat_satsifiers[to_pack_rot.sat2].push_back(ipack);
 
-            const int heavy_atom_no = heavy_atom_per_sat[to_pack_rot.sat2];
+            const int heavy_atom_no = buried_heavy_atom( to_pack_rot.sat2 );
             if ( heavy_atom_no > -1 ) {
+                sat_satisfiers_[ sat_satisfier_cursor_[to_pack_rot.sat2]++ ] = ipack;
                 const int heavy_atom_type = target_heavy_atoms_[heavy_atom_no].AType;
                 const float weight = burial_weights[heavy_atom_no];
                 to_pack_rot.score += - total_first_twob_[heavy_atom_type][1] * weight * unsat_score_scalar_;
@@ -1105,11 +1140,12 @@ UnsatManager::prepare_packer(
         const float P0 = total_first_twob_[ha.AType][1] * weight * unsat_score_scalar_;
 
         for ( int isat : ha.sat_groups ) {
-            std::vector<int> const & local_sat_satsifiers = sat_satsifiers[isat];
+            int const * local_sat_satsifiers = sat_satisfiers_.data() + sat_satisfier_offsets_[isat];
+            const int num_local = sat_satisfier_offsets_[isat+1] - sat_satisfier_offsets_[isat];
 
             // upper triangle for loop
-            for ( int ilocal = 0; ilocal < (int)local_sat_satsifiers.size() - 1; ilocal ++ ) {
-                for ( int jlocal = ilocal + 1; jlocal < local_sat_satsifiers.size(); jlocal++ ) {
+            for ( int ilocal = 0; ilocal < num_local - 1; ilocal ++ ) {
+                for ( int jlocal = ilocal + 1; jlocal < num_local; jlocal++ ) {
                     zerobody_penalty += handle_twobody( local_sat_satsifiers[ilocal], local_sat_satsifiers[jlocal], P0, packer );
 
 
@@ -1131,16 +1167,18 @@ UnsatManager::prepare_packer(
         for ( int iorb = 0; iorb < (int)ha.sat_groups.size() - 1; iorb ++) {
 
             const int isat = ha.sat_groups[iorb];
-            std::vector<int> const & iorb_satisfiers = sat_satsifiers[isat];
+            int const * iorb_satisfiers = sat_satisfiers_.data() + sat_satisfier_offsets_[isat];
+            const int num_iorb = sat_satisfier_offsets_[isat+1] - sat_satisfier_offsets_[isat];
 
             for ( int jorb = iorb + 1; jorb < ha.sat_groups.size(); jorb++ ) {
 
                 const int jsat = ha.sat_groups[jorb];
-                std::vector<int> const & jorb_satisfiers = sat_satsifiers[jsat];
+                int const * jorb_satisfiers = sat_satisfiers_.data() + sat_satisfier_offsets_[jsat];
+                const int num_jorb = sat_satisfier_offsets_[jsat+1] - sat_satisfier_offsets_[jsat];
 
                 // all x all of iorb_satisfiers against jorb_satisfiers
-                for ( int ilocal = 0; ilocal < iorb_satisfiers.size(); ilocal++ ) {
-                    for ( int jlocal = 0; jlocal < jorb_satisfiers.size(); jlocal++ ) {
+                for ( int ilocal = 0; ilocal < num_iorb; ilocal++ ) {
+                    for ( int jlocal = 0; jlocal < num_jorb; jlocal++ ) {
                         zerobody_penalty += handle_twobody( iorb_satisfiers[ilocal], jorb_satisfiers[jlocal], twob_penalty, packer );
 
                         if (debug_) std::cout << "heavy atom clash: " << twob_penalty << " heavy_atom: " << ih
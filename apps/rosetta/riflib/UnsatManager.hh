@@ -330,6 +330,9 @@ struct UnsatManager {
     bool
     validate_heavy_atoms();
 
+    void
+    update_heavy_atom_per_sat();
+
 // private:
 
     int num_donors_;
@@ -338,6 +341,7 @@ struct UnsatManager {
     std::vector<bool> target_presatisfied_;
     std::vector<std::vector<float>> unsat_penalties_;
     std::vector<std::vector<float>> total_first_twob_;  // total penalty, P0, P0 * (1 - P1)
+    std::vector<int> heavy_atom_per_sat_;  // -1 if the sat has no heavy atom
     shared_ptr< RotamerIndex > rot_index_p;
     float unsat_score_scalar_;
     int require_burial_;
@@ -351,6 +355,11 @@ struct UnsatManager {
     std::vector<ToPackRot> to_pack_rots_;
     std::vector<std::array<int, 4>> modified_edges_;
 
+// prepare_packer() scratch, kept so that packing doesn't allocate
+    std::vector<int> sat_satisfier_offsets_;
+    std::vector<int> sat_satisfier_cursor_;
+    std::vector<int> sat_satisfiers_;
+
 };
 
 
@@ -48,11 +48,16 @@ struct RIFAccumulatorMapThreaded : public RifAccumulator {
 	}
 
 	bool initialize_with_rif( shared_ptr<RifBase> & rif ) override {
-		return rif->get_xmap_ptr( xmap_ptr_ );
+		if( !rif->get_xmap_ptr( xmap_ptr_ ) ) return false;
+		xmap_ptr_->prefilter_.clear(); // we write map_ directly, a loaded prefilter would go stale
+		return true;
 	}
 
 	uint64_t n_motifs_found() const override { return N_motifs_found_ + total_samples(); }
 
+	uint64_t get_key( EigenXform const & x ) const override { return xmap_ptr_->hasher_.get_key( x ); }
+	EigenXform get_center( uint64_t key ) const override { return xmap_ptr_->hasher_.get_center( key ); }
+
 	shared_ptr<RifBase> rif() const override {
 		shared_ptr<RifBase> r = rif_factory_->create_rif();
 		r->set_xmap_ptr( xmap_ptr_ );
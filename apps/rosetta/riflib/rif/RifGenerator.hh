@@ -56,6 +56,8 @@ struct RifAccumulator {
 	virtual uint64_t count_these_irots( int irot_low, int irot_high ) const = 0;
 	virtual std::set<size_t> get_sats_of_this_irot( devel::scheme::EigenXform const & x, int irot ) const = 0;
 	virtual bool initialize_with_rif( shared_ptr<RifBase> & rif ) = 0;
+	virtual uint64_t get_key( EigenXform const & x ) const = 0; // rif bin of x
+	virtual EigenXform get_center( uint64_t key ) const = 0;
 };
 typedef shared_ptr<RifAccumulator> RifAccumulatorP;
 
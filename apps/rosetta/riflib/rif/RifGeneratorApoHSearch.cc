@@ -44,6 +44,7 @@
 	// #include <scheme/objective/hash/XformMap.hh>
 	// #include <scheme/objective/storage/RotamerScores.hh>
 	#include <scheme/objective/voxel/FieldCache.hh>
+	#include <scheme/search/SpatialBandB.hh>
 	// #include <scheme/objective/voxel/VoxelArray.hh>
 	#include <scheme/rosetta/score/RosettaField.hh>
 	#include <scheme/util/StoragePolicy.hh>
@@ -609,100 +610,50 @@ namespace rif {
 			Objective objective;
 
 			std::vector< std::vector< SearchPoint > > samples( RESLS.size() );
-				samples[0].resize( d.nest_.size(0) );
-				for( uint64_t i = 0; i < d.nest_.size(0); ++i )	samples[0][i] = SearchPoint( i );
-
-			for( int r = 0; r < RESLS.size()-1; ++r){
-				if( 0 == samples[r].size() ) break;
-				cout << "Hstage: " << r << " resl: " << F(4,2,RESLS[r]) << " nsamp: " << KMGT(samples[r].size()) << " ";
-				int64_t const out_interval = samples[r].size()/50;
-				std::exception_ptr exception = nullptr;
-				#ifdef USE_OPENMP
-				#pragma omp parallel for schedule(dynamic,8192)
-				#endif
-				for( int64_t i = 0; i < samples[r].size(); ++i ){
-					if( exception ) continue;
-					try {
-						if( i%out_interval==0 ){
-							cout << '*'; cout.flush();// (float)i/samples[r].size()*100.0 << "% "; cout.flush();
-						}
-						// uint64_t i = numeric::random::uniform()*d.nest_.size(0);
-						uint64_t const isamp = samples[r][i].index;
-						Scene & tscene( scene_per_thread[omp_get_thread_num()] );
-						d.set_scene( isamp, r, tscene );
-						// this is necssary, lots seem to have the same score
-						samples[r][i].score = /*samples[r][i].rank =*/ objective( tscene, r ).template get<VoxelScore>();// - numeric::random::uniform()/1000.0;
-					} catch( ... ) {
-						#ifdef USE_OPENMP
-						#pragma omp critical
-						#endif
-						exception = std::current_exception();
-					}
-				}
-				if( exception ) std::rethrow_exception(exception);
-
-				SearchPoint max_pt, min_pt;
-				int64_t len = samples[r].size();
-				if( samples[r].size() > beam_size/DIMPOW2 ){
-					__gnu_parallel::nth_element( samples[r].begin(), samples[r].begin()+beam_size/DIMPOW2, samples[r].end() );
-					len = beam_size/DIMPOW2;
-					min_pt = *__gnu_parallel::min_element( samples[r].begin(), samples[r].begin()+len );
-					max_pt = *(samples[r].begin()+beam_size/DIMPOW2);
-				} else {
-					min_pt = *__gnu_parallel::min_element( samples[r].begin(), samples[r].end() );
-					max_pt = *__gnu_parallel::max_element( samples[r].begin(), samples[r].end() );
-				}
+			{
+				// every stage but the last goes through the shared beam search; the last one is walked
+				//  below, straight into the rif, without building its samples
+				std::vector< SearchPoint > & stage_samples = samples[ RESLS.size()-2 ];
+				stage_samples.resize( d.nest_.size(0) );
+				for( uint64_t i = 0; i < d.nest_.size(0); ++i ) stage_samples[i] = SearchPoint( i );
 
 				float const hsearch_score_cut = std::min( opts.abs_score_cut, abs_score_cut_by_res_thisres );
-				omp_set_lock(&cout_lock);
-				cout << " branching: " << F(9,6,min_pt.score) << " to " << F(9,6, std::min(hsearch_score_cut,max_pt.score)) << endl;
-				omp_unset_lock(&cout_lock);
-
-				// this hackyness is necessary.. don't want to explicidly build final samples vector... too big
-				if( r+2 >= samples.size() ) break;
-
-				// cout << "populating new sample array" << endl; // 26 sec for 2G... can speed up with threads?
-				std::vector< std::vector< SearchPoint > > samples_thread(omp_max_threads_1());
-
-				// #ifdef USE_OPENMP
-				// #pragma omp parallel for schedule(dynamic,1024)
-				// #endif
-				// for( int64_t i = 0; i < len; ++i ){
-				// 	if( samples[r][i].score > hsearch_score_cut ) continue;
-				// 	uint64_t isamp0 = samples[r][i].index;
-				// 	for( uint64_t j = 0; j < DIMPOW2; ++j ){
-				// 		uint64_t isamp = isamp0 * DIMPOW2 + j;
-				// 		samples_thread[omp_get_thread_num()].push_back( SearchPoint(isamp) );
-				// 	}
-				// }
-				// for( int i = 0; i < samples_thread.size(); ++i ){
-				// 	  std::copy ( samples_thread[i].begin(), samples_thread[i].end(), std::back_inserter( samples[r+1] ) );
-				// }
-				// samples[r+1].reserve( beam_size );
-				for( int64_t i = 0; i < len; ++i ){
-					if( samples[r][i].score > hsearch_score_cut ) continue;
-					uint64_t isamp0 = samples[r][i].index;
-					for( uint64_t j = 0; j < DIMPOW2; ++j ){
-						uint64_t isamp = isamp0 * DIMPOW2 + j;
-						samples[r+1].push_back( SearchPoint(isamp) );
-					}
-				}
-				// cout << "done populating new sample array, clearing" << endl;
-				samples[r].clear();
-
+				::scheme::search::SpatialBandB< SearchPoint > bandb( ::scheme::search::FixedBeam( beam_size/DIMPOW2 ), DIMPOW2 );
+				bandb.score_cut_ = hsearch_score_cut;
+				bandb.chunk_ = 8192;
+				bandb.progress_marks_ = 50;
+				bandb.begin_stage_ = [&]( int r, uint64_t nsamp ){
+					cout << "Hstage: " << r << " resl: " << F(4,2,RESLS[r]) << " nsamp: " << KMGT(nsamp) << " ";
+				};
+				bandb.end_stage_ = [&]( int r, ::scheme::search::BeamStats< SearchPoint > const & stats ){
+					cout << " branching: " << F(9,6,stats.best.score) << " to " << F(9,6, std::min(hsearch_score_cut,stats.worst.score)) << endl;
+				};
+				auto score = [&]( SearchPoint & samp, int r, int ithread, float ){
+					Scene & tscene( scene_per_thread[ithread] );
+					d.set_scene( samp.index, r, tscene );
+					samp.score = objective( tscene, r ).template get<VoxelScore>();
+				};
+				bandb.search( stage_samples, RESLS.size()-1, score, bandb.nest_child() );
 			}
 
+			// the final stage is streamed: only the nest indices of the parents under the cut are kept, and
+			//  their children are scored and inserted into the rif block by block, never stored
 			float const final_score_cut = std::min( opts.abs_score_cut, abs_score_cut_by_res_thisres );
-			uint64_t num_final_samples = 0;{
-				std::vector<uint64_t> tmp(omp_max_threads_1(),0);
+			std::vector< uint64_t > final_parents;
+			{
+				std::vector< SearchPoint > const & parent_samples = samples[ RESLS.size()-2 ];
+				::scheme::search::select_indices( parent_samples.size(),
+					[&]( uint64_t i ){ return !( parent_samples[i].score > final_score_cut ); }, final_parents );
 				#ifdef USE_OPENMP
-				#pragma omp parallel for schedule(dynamic,8192)
+				#pragma omp parallel for schedule(static)
 				#endif
-				for( int64_t i = 0; i < samples[RESLS.size()-2].size(); ++i ){
-					tmp[omp_get_thread_num()] += ( samples[RESLS.size()-2][i].score < final_score_cut );
+				for( int64_t i = 0; i < final_parents.size(); ++i ){
+					final_parents[i] = parent_samples[ final_parents[i] ].index;
 				}
-				for( int i = 0; i < tmp.size(); ++i ) num_final_samples += tmp[i];
+				samples[ RESLS.size()-2 ].clear();
+				samples[ RESLS.size()-2 ].shrink_to_fit();
 			}
+			uint64_t const num_final_samples = final_parents.size();
 
 
 			// final
@@ -719,17 +670,17 @@ namespace rif {
 				std::vector<TestHit> test_hits;
 				int r = RESLS.size()-1;
 				cout << "Hstage: " << r << " resl: " << F(4,2,RESLS.back()) << " nsamp: " << KMGT(num_final_samples*DIMPOW2) << " ";
-				int64_t const out_interval = samples[r-1].size()/50;
+				int64_t const out_interval = std::max<int64_t>( final_parents.size()/50, 1 );
 				float min_score = 9e9;
 				std::vector<double> avg_scores( omp_max_threads_1(), 0.0 );
 				std::vector<uint64_t> avg_scores_count( omp_max_threads_1(), 0 );
 				std::exception_ptr exception = nullptr;
 
-				int64_t block_size = 8192;
-				for( int64_t iblock = 0; iblock < samples[r-1].size()/block_size; ++iblock )
+				int64_t const block_size = 8192;
+				int64_t const num_final_parents = final_parents.size();
+				for( int64_t block_begin = 0; block_begin < num_final_parents; block_begin += block_size )
 				{
-					int64_t block_begin = iblock * block_size;
-					int64_t block_end = std::min<int64_t>( samples[r-1].size(), block_begin+block_size );
+					int64_t block_end = std::min<int64_t>( num_final_parents, block_begin+block_size );
 
 					#ifdef USE_OPENMP
 					#pragma omp parallel for schedule(dynamic,1)
@@ -740,8 +691,7 @@ namespace rif {
 							if( i%out_interval==0 ){
 								cout << '*'; cout.flush();// (float)i/samples[r].size()*100.0 << "% "; cout.flush();
 							}
-							if( samples[r-1][i].score > final_score_cut ) continue;
-							uint64_t isamp0 = samples[r-1][i].index;
+							uint64_t isamp0 = final_parents[i];
 							for( uint64_t j = 0; j < DIMPOW2; ++j ){
 								uint64_t isamp = isamp0 * DIMPOW2 + j;
 								Scene & tscene( scene_per_thread[omp_get_thread_num()] );
@@ -83,19 +83,39 @@ struct hbjob_hbgeom_lessthan {
 
         
         
+std::string
+RifGeneratorSimpleHbonds::hbgeom_cache_prefix() const {
+    std::string prefix = "__HBOND_GEOMS";
+        prefix += "__maxtip" + boost::lexical_cast<std::string>( opts.tip_tol_deg    ) ;
+        prefix += "__resl"   + boost::lexical_cast<std::string>( opts.rot_samp_resl  ) ;
+        prefix += "__range"  + boost::lexical_cast<std::string>( opts.rot_samp_range ) ;
+        prefix += "__ex1_0";
+        prefix += "__ex2_0";
+        prefix += "__ex3_0";
+        prefix += "__ex4_0";
+    return prefix;
+}
+
+// key of an hbgeomtag in the mapped cache file, the per tag part of the .rel_rot_pos.gz name
+static std::string
+hbgeom_mapped_key( int nrots, std::string const & hbgeomtag ){
+    return "__nrots" + boost::lexical_cast<std::string>( nrots ) + "__" + hbgeomtag;
+}
+
 void
 RifGeneratorSimpleHbonds::prepare_hbgeoms( 
     std::vector<HBJob> const & hb_jobs,
     int start_job,
     int end_job,    // python style numbering. To do all jobs, specify 0, hb_jobs.size()
-    std::map< std::string, utility::vector1< RelRotPos > * > & hbond_geoms_cache,
+    std::map< std::string, HbondGeoms * > & hbond_geoms_cache,
     std::map< std::string, omp_lock_t > & hbond_io_locks,
     omp_lock_t & cout_lock,
     omp_lock_t & io_lock,
     omp_lock_t & pose_lock,
     omp_lock_t & hacky_rpms_lock,
     omp_lock_t & hbond_geoms_cache_lock,
-    RifGenParamsP const & params
+    RifGenParamsP const & params,
+    MappedHbondGeomFile const & mapped_cache
 ) {
 
     using std::cout;
@@ -121,6 +141,20 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
         int ir =  hb_jobs[ihbjob].ires;
         std::string hbgeomtag = hb_jobs[ihbjob].hbgeomtag; //don_or_acc + don + "-" + acc;
 
+        // tags in the mapped cache were set up from it before any job runs. mapped_cache itself doesn't
+        //  change in here, but other jobs may be filling hbond_geoms_cache, so that's read under its lock
+        if( mapped_cache.has( hbgeom_mapped_key( nrots, hbgeomtag ) ) ){
+            bool set_up = false;
+            omp_set_lock( & hbond_geoms_cache_lock );
+            {
+                auto mapped = hbond_geoms_cache.find( hbgeomtag );
+                set_up = mapped != hbond_geoms_cache.end() && mapped->second && mapped->second->is_mapped();
+            }
+            omp_unset_lock( & hbond_geoms_cache_lock );
+            if( ! set_up ) utility_exit_with_message( "hbgeom in mapped cache but not set up: " + hbgeomtag );
+            continue;
+        }
+
         // std::cout << hbgeomtag << std::endl;
         // continue;
 
@@ -151,12 +185,12 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
         }
 
         bool need_to_init = false;
-        utility::vector1< RelRotPos > * cache = nullptr;
+        HbondGeoms * cache = nullptr;
         omp_set_lock( & hbond_geoms_cache_lock );
         {
             need_to_init = ! hbond_geoms_cache[hbgeomtag];
             if ( need_to_init ) {
-                cache = new utility::vector1< RelRotPos >;
+                cache = new HbondGeoms;
                 hbond_geoms_cache[hbgeomtag] = cache;
             }
         }
@@ -172,16 +206,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
             omp_set_lock( &hbond_io_locks[hbgeomtag] ); // make sure nobody tries to use this while filling in...
 
 
-            std::string cachefile = "__HBOND_GEOMS";
-                cachefile += "__maxtip" + boost::lexical_cast<std::string>( opts.tip_tol_deg    ) ;
-                cachefile += "__resl"   + boost::lexical_cast<std::string>( opts.rot_samp_resl  ) ;
-                cachefile += "__range"  + boost::lexical_cast<std::string>( opts.rot_samp_range ) ;
-                cachefile += "__ex1_0";
-                cachefile += "__ex2_0";
-                cachefile += "__ex3_0";
-                cachefile += "__ex4_0";
-                cachefile += "__nrots"  + boost::lexical_cast<std::string>( nrots ) ;
-                cachefile += "__" + hbgeomtag + ".rel_rot_pos.gz";
+            std::string cachefile = hbgeom_cache_prefix() + hbgeom_mapped_key( nrots, hbgeomtag ) + ".rel_rot_pos.gz";
 
 
             bool failed_to_read = true;
@@ -201,21 +226,21 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
                 size_t n;
                 runtime_assert( instream.good() );
                 instream.read( (char*)(&n), sizeof(size_t) );
-                cache->resize( n );
+                cache->owned.resize( n );
                 for(size_t i = 0; i < n; ++i){
                     if( !instream.good() ) break;
                     RelRotPos r;
                     instream.read( (char*)(&r), sizeof(RelRotPos) );
-                    cache->at(i+1) = r;
+                    cache->owned.at(i+1) = r;
                 }
                 instream.close();
                 runtime_assert( instream.good() );
-                failed_to_read = cache->size() != n;
+                failed_to_read = cache->owned.size() != n;
             }
 
             if( failed_to_read ){
 
-                utility::vector1< RelRotPos > & hbond_geoms( *hbond_geoms_cache[hbgeomtag] );
+                utility::vector1< RelRotPos > & hbond_geoms( cache->owned );
 
                 omp_set_lock(&cout_lock);
                 cout << "GENERATING HBOND GEOMETRIES pair " << ihbjob+1 << " of " << hb_jobs.size()
@@ -261,6 +286,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
                 }
             }
 
+            cache->use_owned();
             omp_unset_lock( &hbond_io_locks[hbgeomtag] ); // now is ready
 
 
@@ -693,8 +719,10 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
 		// }
 		// utility_exit_with_message("check HBJob LIST");
 
-		std::map< std::string, utility::vector1< RelRotPos > * > hbond_geoms_cache;
+		MappedHbondGeomFile mapped_cache; // must outlive hbond_geoms_cache, which may view into it
+		std::map< std::string, HbondGeoms * > hbond_geoms_cache;
 		std::map< std::string, omp_lock_t > hbond_io_locks;
+		std::map< std::string, std::string > hbgeom_mapped_keys;
 		for( int ihbjob = 0; ihbjob < hb_jobs.size(); ++ihbjob ){
 			std::string don = hb_jobs[ihbjob].don;
 			std::string acc = hb_jobs[ihbjob].acc;
@@ -712,27 +740,76 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
     			hbond_io_locks[ hbgeomtag ] = tmplock;
     			omp_init_lock( & hbond_io_locks[ hbgeomtag ] );
             }
+            hbgeom_mapped_keys[ hbgeomtag ] = hbgeom_mapped_key( hb_jobs[ihbjob].nrots, hbgeomtag );
 		}
 
+        // all hbgeomtags in one uncompressed file, mapped read only. pages are shared by every rifgen
+        // process on the node and nothing is copied, so these tags skip the per tag load and locks
+        std::string const mapped_cache_fname = hbgeom_cache_prefix() + ".rel_rot_pos.mapped";
+        size_t num_mapped = 0;
+        if( opts.hbgeom_mapped_cache ){
+            for( auto const & dir : cache_data_path ){
+                if( utility::file::file_exists( dir + "/" + mapped_cache_fname ) && mapped_cache.open( dir + "/" + mapped_cache_fname ) ){
+                    std::cout << "mapped hbgeom cache " << mapped_cache.fname_ << " with " << mapped_cache.size() << " hbgeoms" << std::endl;
+                    break;
+                }
+            }
+            for( auto & i : hbond_geoms_cache ){
+                std::string const & key = hbgeom_mapped_keys[ i.first ];
+                if( !mapped_cache.has( key ) ) continue;
+                i.second = new HbondGeoms;
+                i.second->set_view( mapped_cache.get( key ) );
+                ++num_mapped;
+            }
+        }
+        int const num_unmapped = hbond_geoms_cache.size() - num_mapped;
+
         int num_to_cache;
         if ( opts.hbgeom_max_cache < 0 ) {
-            num_to_cache = hbond_geoms_cache.size();
+            num_to_cache = num_unmapped;
         } else if ( opts.hbgeom_max_cache == 0 ) {
             num_to_cache = 1;
-        } else if ( opts.hbgeom_max_cache < hbond_geoms_cache.size() ) {
+        } else if ( opts.hbgeom_max_cache < num_unmapped ) {
             num_to_cache = opts.hbgeom_max_cache;
         } else {
-            num_to_cache = hbond_geoms_cache.size();
+            num_to_cache = num_unmapped;
         }
 
-        bool using_small_cache = num_to_cache != hbond_geoms_cache.size();
+        bool using_small_cache = num_unmapped > 0 && num_to_cache != num_unmapped;
 
         if ( ! using_small_cache ) {
-            prepare_hbgeoms( hb_jobs, 0, hb_jobs.size(), hbond_geoms_cache, hbond_io_locks, cout_lock, io_lock, pose_lock, hacky_rpms_lock, hbond_geoms_cache_lock, params );
+            prepare_hbgeoms( hb_jobs, 0, hb_jobs.size(), hbond_geoms_cache, hbond_io_locks, cout_lock, io_lock, pose_lock, hacky_rpms_lock, hbond_geoms_cache_lock, params, mapped_cache );
         } else {
             std::sort( hb_jobs.begin(), hb_jobs.end(), hbjob_hbgeom_lessthan() );
         }
 
+        // everything is in memory now, so rewrite the mapped cache with the new tags added, then
+        // switch the heap copies over to it. concurrent writers replace the file atomically; the
+        // last one wins and any tags it lacked are just regenerated from the .gz caches next time
+        if( opts.hbgeom_mapped_cache && num_unmapped > 0 && ! using_small_cache ){
+            std::map< std::string, MappedHbondGeomFile::View > entries;
+            for( auto const & key_view : mapped_cache.index_ ) entries.insert( key_view );
+            for( auto const & i : hbond_geoms_cache ) entries[ hbgeom_mapped_keys[ i.first ] ] = i.second->view();
+            std::string written;
+            for( auto const & dir : cache_data_path ){
+                if( !utility::file::file_exists( dir ) ) utility::file::create_directory_recursive( dir );
+                if( MappedHbondGeomFile::write( dir + "/" + mapped_cache_fname, entries ) ){
+                    written = dir + "/" + mapped_cache_fname;
+                    break;
+                }
+            }
+            MappedHbondGeomFile rewritten;
+            if( written.size() && rewritten.open( written ) ){
+                std::cout << "SAVING " << entries.size() << " HBOND GEOMETRY SETS TO MAPPED CACHE " << written << std::endl;
+                for( auto & i : hbond_geoms_cache ){
+                    i.second->set_view( rewritten.get( hbgeom_mapped_keys[ i.first ] ) );
+                }
+                mapped_cache.swap( rewritten );
+            } else {
+                std::cout << "WARNING: can't save mapped hbgeom cache " << mapped_cache_fname << std::endl;
+            }
+        }
+
 		std::cout << endl;
 
 		for( int ihbjob = 0; ihbjob < hb_jobs.size(); ++ihbjob ){
@@ -755,7 +832,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
             if( using_small_cache && ! hbond_geoms_cache[hbgeomtag] ){
                 // it's time to load the next set of geom files!!!
                 for( auto & i : hbond_geoms_cache ) {
-                    if ( i.second ) {
+                    if ( i.second && ! i.second->is_mapped() ) {
                         delete i.second;
                         i.second = nullptr;
                     }
@@ -763,11 +840,12 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
                 std::set<std::string> next_geom_tags;
                 int end_ihbjob = ihbjob;
                 for ( end_ihbjob = ihbjob; end_ihbjob < hb_jobs.size(); end_ihbjob++ ) {
+                    if ( hbond_geoms_cache[ hb_jobs[end_ihbjob].hbgeomtag ] ) continue; // mapped, costs no memory
                     if ( next_geom_tags.size() >= num_to_cache ) break;
                     next_geom_tags.insert( hb_jobs[end_ihbjob].hbgeomtag );
                 }
                 runtime_assert( ihbjob != end_ihbjob );
-                prepare_hbgeoms( hb_jobs, ihbjob, end_ihbjob, hbond_geoms_cache, hbond_io_locks, cout_lock, io_lock, pose_lock, hacky_rpms_lock, hbond_geoms_cache_lock, params );
+                prepare_hbgeoms( hb_jobs, ihbjob, end_ihbjob, hbond_geoms_cache, hbond_io_locks, cout_lock, io_lock, pose_lock, hacky_rpms_lock, hbond_geoms_cache_lock, params, mapped_cache );
                 std::cout << std::endl;
 
             }
@@ -775,7 +853,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
 			if( ! hbond_geoms_cache[hbgeomtag] ){
 				utility_exit_with_message( "hbond_geoms_cache missing for " + hbgeomtag );
 			}
-			utility::vector1< RelRotPos > const & hbond_geoms( *hbond_geoms_cache[hbgeomtag] );
+			HbondGeoms const & hbond_geoms( *hbond_geoms_cache[hbgeomtag] );
 			// omp_unset_lock( &hbond_io_locks[hbgeomtag] );
 
 			// loop over hbond geometries, then loop over residues which might have those geoms
@@ -903,18 +981,47 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
 					}
 
 
+					// every sample of this geometry is the aligned backbone shifted by xalign.R * (dx,dy,dz),
+					// so the frame is built once and the batch differs only by translation
+					Vec const N0  = xalign * Vec(res_atoms[0].position()[0],res_atoms[0].position()[1],res_atoms[0].position()[2]);
+					Vec const CA0 = xalign * Vec(res_atoms[1].position()[0],res_atoms[1].position()[1],res_atoms[1].position()[2]);
+					Vec const C0  = xalign * Vec(res_atoms[2].position()[0],res_atoms[2].position()[1],res_atoms[2].position()[2]);
+					::scheme::actor::BackboneActor<EigenXform> const bbactor0( N0, CA0, C0 );
+					std::vector< Eigen::Vector3f > samp_d;
+					std::vector< EigenXform > samp_pos;
 					for( float dx = -range; dx <= range+0.000001; dx += range/range_nsamp ){
 					for( float dy = -range; dy <= range+0.000001; dy += range/range_nsamp ){
 					for( float dz = -range; dz <= range+0.000001; dz += range/range_nsamp ){
+						Vec const shift = xalign.R * Vec( dx, dy, dz );
+						samp_d.push_back( Eigen::Vector3f( dx, dy, dz ) );
+						samp_pos.push_back( bbactor0.position_ );
+						samp_pos.back().translation() += Eigen::Vector3f( shift[0], shift[1], shift[2] );
+					}}}
+
+					// many samples fall in the same rif bin, where only the best would be kept. with
+					// hbond_dedup_bins, only the one nearest the bin center is scored
+					std::vector< bool > samp_keep( samp_pos.size(), true );
+					if( opts.hbond_dedup_bins && samp_pos.size() > 1 ){
+						std::vector< std::pair< uint64_t, std::pair< float, int > > > samp_bin;
+						for( int isamp = 0; isamp < samp_pos.size(); ++isamp ){
+							uint64_t const key = accumulator->get_key( samp_pos[isamp] );
+							float const dist2 = ( accumulator->get_center( key ).translation() - samp_pos[isamp].translation() ).squaredNorm();
+							samp_bin.push_back( std::make_pair( key, std::make_pair( dist2, isamp ) ) );
+						}
+						std::sort( samp_bin.begin(), samp_bin.end() );
+						for( int ib = 1; ib < samp_bin.size(); ++ib ){
+							if( samp_bin[ib].first == samp_bin[ib-1].first ) samp_keep[ samp_bin[ib].second.second ] = false;
+						}
+					}
+
+					for( int isamp = 0; isamp < samp_pos.size(); ++isamp ){
+						if( !samp_keep[isamp] ) continue;
+						float const dx = samp_d[isamp][0], dy = samp_d[isamp][1], dz = samp_d[isamp][2];
+						EigenXform const & bbpos( samp_pos[isamp] );
 
 						// if( 0.375 < fabs( 2.7 - hbpos2.distance( xalign * ( hbpos1+Vec(dx,dy,dz) ) ) ) ) continue;
 						using devel::scheme::score_hbond_rays;
 
-						Vec const N  = xalign * Vec(res_atoms[0].position()[0]+dx,res_atoms[0].position()[1]+dy,res_atoms[0].position()[2]+dz);
-						Vec const CA = xalign * Vec(res_atoms[1].position()[0]+dx,res_atoms[1].position()[1]+dy,res_atoms[1].position()[2]+dz);
-						Vec const C  = xalign * Vec(res_atoms[2].position()[0]+dx,res_atoms[2].position()[1]+dy,res_atoms[2].position()[2]+dz);
-						::scheme::actor::BackboneActor<EigenXform> bbactor( N, CA, C );
-
 						// float positioned_rotamer_score = dx*dx+dy*dy+dz*dz;
 						// for(int ia = 0; ia < res_atoms.size(); ++ia){
 						// 	int at = res_atoms[ia].type();
@@ -932,7 +1039,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
 						int sat1=-1, sat2=-1;
 						int hbcount=0;
 						bool want_sats = n_sat_groups > 0;
-						float positioned_rotamer_score = params->rot_tgt_scorer->score_rotamer_v_target_sat( irot, bbactor.position_, sat1, sat2, 
+						float positioned_rotamer_score = params->rot_tgt_scorer->score_rotamer_v_target_sat( irot, bbpos, sat1, sat2, 
 																									want_sats, hbcount, 10.0, 0 );
 						if( positioned_rotamer_score > opts.score_threshold ) continue;
                         
@@ -1056,7 +1163,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
                             // }
                         }
 
-						accumulator->insert( bbactor.position_, positioned_rotamer_score, irot, sat1, sat2 );
+						accumulator->insert( bbpos, positioned_rotamer_score, irot, sat1, sat2 );
 
 						if ( opts.dump_bindentate_hbonds && hbcount >= 2 ) {
 							omp_set_lock(&io_lock);
@@ -1174,7 +1281,7 @@ RifGeneratorSimpleHbonds::prepare_hbgeoms(
 						// 	}
 						// }
 
-					}}}
+					}
 
 
 				} catch( ... ) {
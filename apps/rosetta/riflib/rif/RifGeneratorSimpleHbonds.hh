@@ -15,6 +15,7 @@
 
 #include <riflib/rif/RifGenerator.hh>
 #include <riflib/rif/make_hbond_geometries.hh>
+#include <scheme/util/MappedArrayFile.hh>
 
 namespace devel {
 namespace scheme {
@@ -32,6 +33,27 @@ struct RifGeneratorSimpleHbondsOpts {
 	bool dump_bindentate_hbonds = false;
 	bool report_aa_count = false;
 	int hbgeom_max_cache = -1;
+	bool hbgeom_mapped_cache = true;
+	bool hbond_dedup_bins = false;
+};
+
+typedef ::scheme::util::MappedArrayFile< RelRotPos > MappedHbondGeomFile;
+
+///@brief hbond geometries for one hbgeomtag, 1-indexed like utility::vector1. either owns its
+///       geometries or is a view into a MappedHbondGeomFile
+struct HbondGeoms {
+	utility::vector1< RelRotPos > owned;
+	RelRotPos const * data = nullptr;
+	size_t n = 0;
+	bool mapped = false;
+
+	void set_view( MappedHbondGeomFile::View v ){ owned.clear(); data = v.begin(); n = v.size(); mapped = true; }
+	void use_owned(){ data = owned.size() ? &owned[1] : nullptr; n = owned.size(); mapped = false; }
+	bool is_mapped() const { return mapped; }
+	MappedHbondGeomFile::View view() const { MappedHbondGeomFile::View v; v.data_ = data; v.size_ = n; return v; }
+
+	size_t size() const { return n; }
+	RelRotPos const & operator[]( size_t i ) const { return data[i-1]; }
 };
 
 struct HBJob {
@@ -66,16 +88,19 @@ struct RifGeneratorSimpleHbonds : public RifGenerator {
 	    std::vector<HBJob> const & hb_jobs,
 	    int start_job,
 	    int end_job,    // python style numbering. To do all jobs, specify 0, hb_jobs.size()
-	    std::map< std::string, utility::vector1< RelRotPos > * > & hbond_geoms_cache,
+	    std::map< std::string, HbondGeoms * > & hbond_geoms_cache,
 	    std::map< std::string, omp_lock_t > & hbond_io_locks,
 	    omp_lock_t & cout_lock,
 	    omp_lock_t & io_lock,
 	    omp_lock_t & pose_lock,
 	    omp_lock_t & hacky_rpms_lock,
 	    omp_lock_t & hbond_geoms_cache_lock,
-	    RifGenParamsP const & params
+	    RifGenParamsP const & params,
+	    MappedHbondGeomFile const & mapped_cache
 	);
 
+	std::string hbgeom_cache_prefix() const;
+
 	void generate_rif(
 		RifAccumulatorP accumulator,
 		RifGenParamsP params
@@ -96,7 +96,7 @@ awful_compile_output_helper_(
     SearchPointWithRots const & sp = packed_results[isamp];
     // if( sp.score >= 0.0f ) return;   // legacy. There seems to be no reason to do this.
     ScenePtr scene_minimal( scene_pt[omp_get_thread_num()] );
-    director->set_scene( sp.index, director_resl, *scene_minimal );
+    set_scene_for_point( director, sp, director_resl, *scene_minimal );
     std::vector<float> sc = objective->scores(*scene_minimal);
     float _nopackscore = 0;
     for ( float f : sc ) _nopackscore += f;
@@ -315,7 +315,12 @@ CompileAndFilterResultsTask::return_rif_dock_results(
             allresults.push_back( r );
         }
     }
-    __gnu_parallel::sort( allresults.begin(), allresults.end() );
+    sort_by_score_permutation( allresults );
+
+    // the survivors' rotamers are scattered over the blocks of everything that was packed,
+    //  copy them into blocks of their own so the rest can be freed
+    RotamerArena rotamer_arena;
+    ::scheme::util::compact_spans( selected_results, &RifDockResult::rotamers_, rotamer_arena );
 
 
     return selected_results_p;
@@ -0,0 +1,141 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// (c) Copyright Rosetta Commons Member Institutions.
+// (c) This file is part of the Rosetta software suite and is made available under license.
+// (c) The Rosetta software is developed by the contributing members of the Rosetta Commons.
+// (c) For more information, see http://wsic_dockosettacommons.org. Questions about this casic_dock
+// (c) addressed to University of Waprotocolsgton UW TechTransfer, email: license@u.washington.eprotocols
+
+
+
+#include <riflib/rifdock_tasks/GridMinTasks.hh>
+
+#include <riflib/types.hh>
+#include <riflib/util.hh>
+#include <riflib/scaffold/ScaffoldDataCache.hh>
+
+
+#include <string>
+#include <vector>
+
+
+
+namespace devel {
+namespace scheme {
+
+
+shared_ptr<std::vector<SearchPointWithRots>>
+GridMinTask::return_search_point_with_rotss(
+    shared_ptr<std::vector<SearchPointWithRots>> packed_results_p,
+    RifDockData & rdd,
+    ProtocolData & pd ) {
+
+    using std::cout;
+    using std::endl;
+    typedef ::scheme::objective::voxel::GridMinResult<float> MinResult;
+
+    std::vector<SearchPointWithRots> & packed_results = *packed_results_p;
+
+    print_header( "grid minimizing " + KMGT(packed_results.size()) + " packed results" );
+
+    std::chrono::time_point<std::chrono::high_resolution_clock> start = std::chrono::high_resolution_clock::now();
+
+    int64_t const out_interval = std::max<int64_t>(1,packed_results.size()/100);
+    double total_gain = 0;
+    int64_t n_improved = 0;
+    std::vector< RotamerArena > rotamer_arenas( omp_max_threads() );
+    std::vector< std::vector< std::pair<intRot,intRot> > > rotamer_scratch( omp_max_threads() );
+    std::exception_ptr exception = nullptr;
+    #ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,16) reduction(+:total_gain,n_improved)
+    #endif
+    for( int64_t imin = 0; imin < packed_results.size(); ++imin ){
+        if( exception ) continue;
+        try {
+            if( imin%out_interval==0 ){ cout << '*'; cout.flush(); }
+
+            SearchPointWithRots & result = packed_results[imin];
+            if ( result.score >= 0 || ! result.rotamers_ ) continue;
+
+            ScenePtr tscene = rdd.scene_pt[omp_get_thread_num()];
+            if ( ! set_scene_for_point( rdd.director, result, director_resl_, *tscene ) ) continue;
+
+            std::vector< Eigen::Vector3f > positions;
+            std::vector< int > types;
+
+            // the scaffold as the centroid-mode scene sees it, backbone+CB with no native side chains to
+            //  stand in the way of the packed rotamers
+            ScaffoldDataCacheOP sdc = tscene->conformation_ptr(1)->cache_data_;
+            EigenXform const scaffold_position = tscene->position(1);
+            for( SimpleAtom const & a : *sdc->scaffold_simple_atoms_p ){
+                positions.push_back( scaffold_position * a.position() );
+                types.push_back( a.type() );
+            }
+
+            // side chains only, the backbone and CB are already among the scaffold atoms. rotamer atoms
+            //  are N CA C CB (no O) so the side chain starts at 4, as in score_rotamer_v_target
+            for( std::pair<intRot,intRot> const & seqpos_rot : result.rotamers() ){
+                int const irot = seqpos_rot.second;
+                BBActor const & bba = tscene->template get_actor<BBActor>(1,seqpos_rot.first);
+                for( int ia = 4; ia < rdd.rot_index_p->nheavyatoms(irot); ++ia ){
+                    RotamerIndex::Atom const & atom = rdd.rot_index_p->rotamer(irot).atoms_.at(ia);
+                    positions.push_back( bba.position() * atom.position() );
+                    types.push_back( atom.type() );
+                }
+            }
+
+            MinResult min_result = ::scheme::objective::voxel::minimize_rigid_body_on_grids(
+                positions, types, rdd.target_field_by_atype, min_opts_ );
+            if ( min_result.score >= min_result.start_score ) continue;
+
+            // the fields only say where to look; the result is judged like hackpack judged it
+            EigenXform const moved_position = min_result.delta * scaffold_position;
+            tscene->set_position( 1, moved_position );
+            std::vector< std::pair<intRot,intRot> > & rotamers = rotamer_scratch[omp_get_thread_num()];
+            rotamers.clear();
+            std::vector<float> scores;
+            float const moved_score = rdd.packing_objectives[rif_resl_]->score_with_rotamers( *tscene, scores, rotamers );
+
+            float const gain = result.score - moved_score;
+            if ( gain <= 0 ) continue;
+
+            EigenXform delta = min_result.delta;
+            if ( result.position_delta_ ) delta = delta * *result.position_delta_;
+            result.position_delta_ = make_shared<EigenXform>( delta );
+            result.score = moved_score;
+            result.set_rotamers( rotamer_arenas[omp_get_thread_num()], rotamers );
+            result.sasa = (uint16_t) ( scores[3] / SASA_SUBVERT_MULTIPLIER );
+            total_gain += gain;
+            n_improved++;
+
+        } catch( std::exception const & ex ) {
+            #ifdef USE_OPENMP
+            #pragma omp critical
+            #endif
+            exception = std::current_exception();
+        }
+    }
+    if( exception ) std::rethrow_exception(exception);
+    cout << endl;
+
+    std::chrono::duration<double> elapsed_seconds = std::chrono::high_resolution_clock::now()-start;
+    cout << "grid min improved " << n_improved << " of " << packed_results.size() << " results, mean gain "
+         << ( n_improved ? total_gain / n_improved : 0 ) << ", rate: "
+         << (double)packed_results.size()/elapsed_seconds.count() << " per second" << endl;
+
+    sort_by_score_permutation( packed_results );
+
+    if ( keep_ > 0 && packed_results.size() > (size_t)keep_ ) {
+        cout << "grid min keeping the best " << keep_ << " of " << packed_results.size() << " results" << endl;
+        packed_results.resize( keep_ );
+    }
+
+    pd.time_pck += elapsed_seconds.count();
+
+    return packed_results_p;
+}
+
+
+
+}}
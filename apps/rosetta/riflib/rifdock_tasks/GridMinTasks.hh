@@ -0,0 +1,77 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// (c) Copyright Rosetta Commons Member Institutions.
+// (c) This file is part of the Rosetta software suite and is made available under license.
+// (c) The Rosetta software is developed by the contributing members of the Rosetta Commons.
+// (c) For more information, see http://wsic_dockosettacommons.org. Questions about this casic_dock
+// (c) addressed to University of Waprotocolsgton UW TechTransfer, email: license@u.washington.eprotocols
+
+#ifndef INCLUDED_riflib_rifdock_tasks_GridMinTasks_hh
+#define INCLUDED_riflib_rifdock_tasks_GridMinTasks_hh
+
+#include <riflib/types.hh>
+#include <riflib/task/SearchPointWithRotsTask.hh>
+
+#include <scheme/objective/voxel/GridMinimizer.hh>
+
+#include <string>
+#include <vector>
+
+
+
+namespace devel {
+namespace scheme {
+
+// Rigid-body minimize each packed result in the trilinearly interpolated target fields,
+//  then repack and rescore it with the packing objective at the moved position. The move
+//  is kept only when that full score (rif, hbonds, sterics, twobody) improves; the result
+//  then gets the new score and rotamers and carries the move as position_delta_, which
+//  everything after this builds the pose from (see set_scene_for_point).
+//
+// The fields only guide the move, they never set a score. Side chains are rechosen by the
+//  repack rather than chi-minimized. With keep > 0 only the best keep results go on.
+struct GridMinTask : public SearchPointWithRotsTask {
+
+    GridMinTask(
+        int director_resl,
+        int rif_resl,
+        ::scheme::objective::voxel::GridMinOpts const & min_opts,
+        int keep = 0
+    ) :
+        director_resl_( director_resl ),
+        rif_resl_( rif_resl ),
+        min_opts_( min_opts ),
+        keep_( keep )
+    {}
+
+    shared_ptr<std::vector<SearchPointWithRots>>
+    return_search_point_with_rotss(
+        shared_ptr<std::vector<SearchPointWithRots>> search_point_with_rotss,
+        RifDockData & rdd,
+        ProtocolData & pd ) override;
+
+private:
+    int director_resl_;
+    int rif_resl_;
+    ::scheme::objective::voxel::GridMinOpts min_opts_;
+    int keep_;
+
+};
+
+
+inline
+::scheme::objective::voxel::GridMinOpts
+grid_min_opts_from_rifdock_opt( RifDockOpt const & opt ) {
+    ::scheme::objective::voxel::GridMinOpts min_opts;
+    min_opts.max_iterations = opt.grid_min_iterations;
+    min_opts.max_translation = opt.grid_min_max_translation;
+    min_opts.max_rotation_deg = opt.grid_min_max_rotation;
+    return min_opts;
+}
+
+
+
+}}
+
+#endif
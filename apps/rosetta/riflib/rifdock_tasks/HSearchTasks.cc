@@ -14,7 +14,10 @@
 #include <riflib/scaffold/ScaffoldDataCache.hh>
 #include <riflib/rifdock_tasks/OutputResultsTasks.hh>
 
+#include <scheme/search/SpatialBandB.hh>
 
+
+#include <limits>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -150,28 +153,42 @@ HSearchScoreAtReslTask::return_search_points(
 
     bool need_sdc = using_csts || tether_to_input_position_cut_ != 0;
 
+    // bounded scoring: each thread keeps its best `keep` scores so far. Its worst kept score is an upper
+    //  bound on the score needed to make the beam, and the objective stops scoring samples that can't beat it
+    uint64_t const keep = bounded_keep_ * pd.beam_multiplier;
+    shared_ptr<std::vector<float>> score_cut_per_thread = rdd.rso_config.score_cut_per_thread;
+    bool const bounded = keep > 0 && score_cut_per_thread && rif_resl_+1 < rdd.objectives.size();
+    ::scheme::search::ThreadBeamCut<float> beam_cut;
+    beam_cut.reset( omp_max_threads(), bounded ? keep : 0 );
+
 
     cout << "HSearsh stage " << rif_resl_+1 << " resl " << F(5,2,rdd.RESLS[rif_resl_]) << " begin threaded sampling, " << KMGT(search_points.size()) << " samples: ";
-    int64_t const out_interval = std::max<int64_t>(search_points.size()/50, 1);
-    std::exception_ptr exception = nullptr;
     std::chrono::time_point<std::chrono::high_resolution_clock> start, end;
     start = std::chrono::high_resolution_clock::now();
     pd.total_search_effort += search_points.size();
 
-    #ifdef USE_OPENMP
-    #pragma omp parallel for schedule(dynamic,64)
-    #endif
-    for( int64_t i = 0; i < search_points.size(); ++i ){
-        if( exception ) continue;
-        try {
-            if( i%out_interval==0 ){ cout << '*'; cout.flush(); }
-            RifDockIndex const isamp = search_points[i].index;
+    // score in z-order of the scaffold placements so consecutive samples (and each thread's chunks) hit
+    //  neighboring rif buckets and grid bricks. the original order is put back after scoring
+    std::vector<uint64_t> locality;
+    if ( rdd.opt.hsearch_locality_order ) {
+        float const cell_size = rdd.RESLS[rif_resl_];
+        // keyed on the nest placement alone, building the scene here would double the set_scene calls
+        locality = ::scheme::search::locality_order( search_points, [&]( SearchPoint const & search_point, int ithread ) {
+            EigenXform x;
+            if ( ! rdd.nest.get_state( search_point.index.nest_index, director_resl_, x ) ) return std::numeric_limits<uint64_t>::max();
+            return ::scheme::search::zorder_key( x.translation()[0], x.translation()[1], x.translation()[2], cell_size );
+        });
+    }
+
+    try {
+        ::scheme::search::score_samples( search_points, [&]( SearchPoint & search_point, int ithread ) {
+            RifDockIndex const isamp = search_point.index;
 
-            ScenePtr tscene( rdd.scene_pt[omp_get_thread_num()] );
+            ScenePtr tscene( rdd.scene_pt[ithread] );
             bool director_success = rdd.director->set_scene( isamp, director_resl_, *tscene );
             if ( ! director_success ) {
-                search_points[i].score = 9e9;
-                continue;
+                search_point.score = 9e9;
+                return;
             }
 
             if ( need_sdc ) {
@@ -186,8 +203,8 @@ HSearchScoreAtReslTask::return_search_points(
                     x.translation() -= sdc->scaffold_center;
                     float xmag =  xform_magnitude( x, redundancy_filter_rg );
                     if( xmag > tether_to_input_position_cut_ + rdd.RESLS[rif_resl_] ){
-                        search_points[i].score = 9e9;
-                        continue;
+                        search_point.score = 9e9;
+                        return;
                     } 
                 }
 
@@ -195,38 +212,32 @@ HSearchScoreAtReslTask::return_search_points(
                 /////// Longxing' code  ////////////////////////////
                 ////////////////////////////////////////////////////
                 if (using_csts) {
-                    EigenXform x = tscene->position(1);
-                    bool pass_all = true;
-                    for(CstBaseOP p : sdc->csts) {
-                        if (!p->apply( x )) {
-                            pass_all = false;
-                            break;
-                        }
-                    }
-                    if (!pass_all) {
-                        search_points[i].score = 9e9;
-                        continue;
+                    if ( ! sdc->compiled_csts.apply( tscene->position(1) ) ) {
+                        search_point.score = 9e9;
+                        return;
                     }
                 }
             }
 
             // the real rif score!!!!!!
             std::vector<float> scores;
-            search_points[i].score = rdd.objectives[rif_resl_]->score( *tscene, scores );
+            search_point.score = rdd.objectives[rif_resl_]->score( *tscene, scores );
 
-            search_points[i].sasa = (uint16_t) ( scores[3] / SASA_SUBVERT_MULTIPLIER );
+            search_point.sasa = (uint16_t) ( scores[3] / SASA_SUBVERT_MULTIPLIER );
 
-            // search_points[i].score = rdd.objectives[rif_resl_]->score( *tscene );// + tot_sym_score;
+            // search_point.score = rdd.objectives[rif_resl_]->score( *tscene );// + tot_sym_score;
 
+            if ( bounded ) {
+                score_cut_per_thread->at(ithread) = beam_cut.add( ithread, search_point.score );
+            }
 
-        } catch( std::exception const & ex ) {
-            #ifdef USE_OPENMP
-            #pragma omp critical
-            #endif
-            exception = std::current_exception();
-        }
+        }, 64, 50 );
+    } catch( ... ) {
+        if ( score_cut_per_thread ) std::fill( score_cut_per_thread->begin(), score_cut_per_thread->end(), 9e9 );
+        throw;
     }
-    if( exception ) std::rethrow_exception(exception);
+    if ( score_cut_per_thread ) std::fill( score_cut_per_thread->begin(), score_cut_per_thread->end(), 9e9 );
+    if ( ! locality.empty() ) ::scheme::search::restore_order( search_points, locality );
     end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed_seconds_rif = end-start;
     pd.hsearch_rate = (double)search_points.size()/ elapsed_seconds_rif.count()/omp_max_threads();
@@ -248,18 +259,11 @@ HSearchFilterSortTask::return_search_points(
 
     std::vector<SearchPoint> & search_points = *search_points_p;
 
-    SearchPoint max_pt, min_pt;
-    int64_t len = search_points.size();
     uint64_t keeping = num_to_keep_ * pd.beam_multiplier;
-    if( search_points.size() > keeping ){
-        __gnu_parallel::nth_element( search_points.begin(), search_points.begin()+ keeping, search_points.end() );
-        len = keeping;
-        min_pt = *__gnu_parallel::min_element( search_points.begin(), search_points.begin()+len );
-        max_pt = *(search_points.begin()+keeping);
-    } else {
-        min_pt = *__gnu_parallel::min_element( search_points.begin(), search_points.end() );
-        max_pt = *__gnu_parallel::max_element( search_points.begin(), search_points.end() );
-    }
+    ::scheme::search::BeamStats<SearchPoint> beam = ::scheme::search::select_beam( search_points, keeping );
+    int64_t len = beam.nkept;
+    SearchPoint const & min_pt = beam.best;
+    SearchPoint const & max_pt = beam.worst;
 
     std::cout << "HSearsh stage " << resl_+1 << " complete, resl. " << F(7,3,rdd.RESLS[resl_]) << ", "
           << " " << KMGT(search_points.size()) << ", promote: " << F(9,6,min_pt.score) << " to "
@@ -300,22 +304,11 @@ HSearchScaleToReslTask::return_search_points(
 
         if( current_resl_ == 0 ) pd.non0_space_size += good_points;
 
-        out_points.resize( use_pow2 * good_points );
-
-        #ifdef USE_OPENMP
-        #pragma omp parallel for schedule(dynamic,64)
-        #endif
-        for( int64_t i = 0; i < good_points; ++i ){
-            RifDockIndex rdi0 = search_points[i].index;
-            uint64_t isamp0 = use_pow2 * rdi0.nest_index;
-            uint64_t array_offset = i*use_pow2;
-
-            for( uint64_t j = 0; j < use_pow2; ++j ){
-                SearchPoint & rdi = out_points[array_offset+j];
-                rdi = rdi0;
-                rdi.index.nest_index = isamp0 + j;
-            }
-        }
+        ::scheme::search::expand_children( search_points, good_points, []( SearchPoint const & ){ return true; }, use_pow2,
+            [use_pow2]( SearchPoint const & parent, uint64_t j, SearchPoint & child ) {
+                child = parent.index;
+                child.index.nest_index = use_pow2 * parent.index.nest_index + j;
+            }, out_points );
 
     } else {
 
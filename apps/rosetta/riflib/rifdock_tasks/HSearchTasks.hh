@@ -78,10 +78,12 @@ struct HSearchScoreAtReslTask : public SearchPointTask {
     HSearchScoreAtReslTask(
         int director_resl,
         int rif_resl,
-        float tether_to_input_position_cut ) :
+        float tether_to_input_position_cut,
+        uint64_t bounded_keep = 0 ) :
         director_resl_( director_resl ),
         rif_resl_( rif_resl ),
-        tether_to_input_position_cut_( tether_to_input_position_cut )
+        tether_to_input_position_cut_( tether_to_input_position_cut ),
+        bounded_keep_( bounded_keep )
         {}
 
     shared_ptr<std::vector<SearchPoint>> 
@@ -94,6 +96,7 @@ private:
     int director_resl_;
     int rif_resl_;
     float tether_to_input_position_cut_;
+    uint64_t bounded_keep_; // if > 0, the following HSearchFilterSortTask keeps this many; lets samples that can't make it stop early
 
 };
 
@@ -107,6 +107,9 @@ HackPackTask::return_search_point_with_rotss(
     start = std::chrono::high_resolution_clock::now();
 
     int64_t const out_interval = std::max<int64_t>(1,pd.npack/100);
+    // rotamers go into per-thread arenas through a reused scratch vector, no allocations per pack
+    std::vector< RotamerArena > rotamer_arenas( omp_max_threads() );
+    std::vector< std::vector< std::pair<intRot,intRot> > > rotamer_scratch( omp_max_threads() );
     std::exception_ptr exception = nullptr;
     #ifdef USE_OPENMP
     #pragma omp parallel for schedule(dynamic,64)
@@ -114,6 +117,9 @@ HackPackTask::return_search_point_with_rotss(
     for( int ipack = 0; ipack < pd.npack; ++ipack ){
         if( exception ) continue;
         try {
+            RotamerArena & rotamer_arena = rotamer_arenas[omp_get_thread_num()];
+            std::vector< std::pair<intRot,intRot> > & rotamers = rotamer_scratch[omp_get_thread_num()];
+            rotamers.clear();
             if( ipack%out_interval==0 ){ cout << '*'; cout.flush(); }
 
             bool bad_score = packed_results[ipack].score > global_score_cut_;
@@ -130,13 +136,14 @@ HackPackTask::return_search_point_with_rotss(
             }
 
             if ( ! director_success ) {
-                packed_results[ ipack ].rotamers(); // this initializes it to blank
+                packed_results[ ipack ].set_rotamers( rotamer_arena, rotamers ); // blank
                 packed_results[ ipack ].score = 9e9;
                 continue;
             }
 
             std::vector<float> scores;
-            packed_results[ ipack ].score = rdd.packing_objectives[rif_resl_]->score_with_rotamers( *tscene, scores, packed_results[ ipack ].rotamers() );
+            packed_results[ ipack ].score = rdd.packing_objectives[rif_resl_]->score_with_rotamers( *tscene, scores, rotamers );
+            packed_results[ ipack ].set_rotamers( rotamer_arena, rotamers );
             packed_results[ ipack ].sasa = (uint16_t) ( scores[3] / SASA_SUBVERT_MULTIPLIER );
 
 
@@ -158,7 +165,7 @@ HackPackTask::return_search_point_with_rotss(
 
 
     std::cout << "full sort of packed samples" << std::endl;
-    __gnu_parallel::sort( packed_results.begin(), packed_results.end() );
+    sort_by_score_permutation( packed_results );
 
     int to_check = std::min(1000, (int)packed_results.size());
     std::cout << "Check " << to_check << " results after hackpack" << std::endl;
@@ -187,7 +194,7 @@ void
 sanity_check_rots(
     RifDockData & rdd, 
     RifDockIndex i,
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers,
+    std::vector< std::pair<intRot,intRot> > const & rotamers,
     ScenePtr scene,
     bool original,
     int /*director_resl*/,
@@ -200,10 +207,10 @@ sanity_check_rots(
     bool all_missing = true;
     bool all_ala = true;
 
-    for( int ipr = 0; ipr < rotamers->size(); ++ipr ){
-        int irot = rotamers->at(ipr).second;
+    for( int ipr = 0; ipr < rotamers.size(); ++ipr ){
+        int irot = rotamers.at(ipr).second;
 
-        BBActor bba = scene->template get_actor<BBActor>(1,rotamers->at(ipr).first);
+        BBActor bba = scene->template get_actor<BBActor>(1,rotamers.at(ipr).first);
 
         float rescore = rdd.rot_tgt_scorer.score_rotamer_v_target( irot, bba.position(), 10.0, 4 );
         if (rescore >= 0) {
@@ -244,7 +251,7 @@ void
 sanity_check_hackpack(
     RifDockData & rdd, 
     RifDockIndex i,
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers,
+    RotamerAssignment const & rotamers,
     ScenePtr scene,
     int director_resl,
     int rif_resl ) {
@@ -254,14 +261,14 @@ sanity_check_hackpack(
         std::cout << "Bad index" << std::endl;
         return;
     }
-    sanity_check_rots(rdd, i, rotamers, scene, true, director_resl, rif_resl);
+    sanity_check_rots(rdd, i, rotamers.to_vector(), scene, true, director_resl, rif_resl);
 
     rdd.director->set_scene( i, director_resl, *scene );
-    SearchPointWithRots temp;
+    std::vector< std::pair<intRot,intRot> > repacked;
 
-    rdd.packing_objectives[rif_resl]->score_with_rotamers( *scene, temp.rotamers() );
+    rdd.packing_objectives[rif_resl]->score_with_rotamers( *scene, repacked );
 
-    sanity_check_rots(rdd, i, temp.rotamers_, scene, false, director_resl, rif_resl);
+    sanity_check_rots(rdd, i, repacked, scene, false, director_resl, rif_resl);
 
 
 }
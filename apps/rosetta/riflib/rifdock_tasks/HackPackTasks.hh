@@ -105,7 +105,7 @@ void
 sanity_check_rots(
     RifDockData & rdd, 
     RifDockIndex i,
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers,
+    std::vector< std::pair<intRot,intRot> > const & rotamers,
     ScenePtr scene,
     bool original,
     int director_resl,
@@ -117,7 +117,7 @@ void
 sanity_check_hackpack(
     RifDockData & rdd, 
     RifDockIndex i,
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers,
+    RotamerAssignment const & rotamers,
     ScenePtr scene,
     int director_resl,
     int rif_resl
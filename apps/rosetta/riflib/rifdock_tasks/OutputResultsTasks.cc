@@ -94,6 +94,21 @@ OutputResultsTask::return_rif_dock_results(
         out_silent_stream.open_append( rdd.opt.outdir + "/" + example_data_cache->scafftag + ".silent" );
     }
 
+    // pdb/resfile/allrifrots files are handed to these threads so that gzip and the filesystem
+    //  don't hold up the compute threads. the queue bound caps how much finished output can pile up
+    shared_ptr<::scheme::util::AsyncTaskQueue> output_queue;
+    if ( rdd.opt.output_threads > 0 ) {
+        output_queue = make_shared<::scheme::util::AsyncTaskQueue>( rdd.opt.output_threads, 4*rdd.opt.output_threads );
+    }
+
+    shared_ptr<::scheme::io::ResultArchiveWriter> archive;
+    if ( rdd.opt.output_archive.size() ) {
+        archive = make_shared<::scheme::io::ResultArchiveWriter>();
+        if ( ! archive->open( rdd.opt.output_archive ) ) {
+            utility_exit_with_message( "Unable to open output_archive: " + rdd.opt.output_archive );
+        }
+    }
+
     if ( rdd.opt.parallelwrite ) {
         std::vector< std::stringstream > iostreams;
         iostreams.resize( ::devel::scheme::omp_max_threads() );
@@ -110,7 +125,8 @@ OutputResultsTask::return_rif_dock_results(
                 int const ithread = omp_get_thread_num();
                 RifDockResult const & selected_result = selected_results.at( i_selected_result );
 
-                write_selected_result( selected_result, rdd.scene_pt[ ithread ], iostreams[ ithread ], rdd, pd, i_selected_result );
+                write_selected_result( selected_result, rdd.scene_pt[ ithread ], iostreams[ ithread ], rdd, pd, i_selected_result,
+                                   output_queue.get(), archive.get() );
 
             } catch(...) {
                 #pragma omp critical
@@ -127,10 +143,13 @@ OutputResultsTask::return_rif_dock_results(
         // Default behavior
         for( int i_selected_result = 0; i_selected_result < selected_results.size(); ++i_selected_result ){
             RifDockResult const & selected_result = selected_results.at( i_selected_result );
-            write_selected_result( selected_result, rdd.scene_pt.front(), out_silent_stream, rdd, pd, i_selected_result );
+            write_selected_result( selected_result, rdd.scene_pt.front(), out_silent_stream, rdd, pd, i_selected_result,
+                                   output_queue.get(), archive.get() );
         }
     }
 
+    if ( output_queue ) output_queue->finish();
+
     return selected_results_p;
 
 }
@@ -142,7 +161,9 @@ OutputResultsTask::write_selected_result(
     std::ostream & out_silent_stream,
     RifDockData & rdd,
     ProtocolData & pd,
-    int i_selected_result ) {
+    int i_selected_result,
+    ::scheme::util::AsyncTaskQueue * output_queue,
+    ::scheme::io::ResultArchiveWriter * archive ) {
 
     using std::cout;
     using std::endl;
@@ -160,7 +181,7 @@ OutputResultsTask::write_selected_result(
 
 /////
 
-    rdd.director->set_scene( selected_result.index, director_resl_, *s_ptr );
+    set_scene_for_point( rdd.director, selected_result, director_resl_, *s_ptr );
 
     std::vector<float> unsat_scores;
     int unsats = -1;
@@ -171,7 +192,7 @@ OutputResultsTask::write_selected_result(
             bb_positions.push_back( s_ptr->template get_actor<BBActor>(1,i_actor).position() );
         }
         std::vector<float> burial = rdd.burial_manager->get_burial_weights( s_ptr->position(1), sdc->burial_grid );
-        unsat_scores =  rdd.unsat_manager->get_buried_unsats( burial, selected_result.rotamers(), bb_positions, rdd.rot_tgt_scorer );
+        unsat_scores =  rdd.unsat_manager->get_buried_unsats( burial, selected_result.rotamers().to_vector(), bb_positions, rdd.rot_tgt_scorer );
 
         buried = 0;
         for ( float this_burial : burial ) if ( this_burial > 0 ) buried++;
@@ -187,11 +208,10 @@ OutputResultsTask::write_selected_result(
     if ( rdd.hydrophobic_manager ) {
         std::vector<int> hydrophobic_counts, lig_hyd_counts, seqposs, per_irot_counts;
         std::vector<std::pair<intRot, EigenXform>> irot_and_bbpos;
-        selected_result.rotamers();
-        for( int i = 0; i < selected_result.rotamers_->size(); ++i ){
-            BBActor const & bb = s_ptr->template get_actor<BBActor>( 1, selected_result.rotamers_->at(i).first );
+        for( int i = 0; i < selected_result.rotamers().size(); ++i ){
+            BBActor const & bb = s_ptr->template get_actor<BBActor>( 1, selected_result.rotamers().at(i).first );
             int seqpos = sdc->scaffres_l2g_p->at( bb.index_ ) + 1;
-            int irot = selected_result.rotamers_->at(i).second;
+            int irot = selected_result.rotamers().at(i).second;
 
             irot_and_bbpos.emplace_back( irot, bb.position() );
             seqposs.push_back( seqpos );
@@ -248,11 +268,65 @@ OutputResultsTask::write_selected_result(
     std::cout << oss.str();
     rdd.dokout << oss.str(); rdd.dokout.flush();
 
-    dump_rif_result_(rdd, selected_result, pdboutfile, director_resl_, rif_resl_, out_silent_stream, rdd.scene_pt.front(), false, resfileoutfile, allrifrotsoutfile, unsat_scores);
+    if ( archive ) {
+        ::scheme::io::ResultRecord record;
+        record.tag = pdb_name( pdboutfile );
+        record.set_xform( s_ptr->position(1) );
+        for ( int ipr = 0; ipr < selected_result.numrots(); ++ipr ) {
+            std::pair<intRot,intRot> const & rot = selected_result.rotamers().at(ipr);
+            record.rotamers.emplace_back( sdc->scaffres_l2g_p->at( rot.first ) + 1, rot.second );
+        }
+        std::vector<std::pair<std::string,float>> & scores = record.scores;
+        scores.emplace_back( "packscore", selected_result.score );
+        scores.emplace_back( "score", selected_result.nopackscore );
+        scores.emplace_back( "steric", selected_result.stericscore );
+        scores.emplace_back( "dist0", selected_result.dist0 );
+        scores.emplace_back( "cluster", selected_result.cluster_score );
+        scores.emplace_back( "rank", selected_result.isamp );
+        scores.emplace_back( "rifrank", selected_result.prepack_rank );
+        if ( rdd.opt.scaff_bb_hbond_weight > 0 ) scores.emplace_back( "bb-hbond", selected_result.scaff_bb_hbond );
+        if ( rdd.unsat_manager ) {
+            scores.emplace_back( "buried", buried );
+            scores.emplace_back( "unsats", unsats );
+        }
+        if ( rdd.opt.need_to_calculate_sasa ) scores.emplace_back( "sasa", selected_result.sasa );
+        if ( rdd.hydrophobic_manager ) {
+            scores.emplace_back( "hyd-cont", hydrophobic_residue_contacts );
+            scores.emplace_back( "lig-cont", lig_hydrophobic_residue_contacts );
+            scores.emplace_back( "hyd-ddg", hydrophobic_ddg );
+        }
+        if ( ! archive->append( record ) ) {
+            utility_exit_with_message( "Error appending to output_archive: " + rdd.opt.output_archive );
+        }
+    }
+
+    dump_rif_result_(rdd, selected_result, pdboutfile, director_resl_, rif_resl_, out_silent_stream, rdd.scene_pt.front(), false, resfileoutfile, allrifrotsoutfile, unsat_scores, output_queue);
 
     std::cout << extra_output.str() << std::flush;
 }
 
+void
+write_output_file_(
+    std::string const & fname,
+    std::string const & contents,
+    ::scheme::util::AsyncTaskQueue * output_queue
+    ) {
+
+    if ( ! output_queue ) {
+        utility::io::ozstream out( fname );
+        out << contents;
+        out.close();
+        return;
+    }
+    // std::function needs a copyable callable, so the text rides along in a shared_ptr
+    shared_ptr<std::string> text = make_shared<std::string>( contents );
+    output_queue->push( [fname, text]() {
+        utility::io::ozstream out( fname );
+        out << *text;
+        out.close();
+    });
+}
+
 
 void
 dump_rif_result_(
@@ -267,7 +341,8 @@ dump_rif_result_(
     bool quiet /* = true */,
     std::string const & resfileoutfile /* = "" */,
     std::string const & allrifrotsoutfile, /* = "" */
-    std::vector<float> const & unsat_scores /* = std::vector<float>() */
+    std::vector<float> const & unsat_scores, /* = std::vector<float>() */
+    ::scheme::util::AsyncTaskQueue * output_queue /* = nullptr */
     ) {
 
     using ObjexxFCL::format::F;
@@ -286,16 +361,18 @@ dump_rif_result_(
     uint64_t const scaffold_size = scaffres_g2l.size();
 
 
-    core::pose::Pose pose_from_rif;
+    // get_pose() already hands out a private clone, use it directly rather than copying it again
+    core::pose::PoseOP pose_from_rif_p;
 
-    if ( rdd.opt.output_full_scaffold ) {        sdc->setup_both_full_pose( rdd.target ); pose_from_rif = *(sdc->mpc_both_full_pose.get_pose());
-    } else if( rdd.opt.output_scaffold_only ) {           sdc->setup_scaffold_centered(); pose_from_rif = *(sdc->mpc_scaffold_centered.get_pose());
-    } else if( rdd.opt.output_full_scaffold_only ) { sdc->setup_scaffold_full_centered(); pose_from_rif = *(sdc->mpc_scaffold_full_centered.get_pose());
-    } else {                                          sdc->setup_both_pose( rdd.target ); pose_from_rif = *(sdc->mpc_both_pose.get_pose());
+    if ( rdd.opt.output_full_scaffold ) {        sdc->setup_both_full_pose( rdd.target ); pose_from_rif_p = sdc->mpc_both_full_pose.get_pose();
+    } else if( rdd.opt.output_scaffold_only ) {           sdc->setup_scaffold_centered(); pose_from_rif_p = sdc->mpc_scaffold_centered.get_pose();
+    } else if( rdd.opt.output_full_scaffold_only ) { sdc->setup_scaffold_full_centered(); pose_from_rif_p = sdc->mpc_scaffold_full_centered.get_pose();
+    } else {                                          sdc->setup_both_pose( rdd.target ); pose_from_rif_p = sdc->mpc_both_pose.get_pose();
     }
+    core::pose::Pose & pose_from_rif = *pose_from_rif_p;
 
 
-    rdd.director->set_scene( selected_result.index, director_resl, *s_ptr );
+    set_scene_for_point( rdd.director, selected_result, director_resl, *s_ptr );
 
     EigenXform xposition1 = s_ptr->position(1);
     EigenXform xalignout = EigenXform::Identity();
@@ -549,27 +626,23 @@ dump_rif_result_(
 
     // Dump the main output
     if ( !rdd.opt.outputsilent && !rdd.opt.outputlite ) {
-        utility::io::ozstream out1( pdboutfile );
+        std::ostringstream out1;
         out1 << expdb.str() << std::endl;
         pose_to_dump.dump_pdb(out1);
         if ( rdd.opt.dump_all_rif_rots_into_output ) {
             if ( rdd.opt.rif_rots_as_chains ) out1 << "TER" << endl;
             out1 << allout.str();
         }
-        out1.close();
+        write_output_file_( pdboutfile, out1.str(), output_queue );
     }
     // Dump a resfile
     if( rdd.opt.dump_resfile ){
-        utility::io::ozstream out1res( resfileoutfile );
-        out1res << resfile.str();
-        out1res.close();
+        write_output_file_( resfileoutfile, resfile.str(), output_queue );
     }
 
     // Dump the rif rots
     if( rdd.opt.dump_all_rif_rots ){
-        utility::io::ozstream out2( allrifrotsoutfile );
-        out2 << allout.str();
-        out2.close();
+        write_output_file_( allrifrotsoutfile, allout.str(), output_queue );
     }
 
     // Dump silent file
@@ -13,6 +13,9 @@
 #include <riflib/types.hh>
 #include <riflib/task/RifDockResultTask.hh>
 
+#include <scheme/io/ResultArchive.hh>
+#include <scheme/util/AsyncTaskQueue.hh>
+
 #include <string>
 #include <vector>
 
@@ -50,7 +53,9 @@ private:
         std::ostream & out_silent_stream,
         RifDockData & rdd, 
         ProtocolData & pd,
-        int i_selected_result );
+        int i_selected_result,
+        ::scheme::util::AsyncTaskQueue * output_queue,
+        ::scheme::io::ResultArchiveWriter * archive );
 
 };
 
@@ -66,7 +71,17 @@ dump_rif_result_(
     bool quiet = true,
     std::string const & resfileoutfile = "",
     std::string const & allrifrotsoutfile = "",
-    std::vector<float> const & unsat_scores = std::vector<float>()
+    std::vector<float> const & unsat_scores = std::vector<float>(),
+    ::scheme::util::AsyncTaskQueue * output_queue = nullptr
+    );
+
+// Writes contents to fname, gzipped if fname ends in .gz. With an output_queue the
+//  compression and the write happen on its background threads instead
+void
+write_output_file_(
+    std::string const & fname,
+    std::string const & contents,
+    ::scheme::util::AsyncTaskQueue * output_queue
     );
 
 // You would think that it would be easier to get the absolute path but it's not
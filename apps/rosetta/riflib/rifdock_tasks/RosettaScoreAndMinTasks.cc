@@ -195,7 +195,6 @@ rosetta_score_inner(
     std::vector<core::kinematics::MoveMapOP> movemap_pt(omp_max_threads());
     std::vector<protocols::minimization_packing::MinMoverOP> minmover_pt(omp_max_threads());
     std::vector<core::scoring::ScoreFunctionOP> scorefunc_pt(omp_max_threads());
-    std::vector<core::pose::Pose> work_pose_pt        (omp_max_threads());
 
     for( int i = 0; i < omp_max_threads(); ++i){
         scorefunc_pt[i] = core::scoring::ScoreFunctionFactory::create_score_function(rdd.opt.rosetta_soft_score);
@@ -300,7 +299,7 @@ rosetta_score_inner(
 
             int const ithread = omp_get_thread_num();
 
-            rdd.director->set_scene( packed_results[imin].index, director_resl, *rdd.scene_pt[ithread] );
+            set_scene_for_point( rdd.director, packed_results[imin], director_resl, *rdd.scene_pt[ithread] );
             EigenXform xposition1 = rdd.scene_pt[ithread]->position(1);
             EigenXform xalignout = EigenXform::Identity();
             if( rdd.opt.align_to_scaffold ) xalignout = xposition1.inverse();
@@ -310,22 +309,19 @@ rosetta_score_inner(
 
 // Brian Injection
             //~~~~~~~~~~~~~~~~~~~~~~~
-            // Instead of both_per_thread, we clone the correct scaffold-target from the ScaffoldDataCache
+            // Instead of both_per_thread, we lease the correct scaffold-target from the ScaffoldDataCache
             // Get ScaffoldDataCache
-            // clone both_pose or both_full_pose
+            // lease both_pose or both_full_pose, reset in place to the unplaced scaffold+target
             // copy out scaffres_l2g
             // copy out scaffuseres
 
             ScaffoldIndex si = packed_results[imin].index.scaffold_index;
             ScaffoldDataCacheOP sdc = rdd.scaffold_provider->get_data_cache_slow(si);
 
-            core::pose::Pose & pose_to_min( work_pose_pt[ithread] );
-
-            if( rdd.opt.replace_orig_scaffold_res ){
-                pose_to_min = *(sdc->mpc_both_full_pose.get_pose());
-            } else {
-                pose_to_min = *(sdc->mpc_both_pose.get_pose());
-            }
+            MultithreadPoseCloner::PooledPose pooled_pose = rdd.opt.replace_orig_scaffold_res
+                ? sdc->mpc_both_full_pose.lease_pose()
+                : sdc->mpc_both_pose.lease_pose();
+            core::pose::Pose & pose_to_min( pooled_pose.pose() );
 
             // these guys are multi-thread shared. Definitely don't modify them
             shared_ptr<std::vector<int> const> scaffres_l2g_p = sdc->scaffres_l2g_p;
@@ -551,8 +547,14 @@ rosetta_score_inner(
     } // end of OMP loop
     if( exception ) std::rethrow_exception(exception);
 
+    for ( ScaffoldIndex si : uniq_scaffolds ) {
+        ScaffoldDataCacheOP sdc = rdd.scaffold_provider->get_data_cache_slow(si);
+        sdc->mpc_both_pose.clear_pool();
+        sdc->mpc_both_full_pose.clear_pool();
+    }
+
     cout << endl;
-    __gnu_parallel::sort( packed_results.begin(), packed_results.end() );
+    sort_by_score_permutation( packed_results );
     {
         size_t n_scormin = 0;
         for( n_scormin; n_scormin < packed_results.size(); ++n_scormin ){
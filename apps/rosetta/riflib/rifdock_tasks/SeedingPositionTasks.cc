@@ -22,6 +22,7 @@
 #include <riflib/rifdock_tasks/HSearchTasks.hh>
 #include <riflib/rifdock_tasks/SetFaModeTasks.hh>
 #include <riflib/rifdock_tasks/HackPackTasks.hh>
+#include <riflib/rifdock_tasks/GridMinTasks.hh>
 #include <riflib/rifdock_tasks/RosettaScoreAndMinTasks.hh>
 #include <riflib/rifdock_tasks/CompileAndFilterResultsTasks.hh>
 #include <riflib/rifdock_tasks/OutputResultsTasks.hh>
@@ -135,6 +136,9 @@ create_rifine_task(
     task_list.push_back(make_shared<SetFaModeTask>( true ));
     task_list.push_back(make_shared<FilterForHackPackTask>( 1, 0, 0, opt.hackpack_score_cut ));
     task_list.push_back(make_shared<HackPackTask>(  0, final_resl, 9e9 )); // hackpack sorts the results
+    if ( opt.grid_min ) {
+        task_list.push_back(make_shared<GridMinTask>( 0, final_resl, grid_min_opts_from_rifdock_opt( opt ), opt.grid_min_keep ));
+    }
 
 
     if ( opt.score_per_1000_sasa_cut < 0 ) {
@@ -391,7 +391,7 @@ RemoveRedundantPointsTask::return_any_points(
         std::vector<EigenXform> xforms(vec.size());
         std::vector<EigenXform> out_xforms;
         for ( int i = 0; i < vec.size(); i++ ) {
-            rdd.director->set_scene( vec[i].index, director_resl_, *scene_minimal );
+            set_scene_for_point( rdd.director, vec[i], director_resl_, *scene_minimal );
             xforms[i] = scene_minimal->position(1);
         }
 
@@ -619,7 +619,7 @@ DumpRotScoresTask::return_search_point_with_rotss(
 
         bool first_line = true;
         for ( SearchPointWithRots const & sp : *search_point_with_rotss ) {
-            rdd.director->set_scene( sp.index, resl_, *rdd.scene_minimal );
+            set_scene_for_point( rdd.director, sp, resl_, *rdd.scene_minimal );
 
             int num_actors = rdd.scene_minimal->template num_actors<BBActor>(1);
 
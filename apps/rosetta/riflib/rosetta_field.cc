@@ -317,6 +317,8 @@ get_rosetta_fields_specified_cache_prefix(
 		}
 		std::cout << "rosetta_field lb: " << lb << " ub: " << ub << " size(A): " << ub-lb << std::endl;
 
+		// atypes without a cache file are computed together afterwards, in one pass over the grid
+		std::vector<int> compute_atypes;
 		std::exception_ptr exception = nullptr;
 		#ifdef USE_OPENMP
 		#pragma omp parallel for schedule(dynamic,1)
@@ -353,15 +355,12 @@ get_rosetta_fields_specified_cache_prefix(
 							utility_exit_with_message("required data not available");
 						}
 					}
+					// field_by_atype[itype] = boost::make_shared<FieldCache >( rfa, lb-6.0f, ub+6.0f, field_resl, "", false, oversample );
+					field_by_atype[itype] = new FieldCache( rfa, lb-6.0f, ub+6.0f, field_resl, "", true, oversample ); // filled below
 					#ifdef USE_OPENMP
 					#pragma omp critical
 					#endif
-					std::cout << "thread " << I(3,omp_thread_num_1()) << " init  rosetta_field " << I(2,itype) << " CACHE TO " << cachefile << std::endl;
-					// field_by_atype[itype] = boost::make_shared<FieldCache >( rfa, lb-6.0f, ub+6.0f, field_resl, "", false, oversample );
-					field_by_atype[itype] = new FieldCache( rfa, lb-6.0f, ub+6.0f, field_resl, "", false, oversample );
-					utility::io::ozstream out( cachefile , std::ios::binary );
-					field_by_atype[itype]->save( out );
-					out.close();
+					compute_atypes.push_back( itype );
 				}
 				// if( opts.cache_mismatch_tolerance < 9e8 ){
 				// 	double erf = static_cast<FieldCache&>(*field_by_atype[itype]).check_against_field( rfa, oversample, opts.cache_mismatch_tolerance );
@@ -385,6 +384,39 @@ get_rosetta_fields_specified_cache_prefix(
 		}
 		if( exception ) std::rethrow_exception(exception);
 
+		if( compute_atypes.size() ){
+			std::sort( compute_atypes.begin(), compute_atypes.end() );
+			std::vector<VoxelArray*> compute_fields;
+			for( int itype : compute_atypes ) compute_fields.push_back( field_by_atype[itype] );
+			std::cout << "computing " << compute_atypes.size() << " rosetta_fields, " << target_atoms.size()
+			          << " target atoms, grid " << compute_fields.front()->shape()[0] << "x"
+			          << compute_fields.front()->shape()[1] << "x" << compute_fields.front()->shape()[2] << std::endl;
+			rosetta_field.compute_rosetta_fields( compute_atypes, compute_fields, oversample );
+
+			#ifdef USE_OPENMP
+			#pragma omp parallel for schedule(dynamic,1)
+			#endif
+			for( int i = 0; i < compute_atypes.size(); ++i ){
+				if( exception ) continue;
+				try {
+					std::string cachefile = cache_prefix +"__atype"+boost::lexical_cast<std::string>(compute_atypes[i])+".rosetta_field.gz";
+					#ifdef USE_OPENMP
+					#pragma omp critical
+					#endif
+					std::cout << "thread " << I(3,omp_thread_num_1()) << " init  rosetta_field " << I(2,compute_atypes[i]) << " CACHE TO " << cachefile << std::endl;
+					utility::io::ozstream out( cachefile , std::ios::binary );
+					compute_fields[i]->save( out );
+					out.close();
+				} catch( ... ) {
+					#ifdef USE_OPENMP
+					#pragma omp critical
+					#endif
+					exception = std::current_exception();
+				}
+			}
+			if( exception ) std::rethrow_exception(exception);
+		}
+
 
 		return cache_prefix;
 
@@ -61,6 +61,53 @@ namespace scheme {
 using ObjexxFCL::format::I;
 using ObjexxFCL::format::F;
 
+// applies the per rotamer custom energies and the favorable multiplier to freshly computed onebody
+// energies. only the rows marked in only_res (0-based) are touched if it is given
+static void
+adjust_onebody_rotamer_energies(
+	utility::vector1<core::Size> const & scaffold_res,
+	std::vector<std::vector<float> > & scaffold_onebody_rotamer_energies,
+	float favorable_1be_multiplier,
+	float favorable_1be_cutoff,
+	std::shared_ptr< std::vector< std::vector<float> > > extra_scores_p,
+	std::vector<bool> const * only_res = nullptr
+){
+	utility::vector1<int> g2l( scaffold_onebody_rotamer_energies.size(), -1 );
+	if ( extra_scores_p ) {
+		runtime_assert( extra_scores_p->size() == scaffold_res.size() );
+		for ( int i = 0; i < scaffold_res.size(); i++ ) {
+			g2l[ scaffold_res[i+1] ] = i;
+		}
+	}
+
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(dynamic,1)
+	#endif
+	for( int ir = 1; ir <= scaffold_onebody_rotamer_energies.size(); ++ir ){
+		if( only_res && !only_res->at(ir-1) ) continue;
+
+		std::vector<float> const & extra = ( g2l[ir] > -1 ? extra_scores_p->at( g2l[ir] ) : std::vector<float>() );
+		if ( extra.size() > 0 ) {
+			runtime_assert_msg( extra.size() == scaffold_onebody_rotamer_energies[ir-1].size(), 
+				"get_onebody_rotamer_energies has wrong number of rotamers for this rifdock!! " +
+				boost::str(boost::format(" saw %i expected %i")%extra.size()%
+					scaffold_onebody_rotamer_energies[ir-1].size()) );
+		}
+
+		for( int jr = 0; jr < scaffold_onebody_rotamer_energies[ir-1].size(); ++jr ){
+
+			if ( extra.size() > 0 ) {
+				scaffold_onebody_rotamer_energies[ir-1][jr] += extra[jr];
+			}
+
+			float _1be = scaffold_onebody_rotamer_energies[ir-1][jr];
+			if (_1be < favorable_1be_cutoff) {
+				scaffold_onebody_rotamer_energies[ir-1][jr] = favorable_1be_multiplier * _1be;
+			}
+		}
+	}
+}
+
 void get_onebody_rotamer_energies(
 	core::pose::Pose const & scaffold,
 	utility::vector1<core::Size> const & scaffold_res,
@@ -124,41 +171,29 @@ void get_onebody_rotamer_energies(
 		}
 	}
 
-	utility::vector1<int> g2l( scaffold_onebody_rotamer_energies.size(), -1 );
-	if ( extra_scores_p ) {
-		runtime_assert( extra_scores_p->size() == scaffold_res.size() );
-		for ( int i = 0; i < scaffold_res.size(); i++ ) {
-			g2l[ scaffold_res[i+1] ] = i;
-		}
-	}
-
-	#ifdef USE_OPENMP
-	#pragma omp parallel for schedule(dynamic,1)
-	#endif
-	for( int ir = 1; ir <= scaffold_onebody_rotamer_energies.size(); ++ir ){
-
-		std::vector<float> const & extra = ( g2l[ir] > -1 ? extra_scores_p->at( g2l[ir] ) : std::vector<float>() );
-		if ( extra.size() > 0 ) {
-			runtime_assert_msg( extra.size() == scaffold_onebody_rotamer_energies[ir-1].size(), 
-				"get_onebody_rotamer_energies has wrong number of rotamers for this rifdock!! " +
-				boost::str(boost::format(" saw %i expected %i")%extra.size()%
-					scaffold_onebody_rotamer_energies[ir-1].size()) );
-		}
-
-		for( int jr = 0; jr < scaffold_onebody_rotamer_energies[ir-1].size(); ++jr ){
-
-			if ( extra.size() > 0 ) {
-				scaffold_onebody_rotamer_energies[ir-1][jr] += extra[jr];
-			}
+	adjust_onebody_rotamer_energies( scaffold_res, scaffold_onebody_rotamer_energies,
+		favorable_1be_multiplier, favorable_1be_cutoff, extra_scores_p );
+}
 
-			float _1be = scaffold_onebody_rotamer_energies[ir-1][jr];
-			if (_1be < favorable_1be_cutoff) {
-				scaffold_onebody_rotamer_energies[ir-1][jr] = favorable_1be_multiplier * _1be;
-			}
-		}
-	}
+static core::scoring::ScoreFunctionOP
+onebody_rotamer_energy_score_function(){
+	core::scoring::ScoreFunctionOP score_func = core::scoring::get_score_function();
+	score_func->set_weight( core::scoring::fa_dun, score_func->get_weight(core::scoring::fa_dun)*0.67 );
+
+	core::scoring::methods::EnergyMethodOptions opts = score_func->energy_method_options();
+	core::scoring::hbonds::HBondOptions hopts = opts.hbond_options();
+	hopts.use_hb_env_dep( false );
+	hopts.decompose_bb_hb_into_pair_energies(true);
+	opts.hbond_options( hopts );
+	score_func->set_energy_method_options( opts );
+	return score_func;
 }
 
+float
+onebody_rotamer_energy_interaction_distance(){
+	static float const distance = onebody_rotamer_energy_score_function()->info()->max_atomic_interaction_distance();
+	return distance;
+}
 
 void
 compute_onebody_rotamer_energies(
@@ -193,15 +228,7 @@ compute_onebody_rotamer_energies(
 		core::scoring::ScoreFunctionOP & score_func = score_func_per_thread[i];
 		core::pose::Pose & work_pose = pose_per_thread[i];
 
-		score_func = core::scoring::get_score_function();
-		score_func->set_weight( core::scoring::fa_dun, score_func->get_weight(core::scoring::fa_dun)*0.67 );
-
-		core::scoring::methods::EnergyMethodOptions opts = score_func->energy_method_options();
-		core::scoring::hbonds::HBondOptions hopts = opts.hbond_options();
-		hopts.use_hb_env_dep( false );
-		hopts.decompose_bb_hb_into_pair_energies(true);
-		opts.hbond_options( hopts );
-		score_func->set_energy_method_options( opts );
+		score_func = onebody_rotamer_energy_score_function();
 
 		// all work poses are scored here
 		score_func->score( work_pose );
@@ -387,6 +414,45 @@ compute_onebody_rotamer_energies(
 
 }
 
+void
+update_onebody_rotamer_energies(
+	core::pose::Pose const & scaffold,
+	utility::vector1<core::Size> const & scaffold_res,
+	devel::scheme::RotamerIndex const & rot_index,
+	std::vector<std::vector<float> > & scaffold_onebody_rotamer_energies,
+	std::vector<bool> const & recompute,
+	bool replace_with_ala,
+	float favorable_1be_multiplier,
+	float favorable_1be_cutoff,
+	std::shared_ptr< std::vector< std::vector<float> > > extra_scores_p
+){
+	runtime_assert( scaffold_onebody_rotamer_energies.size() == scaffold.size() );
+	runtime_assert( recompute.size() == scaffold.size() );
+
+	utility::vector1<core::Size> recompute_res;
+	for( core::Size ir : scaffold_res ){
+		if( recompute[ir-1] ) recompute_res.push_back( ir );
+	}
+
+	std::vector<std::vector<float> > fresh;
+	if( recompute_res.size() ){
+		compute_onebody_rotamer_energies( scaffold, recompute_res, rot_index, fresh, replace_with_ala );
+	} else {
+		fresh.resize( scaffold.size() );
+	}
+	for( int ir = 0; ir < scaffold.size(); ++ir ){
+		if( !recompute[ir] ) continue;
+		if( fresh[ir].size() ){
+			scaffold_onebody_rotamer_energies[ir] = fresh[ir];
+		} else {
+			scaffold_onebody_rotamer_energies[ir].assign( rot_index.size(), 12345.0 );
+		}
+	}
+
+	adjust_onebody_rotamer_energies( scaffold_res, scaffold_onebody_rotamer_energies,
+		favorable_1be_multiplier, favorable_1be_cutoff, extra_scores_p, &recompute );
+}
+
 void get_per_rotamer_rf_tables_one(
 	devel::scheme::RotamerIndex const & rot_index,
 	int irot,
@@ -593,7 +659,8 @@ make_twobody_tables(
 	std::vector<std::vector<float> > const & onebody_energies,
 	RotamerRFTablesManager & rotrfmanager,
 	MakeTwobodyOpts opts,
-	::scheme::objective::storage::TwoBodyTable<float> & twob
+	::scheme::objective::storage::TwoBodyTable<float> & twob,
+	std::vector<bool> const * recompute_res
 ){
 	// typedef ::scheme::objective::voxel::VoxelArray< 3, float, float > VoxelArray;
 	// typedef Eigen::Transform<float,3,Eigen::AffineCompact> EigenXform;
@@ -604,6 +671,7 @@ make_twobody_tables(
  	// boost::multi_array<float,2> obe( boost::extents[scaffold.size()][rot_index.size()] );
 	runtime_assert( twob.onebody_.shape()[0] == scaffold.size() );
 	runtime_assert( twob.onebody_.shape()[1] == rot_index.size() );
+	runtime_assert( !recompute_res || recompute_res->size() == scaffold.size() );
 	{
 		runtime_assert( onebody_energies.size() == scaffold.size() );
 		for( int i = 0; i < scaffold.size(); ++i ){
@@ -645,6 +713,7 @@ make_twobody_tables(
 
 			for( int jr = 0; jr < ir; ++jr ){
 				if( !scaffold.residue(jr+1).is_protein() ) continue;
+				if( recompute_res && !(*recompute_res)[ir] && !(*recompute_res)[jr] ) continue; // caller keeps this block
 
 				double dis2 = scaffold.residue(ir+1).xyz("CA").distance_squared( scaffold.residue(jr+1).xyz("CA") );
 				// double dthr = scaffold.residue(ir).nbr_radius() +                   scaffold.residue(jr+1).nbr_radius();
@@ -783,6 +852,30 @@ make_twobody_tables(
 
 }
 
+// only the blocks touching a residue marked in recompute_res are scaled if it is given
+static void
+apply_favorable_2body_multiplier(
+	MakeTwobodyOpts const & opts,
+	::scheme::objective::storage::TwoBodyTable<float> & twob,
+	std::vector<bool> const * recompute_res = nullptr
+){
+	if ( opts.favorable_2body_multiplier != 1 ) {
+		for ( uint64_t i = 0; i < twob.twobody_.size(); i++ ) {
+			for ( uint64_t j = 0; j < twob.twobody_[i].size(); j++ ) {
+				if ( recompute_res && !(*recompute_res)[i] && !(*recompute_res)[j] ) continue;
+				for ( uint64_t k = 0; k < twob.twobody_[i][j].size(); k++ ) {
+					for ( uint64_t l = 0; l < twob.twobody_[i][j][k].size(); l++ ) {
+						float val = twob.twobody_[i][j][k][l];
+						if ( val < 0 ) {
+							twob.twobody_[i][j][k][l] = val * opts.favorable_2body_multiplier;
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
 void
 get_twobody_tables(
 	std::vector<std::string> const & cachepath,
@@ -814,22 +907,63 @@ get_twobody_tables(
 	}
 
 
-	if ( opts.favorable_2body_multiplier != 1 ) {
-		for ( uint64_t i = 0; i < twob.twobody_.size(); i++ ) {
-			for ( uint64_t j = 0; j < twob.twobody_[i].size(); j++ ) {
-				for ( uint64_t k = 0; k < twob.twobody_[i][j].size(); k++ ) {
-					for ( uint64_t l = 0; l < twob.twobody_[i][j][k].size(); l++ ) {
-						float val = twob.twobody_[i][j][k][l];
-						if ( val < 0 ) {
-							twob.twobody_[i][j][k][l] = val * opts.favorable_2body_multiplier;
-						}
-					}
-				}
-			}
+	apply_favorable_2body_multiplier( opts, twob );
+
+
+}
+
+void
+update_twobody_tables(
+	core::pose::Pose const & scaffold,
+	devel::scheme::RotamerIndex const & rot_index,
+	std::vector<std::vector<float> > const & onebody_energies,
+	RotamerRFTablesManager & rotrfmanager,
+	MakeTwobodyOpts opts,
+	::scheme::objective::storage::TwoBodyTable<float> const & parent,
+	std::vector<int> const & res_to_parent,
+	::scheme::objective::storage::TwoBodyTable<float> & twob
+){
+	runtime_assert( res_to_parent.size() == scaffold.size() );
+	runtime_assert( parent.nrot_ == rot_index.size() );
+
+	twob.init( scaffold.size(), rot_index.size() );
+	for( int i = 0; i < scaffold.size(); ++i ){
+		runtime_assert( onebody_energies[i].size() == rot_index.size() );
+		for( int j = 0; j < rot_index.size(); ++j ){
+			twob.onebody_[i][j] = onebody_energies[i][j];
+		}
+	}
+	twob.init_onebody_filter( opts.onebody_threshold );
+
+	// a parent block is only valid if neither residue moved and both kept the same rotamer selection
+	std::vector<bool> recompute( scaffold.size(), false );
+	int nrecompute = 0;
+	for( int ir = 0; ir < scaffold.size(); ++ir ){
+		int const pr = res_to_parent[ir];
+		bool same = pr >= 0 && twob.nsel_[ir] == parent.nsel_[pr];
+		for( int isel = 0; same && isel < twob.nsel_[ir]; ++isel ){
+			same = twob.sel2all_[ir][isel] == parent.sel2all_[pr][isel];
+		}
+		recompute[ir] = !same;
+		nrecompute += recompute[ir];
+	}
+
+	for( int ir = 0; ir < scaffold.size(); ++ir ){
+		if( recompute[ir] ) continue;
+		for( int jr = 0; jr < ir; ++jr ){
+			if( recompute[jr] ) continue;
+			int const pr = res_to_parent[ir], pj = res_to_parent[jr];
+			runtime_assert( pr > pj );
+			if( parent.twobody_[pr][pj].num_elements() == 0 ) continue;
+			twob.init_twobody( ir, jr );
+			twob.twobody_[ir][jr] = parent.twobody_[pr][pj];
 		}
 	}
 
+	std::cout << "update_twobody_tables: recomputing " << nrecompute << " of " << scaffold.size() << " residues" << std::endl;
+	make_twobody_tables( scaffold, rot_index, onebody_energies, rotrfmanager, opts, twob, &recompute );
 
+	apply_favorable_2body_multiplier( opts, twob, &recompute );
 }
 
 
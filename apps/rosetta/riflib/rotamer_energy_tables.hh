@@ -41,6 +41,25 @@ compute_onebody_rotamer_energies(
 	bool replace_with_ala = true
 );
 
+// the longest atom-atom interaction of the score function compute_onebody_rotamer_energies uses
+float
+onebody_rotamer_energy_interaction_distance();
+
+// recomputes only the rows marked in recompute (0-based), the others are kept as they are.
+// used to derive the energies of a morphed scaffold from those of its parent
+void
+update_onebody_rotamer_energies(
+	core::pose::Pose const & scaffold,
+	utility::vector1<core::Size> const & scaffold_res,
+	RotamerIndex const & rot_index,
+	std::vector<std::vector<float> > & scaffold_onebody_rotamer_energies,
+	std::vector<bool> const & recompute,
+	bool replace_with_ala = true,
+	float favorable_1be_multiplier = 1,
+	float favorable_1be_cutoff = 0,
+	std::shared_ptr< std::vector< std::vector<float> > > extra_scores_p = nullptr
+);
+
 
 struct RotamerRFOpts {
 	int oversample;
@@ -178,7 +197,8 @@ make_twobody_tables(
 	std::vector<std::vector<float> > const & onebody_energies,
 	RotamerRFTablesManager & rotrfmanager,
 	MakeTwobodyOpts opts,
-	::scheme::objective::storage::TwoBodyTable<float> & twob
+	::scheme::objective::storage::TwoBodyTable<float> & twob,
+	std::vector<bool> const * recompute_res = nullptr // only pairs touching these, the rest of twob is left alone
 );
 
 void
@@ -194,6 +214,21 @@ get_twobody_tables(
 	::scheme::objective::storage::TwoBodyTable<float> & twob
 );
 
+// builds twob from the table of a parent scaffold. res_to_parent maps each residue to its parent
+// residue, -1 if its backbone moved. blocks between unmoved residues whose rotamer selection didn't
+// change are copied from parent, the rest are computed as in make_twobody_tables
+void
+update_twobody_tables(
+	core::pose::Pose const & scaffold,
+	devel::scheme::RotamerIndex const & rot_index,
+	std::vector<std::vector<float> > const & onebody_energies,
+	RotamerRFTablesManager & rotrfmanager,
+	MakeTwobodyOpts opts,
+	::scheme::objective::storage::TwoBodyTable<float> const & parent,
+	std::vector<int> const & res_to_parent,
+	::scheme::objective::storage::TwoBodyTable<float> & twob
+);
+
 
 }}
 
@@ -0,0 +1,108 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// (c) Copyright Rosetta Commons Member Institutions.
+// (c) This file is part of the Rosetta software suite and is made available under license.
+// (c) The Rosetta software is developed by the contributing members of the Rosetta Commons.
+// (c) For more information, see http://wsic_dockosettacommons.org. Questions about this casic_dock
+// (c) addressed to University of Waprotocolsgton UW TechTransfer, email: license@u.washington.eprotocols
+
+
+
+#include <riflib/scaffold/IndexedSilentFile.hh>
+#include <riflib/scaffold/util.hh>
+#include <riflib/util.hh>
+
+#include <core/io/silent/SilentFileData.hh>
+#include <core/io/silent/SilentFileOptions.hh>
+#include <core/io/silent/SilentStruct.hh>
+#include <core/pose/PDBInfo.hh>
+
+#include <utility/string_util.hh>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+
+namespace devel {
+namespace scheme {
+
+
+IndexedSilentFile::IndexedSilentFile( std::string const & fname ) :
+    fname_( fname )
+{
+    if ( utility::endswith( fname, ".gz" ) || utility::endswith( fname, ".bz2" ) ) return;
+
+    bool from_cache = false;
+    if ( ! index_.load_or_build( fname, fname + ".idx", &from_cache ) ) return;
+    std::cout << ( from_cache ? "Loaded silent file index: " : "Indexed silent file: " ) << fname
+              << " " << index_.size() << " structures" << std::endl;
+
+    tag_to_index_.reserve( index_.size() );
+    for ( size_t i = 0; i < index_.size(); i++ ) tag_to_index_[ index_.entries[i].tag ] = i;
+}
+
+int64_t
+IndexedSilentFile::index_of( std::string const & tag ) const {
+    auto it = tag_to_index_.find( tag );
+    if ( it == tag_to_index_.end() ) return -1;
+    return it->second;
+}
+
+core::pose::PoseOP
+IndexedSilentFile::pose( size_t i ) const {
+    std::ifstream in( fname_, std::ios::binary );
+    runtime_assert_msg( in.good(), "Can't open silent file: " + fname_ );
+    std::istringstream structure( index_.read_structure( in, i ) );
+
+    core::io::silent::SilentFileOptions options;
+    core::io::silent::SilentFileData sfd( options );
+    utility::vector1< std::string > all_tags;
+    sfd.read_stream( structure, all_tags, true, fname_ );
+    runtime_assert_msg( sfd.has_tag( tag(i) ), "Failed to read " + tag(i) + " from silent file: " + fname_ );
+
+    core::pose::PoseOP pose( new core::pose::Pose() );
+    sfd.get_structure( tag(i) ).fill_pose( *pose );
+    add_pdbinfo_if_missing( *pose );
+    pose->pdb_info()->name( tag(i) );
+    return pose;
+}
+
+std::vector<core::pose::PoseOP>
+IndexedSilentFile::poses( std::vector<size_t> const & which ) const {
+    std::vector<core::pose::PoseOP> poses( which.size() );
+
+    std::exception_ptr exception = nullptr;
+    #ifdef USE_OPENMP
+    #pragma omp parallel for schedule(dynamic,1)
+    #endif
+    for ( uint64_t i = 0; i < which.size(); i++ ) {
+        if (exception) continue;
+        try {
+            poses[i] = pose( which[i] );
+        } catch(...) {
+            #pragma omp critical
+            exception = std::current_exception();
+        }
+    } // end of OMP loop
+    if( exception ) std::rethrow_exception(exception);
+
+    return poses;
+}
+
+
+IndexedSilentFileOP
+get_indexed_silent_file( std::string const & fname ) {
+    static std::mutex mutex;
+    static std::map<std::string,IndexedSilentFileOP> files;
+
+    std::lock_guard<std::mutex> lock( mutex );
+    IndexedSilentFileOP & file = files[ fname ];
+    if ( ! file ) file = make_shared<IndexedSilentFile>( fname );
+    return file;
+}
+
+
+}}
@@ -0,0 +1,62 @@
+// -*- mode:c++;tab-width:2;indent-tabs-mode:t;show-trailing-whitespace:t;rm-trailing-spaces:t -*-
+// vi: set ts=2 noet:
+//
+// (c) Copyright Rosetta Commons Member Institutions.
+// (c) This file is part of the Rosetta software suite and is made available under license.
+// (c) The Rosetta software is developed by the contributing members of the Rosetta Commons.
+// (c) For more information, see http://wsic_dockosettacommons.org. Questions about this casic_dock
+// (c) addressed to University of Waprotocolsgton UW TechTransfer, email: license@u.washington.eprotocols
+
+#ifndef INCLUDED_riflib_scaffold_IndexedSilentFile_hh
+#define INCLUDED_riflib_scaffold_IndexedSilentFile_hh
+
+#include <riflib/types.hh>
+
+#include <scheme/io/SilentFileIndex.hh>
+
+#include <core/pose/Pose.hh>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace devel {
+namespace scheme {
+
+// The structures of a silent file, decoded one at a time when asked for. The
+//  byte offsets of the structures are cached next to the file as <file>.idx, so
+//  a big scaffold library is only scanned once. Only uncompressed files can be
+//  indexed; good() is false for anything else.
+struct IndexedSilentFile {
+
+    IndexedSilentFile( std::string const & fname );
+
+    bool good() const { return index_.size() > 0; }
+    size_t size() const { return index_.size(); }
+    std::string const & fname() const { return fname_; }
+    std::string const & tag( size_t i ) const { return index_.entries.at(i).tag; }
+    int64_t index_of( std::string const & tag ) const;
+
+    // thread safe
+    core::pose::PoseOP pose( size_t i ) const;
+
+    // decoded in parallel
+    std::vector<core::pose::PoseOP> poses( std::vector<size_t> const & which ) const;
+
+private:
+    std::string fname_;
+    ::scheme::io::SilentFileIndex index_;
+    std::unordered_map<std::string,size_t> tag_to_index_;
+};
+
+typedef shared_ptr<IndexedSilentFile> IndexedSilentFileOP;
+
+// one shared IndexedSilentFile per file name
+IndexedSilentFileOP
+get_indexed_silent_file( std::string const & fname );
+
+
+}}
+
+#endif
@@ -178,7 +178,10 @@ MorphingScaffoldProvider::test_make_children(TreeIndex ti) {
                     );
 
 
-                if ( opt.use_parent_body_energies ) {
+                if ( opt.incremental_body_energies_tolerance >= 0 ) {
+                    // computed lazily, only the residues that moved get new energies
+                    temp_data_cache_->set_body_energy_parent( data_cache, opt.incremental_body_energies_tolerance );
+                } else if ( opt.use_parent_body_energies ) {
                     std::cout << "use_parent_body_energies: Preparing parent body energies" << std::endl;
                     if ( ! data_cache->local_onebody_p ) {
                         data_cache->setup_onebody_tables( rot_index_p, opt );
@@ -221,7 +224,9 @@ MorphingScaffoldProvider::test_make_children(TreeIndex ti) {
 // fix this eventually
 
     if ( opt.morph_silent_file != "" ) {
-        std::vector<core::pose::PoseOP> poses = extract_poses_from_silent_file( opt.morph_silent_file );
+        // a random selection is made before decoding, so only the kept structures become poses
+        uint64_t const random_subset = opt.morph_silent_random_selection ? (uint64_t)opt.morph_silent_max_structures : 0;
+        std::vector<core::pose::PoseOP> poses = extract_poses_from_silent_file( opt.morph_silent_file, random_subset );
 
         if ( poses.size() > opt.morph_silent_max_structures ) {
             // std::cout << "Clustering silent file into " << opt.morph_silent_max_structures << " cluster centers" << std::endl;
@@ -266,7 +271,10 @@ MorphingScaffoldProvider::test_make_children(TreeIndex ti) {
                 );
 
 
-            if ( opt.use_parent_body_energies ) {
+            if ( opt.incremental_body_energies_tolerance >= 0 ) {
+                // computed lazily, only the residues that moved get new energies
+                temp_data_cache_->set_body_energy_parent( data_cache, opt.incremental_body_energies_tolerance );
+            } else if ( opt.use_parent_body_energies ) {
                 std::cout << "use_parent_body_energies: Preparing parent body energies" << std::endl;
                 if ( ! data_cache->local_onebody_p ) {
                     data_cache->setup_onebody_tables( rot_index_p, opt );
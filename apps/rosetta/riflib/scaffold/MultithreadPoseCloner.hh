@@ -16,6 +16,11 @@
 #include <scheme/types.hh>
 
 #include <core/pose/Pose.hh>
+#include <core/conformation/Residue.hh>
+#include <core/id/AtomID.hh>
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -29,98 +34,92 @@ namespace scheme {
 //  pose. 
 //
 // Works as follows:
-//  If one of the poses is available. Lock and clone it
-//  If none of the poses are available. Wait for a pose, duplicate it, 
-//     store that pose in poses. And then retry again.
+//  Each source pose sits in a slot with an atomic busy flag. A thread claims
+//   a free slot and clones it. If it had to skip busy slots to get there, it
+//   also adds a copy of its clone as a new source so the next caller doesn't
+//   have to wait.
+//
+// lease_pose() goes one step further for callers that only need a pose for a
+//  moment (scoring, minimizing a result). The leased pose comes from a free list
+//  and is reset in place to the source coordinates and residues when it is
+//  leased again, so the steady state clones nothing.
 
 // Theoretically the max number of poses == number of threads
 // Alternatively, it's possible the list will never grow past 1
 
 struct MultithreadPoseCloner {
 
-    std::vector<core::pose::PoseCOP> poses_;
-    std::deque<std::mutex> pose_mutexes_;
+private:
+
+    struct Slot {
+        std::atomic<bool> busy;
+        core::pose::PoseCOP pose;
+        Slot() : busy( false ) {}
+    };
 
-    std::mutex vector_mutex_;
+    struct PoolSlot {
+        std::atomic<bool> busy;
+        core::pose::PoseOP pose;
+        PoolSlot() : busy( false ) {}
+    };
 
-    MultithreadPoseCloner() : need_more_poses_(0) {}
+public:
 
-    MultithreadPoseCloner(core::pose::PoseCOP pose) : need_more_poses_(0) {
+    MultithreadPoseCloner( uint64_t capacity = default_capacity() ) { init( capacity ); }
+
+    MultithreadPoseCloner(core::pose::PoseCOP pose, uint64_t capacity = default_capacity() ) {
+        init( capacity );
         add_pose( pose );
     }
 
+    MultithreadPoseCloner( MultithreadPoseCloner const & ) = delete;
+    MultithreadPoseCloner & operator=( MultithreadPoseCloner const & ) = delete;
+
+    // extra sources past capacity are dropped, there can't be more callers than that anyway
     void
     add_pose( core::pose::PoseCOP pose ) {
-        std::lock_guard<std::mutex> guard( vector_mutex_ );
-        poses_.push_back(pose);
-        pose_mutexes_.resize( poses_.size() );
+        uint64_t const idx = reserved_.fetch_add( 1 );
+        if ( idx >= capacity_ ) return;
+        sources_[idx].pose = pose;
+        // publish in order so that everything below filled_ is complete
+        uint64_t expect = idx;
+        while ( ! filled_.compare_exchange_weak( expect, idx+1, std::memory_order_release ) ) {
+            expect = idx;
+            std::this_thread::yield();
+        }
     }
 
-    core::pose::PoseCOP
+    core::pose::PoseOP
     get_pose() {
-        runtime_assert( poses_.size() > 0);
-
-        core::pose::PoseCOP to_return;
-
-        while ( ! to_return ) {
-            int got_lock_at = -1;
-            {
-                std::lock_guard<std::mutex> guard( vector_mutex_ );
-                for ( int i = 0; i < pose_mutexes_.size(); i++ ) {
-                    if ( pose_mutexes_[i].try_lock() ) {
-                        got_lock_at = i;
-                        break;
-                    }
-                }
-            }
-            if (got_lock_at != -1) {
-                to_return = clone_a_pose( poses_[got_lock_at] );
-                pose_mutexes_[got_lock_at].unlock();
-
-                bool should_duplicate = false;
-                {
-                    std::lock_guard<std::mutex> guard( lock_need_more_poses_ );
-                    if (need_more_poses_ > 0) {
-                        need_more_poses_ -= 1;
-                        should_duplicate = true;
-                    }  
+        runtime_assert( size() > 0 );
+
+        bool contended = false;
+        while ( true ) {
+            uint64_t const n = filled_.load( std::memory_order_acquire );
+            for ( uint64_t i = 0; i < n; i++ ) {
+                Slot & slot = sources_[i];
+                if ( slot.busy.exchange( true, std::memory_order_acquire ) ) {
+                    contended = true;
+                    continue;
                 }
-                if (should_duplicate) {
-                    core::pose::PoseCOP new_pose = clone_a_pose( to_return );
-                }
-            } else {
-                std::this_thread::sleep_for( std::chrono::milliseconds {1});
+                core::pose::PoseOP to_return = clone_a_pose( slot.pose );
+                slot.busy.store( false, std::memory_order_release );
+
+                if ( contended && reserved_.load() < capacity_ ) add_pose( clone_a_pose( to_return ) );
+                return to_return;
             }
+            std::this_thread::yield();
         }
-
-        return to_return;
-
     }
 
-    // Don't be super smart/clever here. Just wait for a mutex on the last
-    // element
     void
     duplicate_a_pose() {
-        int pose_to_lock = 0;
-        {
-            std::lock_guard<std::mutex> guard( vector_mutex_ );
-            pose_to_lock = pose_mutexes_.size() - 1;
-        }
-        {
-            std::lock_guard<std::mutex> guard( lock_need_more_poses_ );
-            need_more_poses_ += 1;
-        }
-        pose_mutexes_[pose_to_lock].lock();
-        core::pose::PoseCOP new_pose = clone_a_pose( poses_[pose_to_lock] );
-        pose_mutexes_[pose_to_lock].unlock();
-
-        add_pose( new_pose );
+        add_pose( get_pose() );
     }
 
     uint64_t
-    size() {
-        std::lock_guard<std::mutex> guard( vector_mutex_ );
-        return poses_.size();
+    size() const {
+        return filled_.load( std::memory_order_acquire );
     }
 
     static
@@ -131,11 +130,108 @@ struct MultithreadPoseCloner {
         return to_return;
     }
 
+    // A pose borrowed from the pool, given back when this goes out of scope
+    class PooledPose {
+    public:
+        PooledPose( PooledPose && other ) : slot_( other.slot_ ), pose_( other.pose_ ) {
+            other.slot_ = nullptr;
+        }
+        PooledPose( PooledPose const & ) = delete;
+        ~PooledPose() { if ( slot_ ) slot_->busy.store( false, std::memory_order_release ); }
+
+        core::pose::Pose & pose() { return *pose_; }
+        core::pose::Pose & operator*() { return *pose_; }
+        core::pose::Pose * operator->() { return pose_.get(); }
+
+    private:
+        friend struct MultithreadPoseCloner;
+        PooledPose( PoolSlot * slot, core::pose::PoseOP pose ) : slot_( slot ), pose_( pose ) {}
+
+        PoolSlot * slot_; // nullptr if the pool was full and pose_ is a plain clone
+        core::pose::PoseOP pose_;
+    };
+
+    // A pose identical to the source poses that may be modified freely until the PooledPose is destroyed.
+    // Residues of a different type than the source's are replaced, all other atoms just get their
+    // source coordinates back, which is all that scoring/minimizing a docked result changes
+    PooledPose
+    lease_pose() {
+        setup_template();
+        for ( uint64_t i = 0; i < capacity_; i++ ) {
+            PoolSlot & slot = pooled_[i];
+            if ( slot.busy.exchange( true, std::memory_order_acquire ) ) continue;
+            if ( slot.pose ) {
+                reset_pose( *slot.pose );
+            } else {
+                slot.pose = get_pose();
+            }
+            return PooledPose( &slot, slot.pose );
+        }
+        return PooledPose( nullptr, get_pose() );
+    }
+
+    // frees the pooled poses. no leases may be outstanding
+    void
+    clear_pool() {
+        for ( uint64_t i = 0; i < capacity_; i++ ) {
+            runtime_assert( ! pooled_[i].busy.load() );
+            pooled_[i].pose = nullptr;
+        }
+    }
+
 
 private:
 
-    std::mutex lock_need_more_poses_;
-    int need_more_poses_;
+    static uint64_t default_capacity() {
+        return std::max<uint64_t>( 1, std::thread::hardware_concurrency() );
+    }
+
+    void
+    init( uint64_t capacity ) {
+        capacity_ = capacity;
+        sources_.reset( new Slot[capacity_] );
+        pooled_.reset( new PoolSlot[capacity_] );
+        reserved_ = 0;
+        filled_ = 0;
+    }
+
+    // private copies of the source residues, so that resetting doesn't read poses other threads may clone
+    void
+    setup_template() {
+        if ( template_ready_.load( std::memory_order_acquire ) ) return;
+        std::lock_guard<std::mutex> guard( template_mutex_ );
+        if ( template_ready_.load() ) return;
+        core::pose::PoseOP pose = get_pose();
+        template_residues_.resize( pose->size() );
+        for ( core::Size ir = 1; ir <= pose->size(); ir++ ) {
+            template_residues_[ir-1] = pose->residue(ir).clone();
+        }
+        template_ready_.store( true, std::memory_order_release );
+    }
+
+    void
+    reset_pose( core::pose::Pose & pose ) const {
+        runtime_assert( pose.size() == template_residues_.size() );
+        for ( core::Size ir = 1; ir <= pose.size(); ir++ ) {
+            core::conformation::Residue const & res = *template_residues_[ir-1];
+            if ( &pose.residue_type(ir) != &res.type() ) {
+                pose.replace_residue( ir, res, false );
+                continue;
+            }
+            for ( core::Size ia = 1; ia <= res.natoms(); ia++ ) {
+                pose.set_xyz( core::id::AtomID( ia, ir ), res.xyz( ia ) );
+            }
+        }
+    }
+
+    uint64_t capacity_;
+    std::unique_ptr<Slot[]> sources_;
+    std::atomic<uint64_t> reserved_, filled_;
+
+    std::unique_ptr<PoolSlot[]> pooled_;
+    std::vector<core::conformation::ResidueCOP> template_residues_;
+    std::atomic<bool> template_ready_{ false };
+    std::mutex template_mutex_;
 };
 
 
@@ -26,7 +26,12 @@
 #include <core/pose/PDBInfo.hh>
 
 #include <ObjexxFCL/format.hh>
+#include <utility/file/file_sys_util.hh>
 
+#include <scheme/util/MappedArrayFile.hh>
+
+#include <map>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <boost/any.hpp>
@@ -209,22 +214,54 @@ enum FloatFields {
 
 
 
+// plain old data so that tables can be memory mapped
 struct StatRow {
-    std::vector<uint32_t> int_fields;
-    std::vector<float> float_fields;
-    std::string filename;
+    uint32_t int_fields[last_int_field];
+    float float_fields[last_float_field];
+};
+
+typedef ::scheme::util::MappedArrayFile< StatRow > MappedStatFile;
+
+// One cluster table, indexed by cluster number starting at 1. Either owns its rows (parsed from text) or
+//  views them in a MappedStatFile, which must outlive it
+struct StatTable {
+    StatTable() {}
+    StatTable( StatTable const & ) = delete;
+    StatTable & operator=( StatTable const & ) = delete;
 
-    StatRow() {
-        int_fields.resize(last_int_field);
-        float_fields.resize(last_float_field);
+    void set_owned( std::vector<StatRow> & rows ) { owned_.swap( rows ); data_ = owned_.data(); size_ = owned_.size(); }
+    void set_view( MappedStatFile::View v ) { owned_.clear(); data_ = v.begin(); size_ = v.size(); }
+
+    MappedStatFile::View view() const { MappedStatFile::View v; v.data_ = data_; v.size_ = size_; return v; }
+
+    uint64_t size() const { return size_; }
+    StatRow const & operator[]( uint64_t clust ) const { return data_[clust-1]; }
+    StatRow const & at( uint64_t clust ) const {
+        if ( clust < 1 || clust > size_ ) throw std::out_of_range( "StatTable::at" );
+        return data_[clust-1];
     }
+
+private:
+    std::vector<StatRow> owned_;
+    StatRow const * data_ = nullptr;
+    uint64_t size_ = 0;
 };
 
-typedef utility::vector1<StatRow> StatTable;
 typedef std::shared_ptr<StatTable> StatTableOP;
 typedef std::shared_ptr<StatTable const> StatTableCOP;
 
-typedef utility::vector1<std::vector<uint64_t>> ChildrenByClust;
+// The child clusters of each parent cluster as compressed rows: the children of parent p are
+//  children[ offsets[p] .. offsets[p+1] ), in increasing order
+struct ChildrenByClust {
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> children;
+
+    // parents are numbered from 1; ones without children (or past the last) get an empty list
+    std::vector<uint64_t> at( uint64_t parent ) const {
+        if ( parent+1 >= offsets.size() ) return std::vector<uint64_t>();
+        return std::vector<uint64_t>( children.begin() + offsets[parent], children.begin() + offsets[parent+1] );
+    }
+};
 typedef std::shared_ptr<ChildrenByClust> ChildrenByClustOP;
 typedef std::shared_ptr<ChildrenByClust const> ChildrenByClustCOP;
 
@@ -398,15 +435,21 @@ private:
 
             ChildrenByClustOP by_clust = make_shared<ChildrenByClust>();
 
-
+            // counting sort of the children by parent
+            uint64_t num_parents = 0;
             for ( uint64_t clust_in_child = 1; clust_in_child <= stats->size(); clust_in_child++ ) {
-                StatRow const & sr = (*stats)[clust_in_child];
-                uint64_t clust_in_parent = sr.int_fields[PrevAssig];
-
-                if (clust_in_parent >= by_clust->size()) {
-                    by_clust->resize(clust_in_parent - by_clust->size() + 1);
-                }
-                by_clust->at( clust_in_parent ).push_back( clust_in_child );
+                num_parents = std::max<uint64_t>( num_parents, (*stats)[clust_in_child].int_fields[PrevAssig] + 1 );
+            }
+            by_clust->offsets.assign( num_parents + 1, 0 );
+            for ( uint64_t clust_in_child = 1; clust_in_child <= stats->size(); clust_in_child++ ) {
+                by_clust->offsets[ (*stats)[clust_in_child].int_fields[PrevAssig] + 1 ]++;
+            }
+            for ( uint64_t i = 0; i < num_parents; i++ ) by_clust->offsets[i+1] += by_clust->offsets[i];
+            by_clust->children.resize( stats->size() );
+            std::vector<uint64_t> cursor( by_clust->offsets.begin(), by_clust->offsets.end() - 1 );
+            for ( uint64_t clust_in_child = 1; clust_in_child <= stats->size(); clust_in_child++ ) {
+                uint64_t clust_in_parent = (*stats)[clust_in_child].int_fields[PrevAssig];
+                by_clust->children[ cursor[clust_in_parent]++ ] = clust_in_child;
             }
 
             children_by_clusts_[key] = by_clust;
@@ -436,78 +479,137 @@ private:
 
     StatTableCOP
     load_stat_table( uint64_t cdindex ) {
-        using ObjexxFCL::format::I;
 
         if ( ! tables_.at(cdindex) ) {
-            
+            open_mapped_tables();
+        }
 
+        // open_mapped_tables() fills every table itself when it parsed the text but couldn't write the map
+        if ( ! tables_.at(cdindex) ) {
+            StatTableOP table = make_shared<StatTable>();
+            std::string const & name = CLUSTER_DATA_NAMES.at( cdindex );
+            if ( mapped_tables_.has( name ) ) {
+                table->set_view( mapped_tables_.get( name ) );
+            } else {
+                std::vector<StatRow> rows = read_stat_table_text( cdindex );
+                table->set_owned( rows );
+            }
 
-            std::string filename = opt.nineA_cluster_path 
-                                    + "/kcenters_stats_al1.dat" 
-                                    + CLUSTER_DATA_NAMES.at( cdindex );
+            tables_[cdindex] = table;
+        }
 
-            std::ifstream f( filename );
+        return tables_[cdindex];
 
-            if ( !f ) {
-                utility_exit_with_message("nineA_cluster_path file not found: " + filename);
-            }
+    }
 
-            std::string line;
-            std::getline( f, line );
+    // Maps the binary copy of the tables if there is one. If -nineA_mapped_cache names a file that
+    //  doesn't exist yet, every text table is parsed once and written there
+    void
+    open_mapped_tables() {
+        if ( mapped_tables_checked_ ) return;
+        mapped_tables_checked_ = true;
 
-            utility::vector1< std::string > string_split = utility::string_split( line, '\t' );
+        bool const convert = ! opt.nineA_mapped_cache.empty();
+        std::string const fname = convert ? opt.nineA_mapped_cache : opt.nineA_cluster_path + "/kcenters_stats_al1.mapped";
 
-            if ( string_split.size() != 395 ) {
-                utility_exit_with_message("nineA_cluster_path file has wrong number of columns:  " 
-                    + I(3,string_split.size()) + " != 395 " + filename);
+        if ( utility::file::file_exists( fname ) ) {
+            if ( mapped_tables_.open( fname ) ) {
+                std::cout << "NineAManager: mapped " << mapped_tables_.size() << " cluster tables from " << fname << std::endl;
+                return;
             }
+            std::cout << "WARNING: NineAManager: can't read " << fname << ", using the text tables" << std::endl;
+            return;
+        }
+        if ( ! convert ) return;
+
+        std::cout << "NineAManager: converting the cluster tables in " << opt.nineA_cluster_path << " to " << fname << std::endl;
+        std::vector< std::vector<StatRow> > all_rows( NUM_CLUSTERS );
+        std::map< std::string, MappedStatFile::View > entries;
+        for ( uint64_t cdindex = 0; cdindex < NUM_CLUSTERS; cdindex++ ) {
+            all_rows[cdindex] = read_stat_table_text( cdindex );
+            MappedStatFile::View v;
+            v.data_ = all_rows[cdindex].data();
+            v.size_ = all_rows[cdindex].size();
+            entries[ CLUSTER_DATA_NAMES[cdindex] ] = v;
+        }
+        if ( MappedStatFile::write( fname, entries ) && mapped_tables_.open( fname ) ) return;
 
-
+        std::cout << "WARNING: NineAManager: can't write " << fname << ", using the text tables" << std::endl;
+        for ( uint64_t cdindex = 0; cdindex < NUM_CLUSTERS; cdindex++ ) {
             StatTableOP table = make_shared<StatTable>();
+            table->set_owned( all_rows[cdindex] );
+            tables_[cdindex] = table;
+        }
+    }
+
+    std::vector<StatRow>
+    read_stat_table_text( uint64_t cdindex ) {
+        using ObjexxFCL::format::I;
+
+        std::string filename = opt.nineA_cluster_path 
+                                + "/kcenters_stats_al1.dat" 
+                                + CLUSTER_DATA_NAMES.at( cdindex );
+
+        std::ifstream f( filename );
+
+        if ( !f ) {
+            utility_exit_with_message("nineA_cluster_path file not found: " + filename);
+        }
+
+        std::string line;
+        std::getline( f, line );
+
+        utility::vector1< std::string > string_split = utility::string_split( line, '\t' );
+
+        if ( string_split.size() != 395 ) {
+            utility_exit_with_message("nineA_cluster_path file has wrong number of columns:  " 
+                + I(3,string_split.size()) + " != 395 " + filename);
+        }
+
+
+        std::vector<StatRow> table;
 
-            while ( std::getline( f, line ) ) {
-                utility::vector1< std::string > sp = utility::string_split( line, '\t' );
-                if ( sp.size() <= 1 ) {
-                    break;
-                }
-                if ( sp.size() != 395 ) {
-                    utility_exit_with_message("nineA_cluster_path file has wrong number of columns inside:  " 
-                    + I(3,sp.size()) + " != 395 " + filename);
-                }
-
-                StatRow sr;
-                uint64_t pos = 1;
-
-                pos++;
-                read_int(sr,pos,sp, Clust);
-                read_int(sr,pos,sp, NumCon);
-                read_float(sr,pos,sp, AvgRad);
-                read_float(sr,pos,sp, MaxRad);
-                for ( int i = 0; i < 36*3; i++ ) {
-                    read_float(sr,pos,sp, static_cast<FloatFields>(static_cast<int>(X_1) + i));
-                }
-                for ( int i = 0; i < 3*9; i++ ) {
-                    read_float(sr,pos,sp, static_cast<FloatFields>(static_cast<int>(Phi_1) + i));
-                }
-                pos += 393 - 141;
-                sr.filename = sp[pos++];
-                pos++;
-                read_int(sr,pos,sp, PrevAssig);
-
-                table->push_back( sr );
+        while ( std::getline( f, line ) ) {
+            utility::vector1< std::string > sp = utility::string_split( line, '\t' );
+            if ( sp.size() <= 1 ) {
+                break;
+            }
+            if ( sp.size() != 395 ) {
+                utility_exit_with_message("nineA_cluster_path file has wrong number of columns inside:  " 
+                + I(3,sp.size()) + " != 395 " + filename);
             }
 
-            f.close();
+            StatRow sr = StatRow();
+            uint64_t pos = 1;
 
-            tables_[cdindex] = table;
+            pos++;
+            read_int(sr,pos,sp, Clust);
+            read_int(sr,pos,sp, NumCon);
+            read_float(sr,pos,sp, AvgRad);
+            read_float(sr,pos,sp, MaxRad);
+            for ( int i = 0; i < 36*3; i++ ) {
+                read_float(sr,pos,sp, static_cast<FloatFields>(static_cast<int>(X_1) + i));
+            }
+            for ( int i = 0; i < 3*9; i++ ) {
+                read_float(sr,pos,sp, static_cast<FloatFields>(static_cast<int>(Phi_1) + i));
+            }
+            pos += 393 - 141;
+            pos++; // source filename, unused
+            pos++;
+            read_int(sr,pos,sp, PrevAssig);
+
+            table.push_back( sr );
         }
 
-        return tables_[cdindex];
+        f.close();
 
+        return table;
     }
 
     static shared_ptr<NineAManager> single_instance_;
 
+    MappedStatFile mapped_tables_; // must outlive tables_, which may view into it
+    bool mapped_tables_checked_ = false;
     std::vector< StatTableOP > tables_;
     std::unordered_map<std::string, ChildrenByClustOP> children_by_clusts_;
 
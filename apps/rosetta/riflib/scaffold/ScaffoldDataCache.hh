@@ -95,6 +95,10 @@ struct ScaffoldDataCache {
 
     std::vector<shared_ptr<TBT>> local_twobody_per_thread;                     // Used with BuriedUnsats, these can momentarily change but must be reset
 
+    shared_ptr<ScaffoldDataCache> body_energy_parent_p;                        // if set, body energies are derived from this scaffold's
+    float body_energy_tolerance;                                               //   for every residue that moved less than this
+    std::vector<int> res_to_parent;                                            // global_seqpos -> parent global_seqpos, -1 if moved
+
 
     MultithreadPoseCloner mpc_both_pose;                                       // scaffold_centered_p + target
     MultithreadPoseCloner mpc_both_full_pose;                                  // scaffold_full_centered_p + target
@@ -102,6 +106,7 @@ struct ScaffoldDataCache {
     MultithreadPoseCloner mpc_scaffold_full_centered;                               
 
     std::vector<CstBaseOP> csts;
+    CompiledCstSet compiled_csts; // csts after prepare_contraints
 
     shared_ptr<BurialVoxelArray> burial_grid;
 
@@ -133,6 +138,7 @@ struct ScaffoldDataCache {
         ExtraScaffoldData extra_data = extra_data_in;
 
         debug_sanity = 1337;
+        body_energy_tolerance = -1;
 
         scaffold_res_p = make_shared<utility::vector1<core::Size>>(scaffold_res_in);
         scafftag = scafftag_in;
@@ -426,6 +432,7 @@ struct ScaffoldDataCache {
             cst->init(target, *scaffold_centered_p, resl);
             any_csts = true;
         }
+        compiled_csts.compile( csts );
         return any_csts;
     }
 
@@ -478,6 +485,11 @@ struct ScaffoldDataCache {
 
         if (local_onebody_p) return;
 
+        if ( body_energy_parent_p ) {
+            update_onebody_tables_from_parent( rot_index_p, opt );
+            return;
+        }
+
         scaffold_onebody_glob0_p = make_shared<std::vector<std::vector<float> >>();
 
         std::string cachefile_1be = "__1BE_"+scafftag+(opt.replace_all_with_ala_1bre?"_ALLALA":"")+"_reshash"+scaff_res_hashstr+".bin.gz";
@@ -519,6 +531,12 @@ struct ScaffoldDataCache {
         //     }
         // }
 
+        setup_local_onebody();
+    }
+
+    // local_onebody_p from scaffold_onebody_glob0_p, and blocks out the residues not being used
+    void
+    setup_local_onebody() {
         local_onebody_p = make_shared<std::vector<std::vector<float> > >();
         for( int i = 0; i < scaffres_l2g_p->size(); ++i ){
             local_onebody_p->push_back( scaffold_onebody_glob0_p->at( scaffres_l2g_p->at(i) ) );
@@ -531,6 +549,100 @@ struct ScaffoldDataCache {
         }
     }
 
+    // body energies of morphed scaffolds come from the scaffold they were made from, see setup_onebody_tables
+    void
+    set_body_energy_parent( shared_ptr<ScaffoldDataCache> parent, float tolerance ) {
+        body_energy_parent_p = parent;
+        body_energy_tolerance = tolerance;
+    }
+
+    // fills res_to_parent and returns the residues (global_seqpos-1) whose onebody energies must be recomputed
+    std::vector<bool>
+    map_residues_to_body_energy_parent( RotamerIndex const & rot_index ) {
+        ScaffoldDataCache const & parent = *body_energy_parent_p;
+        core::pose::Pose const & pose = *scaffold_centered_p;
+        core::pose::Pose const & parent_pose = *parent.scaffold_centered_p;
+
+        res_to_parent = map_unmoved_residues( parent_pose, pose, body_energy_tolerance );
+
+        // being designed and the custom energies have to match too
+        for( int ir = 0; ir < res_to_parent.size(); ++ir ){
+            int const pr = res_to_parent[ir];
+            if( pr < 0 ) continue;
+            int const il = scaffres_g2l_p->at(ir);
+            int const pl = parent.scaffres_g2l_p->at(pr);
+            bool same = ( il < 0 ) == ( pl < 0 );
+            if( same && il >= 0 && ( per_rotamer_custom_energies_p || parent.per_rotamer_custom_energies_p ) ){
+                same = per_rotamer_custom_energies_p && parent.per_rotamer_custom_energies_p
+                    && per_rotamer_custom_energies_p->at(il) == parent.per_rotamer_custom_energies_p->at(pl);
+            }
+            if( ! same ) res_to_parent[ir] = -1;
+        }
+
+        // residues that moved, appeared or disappeared change the onebody energies around them
+        std::vector<bool> parent_kept( parent_pose.size(), false );
+        for( int pr : res_to_parent ) if( pr >= 0 ) parent_kept[pr] = true;
+        std::vector<std::pair<core::Vector, float> > changed;
+        for( core::Size ir = 1; ir <= pose.size(); ++ir ){
+            if( res_to_parent[ir-1] < 0 ) changed.emplace_back( pose.residue(ir).nbr_atom_xyz(), pose.residue(ir).nbr_radius() );
+        }
+        for( core::Size pr = 1; pr <= parent_pose.size(); ++pr ){
+            if( ! parent_kept[pr-1] ) changed.emplace_back( parent_pose.residue(pr).nbr_atom_xyz(), parent_pose.residue(pr).nbr_radius() );
+        }
+
+        // same neighbor definition and score function reach as compute_onebody_rotamer_energies
+        float const reach = rot_index.get_max_nbr_radius() + onebody_rotamer_energy_interaction_distance();
+        std::vector<bool> recompute( pose.size(), false );
+        for( core::Size ir = 1; ir <= pose.size(); ++ir ){
+            recompute[ir-1] = res_to_parent[ir-1] < 0;
+            for( int ic = 0; ic < changed.size() && ! recompute[ir-1]; ++ic ){
+                float const dist = changed[ic].second + reach;
+                recompute[ir-1] = pose.residue(ir).nbr_atom_xyz().distance_squared( changed[ic].first ) < dist*dist;
+            }
+        }
+        return recompute;
+    }
+
+    // copies the onebody rows of the parent's residues that didn't move and recomputes the rest.
+    // if nothing changed at all, the parent's tables are shared instead
+    void
+    update_onebody_tables_from_parent(
+        shared_ptr< RotamerIndex > rot_index_p,
+        RifDockOpt const & opt ) {
+
+        ScaffoldDataCache & parent = *body_energy_parent_p;
+        parent.setup_onebody_tables( rot_index_p, opt );
+
+        std::vector<bool> recompute = map_residues_to_body_energy_parent( *rot_index_p );
+        int const nrecompute = std::count( recompute.begin(), recompute.end(), true );
+        std::cout << "rifdock: " << scafftag << " recomputing onebody energies of " << nrecompute << " of "
+                  << recompute.size() << " residues" << std::endl;
+
+        if ( nrecompute == 0 && scaffold_centered_p->size() == parent.scaffold_centered_p->size() ) {
+            scaffold_onebody_glob0_p = parent.scaffold_onebody_glob0_p;
+            local_onebody_p = parent.local_onebody_p;
+            return;
+        }
+
+        scaffold_onebody_glob0_p = make_shared<std::vector<std::vector<float> >>( scaffold_centered_p->size() );
+        for( int ir = 0; ir < res_to_parent.size(); ++ir ){
+            if( ! recompute[ir] ) (*scaffold_onebody_glob0_p)[ir] = parent.scaffold_onebody_glob0_p->at( res_to_parent[ir] );
+        }
+        update_onebody_rotamer_energies(
+                *scaffold_centered_p,
+                *scaffold_res_p,
+                *rot_index_p,
+                *scaffold_onebody_glob0_p,
+                recompute,
+                opt.replace_all_with_ala_1bre,
+                opt.favorable_1body_multiplier,
+                opt.favorable_1body_multiplier_cutoff,
+                per_rotamer_custom_energies_p
+            );
+
+        setup_local_onebody();
+    }
+
     // setup scaffold_twobody_p and local_twobody_p
     void
     setup_twobody_tables(  
@@ -541,6 +653,30 @@ struct ScaffoldDataCache {
 
         if (local_twobody_p) return;
 
+        if ( body_energy_parent_p ) {
+            ScaffoldDataCache & parent = *body_energy_parent_p;
+            parent.setup_twobody_tables( rot_index_p, opt, make2bopts, rotrf_table_manager );
+            if ( scaffold_onebody_glob0_p == parent.scaffold_onebody_glob0_p ) {
+                // nothing moved
+                scaffold_twobody_p = parent.scaffold_twobody_p;
+                local_twobody_p = parent.local_twobody_p;
+                return;
+            }
+            scaffold_twobody_p = make_shared<TBT>();
+            update_twobody_tables(
+                    *scaffold_centered_p,
+                    *rot_index_p,
+                    *scaffold_onebody_glob0_p,
+                    rotrf_table_manager,
+                    make2bopts,
+                    *parent.scaffold_twobody_p,
+                    res_to_parent,
+                    *scaffold_twobody_p
+                );
+            local_twobody_p = scaffold_twobody_p->create_subtable( *scaffuseres_p, *scaffold_onebody_glob0_p, make2bopts.onebody_threshold );
+            return;
+        }
+
         scaffold_twobody_p = make_shared<TBT>( scaffold_centered_p->size(), rot_index_p->size()  );
 
         std::string energy_cut = boost::str(boost::format("_ecut_%.2f")%opt.rotamer_onebody_inclusion_threshold);
@@ -8,6 +8,7 @@
 // (c) addressed to University of Waprotocolsgton UW TechTransfer, email: license@u.washington.eprotocols
 
 #include <riflib/scaffold/util.hh>
+#include <riflib/scaffold/IndexedSilentFile.hh>
 #include <riflib/types.hh>
 #include <riflib/rifdock_typedefs.hh>
 #include <scheme/scaffold/ScaffoldProviderBase.hh>
@@ -40,6 +41,8 @@
 #include <basic/options/keys/indexed_structure_store.OptionKeys.gen.hh>
 #endif
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <vector>
 #include <boost/any.hpp>
@@ -78,7 +81,16 @@ get_info_for_iscaff(
 
     std::cout << "!!!!!!!!!!!!!!!name:: " << scaff_fname << std::endl;
 
-    core::import_pose::pose_from_file( scaffold, scaff_fname );
+    std::string silent_fname, silent_tag;
+    if ( split_silent_scaffold_fname( scaff_fname, silent_fname, silent_tag ) ) {
+        IndexedSilentFileOP silent = get_indexed_silent_file( silent_fname );
+        int64_t istruct = silent->index_of( silent_tag );
+        if ( istruct < 0 ) utility_exit_with_message( "No structure " + silent_tag + " in silent file: " + silent_fname );
+        scaffold = *silent->pose( istruct );
+        scafftag = silent_scaffold_tag( silent_fname, silent_tag );
+    } else {
+        core::import_pose::pose_from_file( scaffold, scaff_fname );
+    }
 
     scaffold_perturb = EigenXform::Identity();
     if( opt.random_perturb_scaffold ){
@@ -804,11 +816,126 @@ internal_comparative_clash_check( core::scoring::Energies const & original_energ
 }
 
 
+// a residue is unmoved if it has the same type and its backbone (the nbr atom for non-protein)
+// is within tolerance of the parent's
+static bool
+residue_unmoved( core::conformation::Residue const & res, core::conformation::Residue const & parent_res, float tolerance ) {
+    if ( res.name3() != parent_res.name3() || res.is_protein() != parent_res.is_protein() ) return false;
+    float const tol2 = tolerance * tolerance;
+    if ( ! res.is_protein() ) {
+        return res.xyz( res.nbr_atom() ).distance_squared( parent_res.xyz( parent_res.nbr_atom() ) ) <= tol2;
+    }
+    for ( std::string const & name : { "N", "CA", "C" } ) {
+        if ( res.xyz( name ).distance_squared( parent_res.xyz( name ) ) > tol2 ) return false;
+    }
+    return true;
+}
+
+std::vector<int>
+map_unmoved_residues( core::pose::Pose const & parent, core::pose::Pose const & pose, float tolerance ) {
+
+    std::vector<int> res_to_parent( pose.size(), -1 );
+
+    if ( pose.size() == parent.size() ) {
+        for ( core::Size ir = 1; ir <= pose.size(); ir++ ) {
+            if ( residue_unmoved( pose.residue(ir), parent.residue(ir), tolerance ) ) res_to_parent[ir-1] = ir-1;
+        }
+        return res_to_parent;
+    }
+
+    // insertions and deletions: match what is left unchanged on either side of them
+    core::Size const shorter = std::min( pose.size(), parent.size() );
+    core::Size prefix = 0;
+    while ( prefix < shorter && residue_unmoved( pose.residue(prefix+1), parent.residue(prefix+1), tolerance ) ) {
+        res_to_parent[prefix] = prefix;
+        prefix++;
+    }
+    for ( core::Size suffix = 0; suffix < shorter - prefix; suffix++ ) {
+        core::Size const ir = pose.size() - suffix;
+        core::Size const pr = parent.size() - suffix;
+        if ( ! residue_unmoved( pose.residue(ir), parent.residue(pr), tolerance ) ) break;
+        res_to_parent[ir-1] = pr-1;
+    }
+
+    return res_to_parent;
+}
+
+
+bool
+split_silent_scaffold_fname( std::string const & scaff_fname, std::string & silent_fname, std::string & tag ) {
+    std::string const marker = ".silent:";
+    size_t pos = scaff_fname.rfind( marker );
+    if ( pos == std::string::npos ) return false;
+    silent_fname = scaff_fname.substr( 0, pos + marker.size() - 1 );
+    tag = scaff_fname.substr( pos + marker.size() );
+    return ! tag.empty();
+}
+
+std::string
+silent_scaffold_tag( std::string const & silent_fname, std::string const & tag ) {
+    std::string name = utility::file_basename( silent_fname );
+    if ( utility::endswith( name, ".silent" ) ) name = name.substr( 0, name.length() - 7 );
+    return name + "_" + tag;
+}
+
+void
+expand_silent_scaffold_fnames( RifDockOpt & opt ) {
+    size_t const nscaff = opt.scaffold_fnames.size();
+    std::vector<std::vector<std::string> *> per_scaffold_lists {
+        &opt.scaffold_res_fnames, &opt.cst_fnames, &opt.morph_rules_fnames, &opt.rotamer_boltzmann_fnames,
+        &opt.pssm_file_fnames, &opt.scaffold_clash_contexts, &opt.seeding_fnames };
+
+    std::vector<std::string> scaffold_fnames;
+    std::vector<std::vector<std::string>> expanded_lists( per_scaffold_lists.size() );
+
+    for ( size_t iscaff = 0; iscaff < nscaff; iscaff++ ) {
+        std::string const & fname = opt.scaffold_fnames[iscaff];
+        std::vector<std::string> names;
+        if ( utility::endswith( fname, ".silent" ) ) {
+            IndexedSilentFileOP silent = get_indexed_silent_file( fname );
+            if ( ! silent->good() ) utility_exit_with_message( "No structures found in silent file: " + fname );
+            for ( size_t i = 0; i < silent->size(); i++ ) names.push_back( fname + ":" + silent->tag(i) );
+        } else {
+            names.push_back( fname );
+        }
+        scaffold_fnames.insert( scaffold_fnames.end(), names.begin(), names.end() );
+        for ( size_t ilist = 0; ilist < per_scaffold_lists.size(); ilist++ ) {
+            std::vector<std::string> const & list = *per_scaffold_lists[ilist];
+            if ( list.size() != nscaff || nscaff == 1 ) continue;
+            expanded_lists[ilist].insert( expanded_lists[ilist].end(), names.size(), list[iscaff] );
+        }
+    }
+
+    if ( scaffold_fnames.size() == nscaff ) return;
+    std::cout << "Silent files expanded to " << scaffold_fnames.size() << " scaffolds" << std::endl;
+
+    opt.scaffold_fnames = scaffold_fnames;
+    for ( size_t ilist = 0; ilist < per_scaffold_lists.size(); ilist++ ) {
+        if ( per_scaffold_lists[ilist]->size() != nscaff || nscaff == 1 ) continue;
+        *per_scaffold_lists[ilist] = expanded_lists[ilist];
+    }
+}
+
+
 std::vector<core::pose::PoseOP>
-extract_poses_from_silent_file( std::string const & filename ) {
+extract_poses_from_silent_file( std::string const & filename, uint64_t random_subset /*= 0*/ ) {
 
     std::cout << "Reading poses from silent file: " << filename << std::endl;
 
+    // uncompressed files are indexed and only the structures we keep are decoded
+    IndexedSilentFileOP indexed = get_indexed_silent_file( filename );
+    if ( indexed->good() ) {
+        std::vector<size_t> which( indexed->size() );
+        std::iota( which.begin(), which.end(), 0 );
+        if ( random_subset > 0 && random_subset < which.size() ) {
+            std::cout << "Randomly selecting " << random_subset << " from silent file" << std::endl;
+            std::random_shuffle( which.begin(), which.end() );
+            which.resize( random_subset );
+        }
+        std::cout << "Turning structures into poses" << std::endl;
+        return indexed->poses( which );
+    }
+
 
     core::io::silent::SilentFileOptions options;
     core::io::silent::SilentFileData sfd( options );
@@ -845,6 +972,12 @@ extract_poses_from_silent_file( std::string const & filename ) {
     } // end of OMP loop
     if( exception ) std::rethrow_exception(exception);
 
+    if ( random_subset > 0 && random_subset < poses.size() ) {
+        std::cout << "Randomly selecting " << random_subset << " from silent file" << std::endl;
+        std::random_shuffle( poses.begin(), poses.end() );
+        poses.resize( random_subset );
+    }
+
 
     // for ( std::string const & tag : sfd.tags() ){
     //     core::io::silent::SilentStruct const & ss = sfd.get_structure(tag);
@@ -102,8 +102,29 @@ internal_comparative_clash_check( core::scoring::Energies const & original_energ
     core::Size high_position );
 
 
+// maps each residue of pose (0-based) to the residue of parent it is unchanged from, -1 if it moved
+// more than tolerance. poses of different length are matched around the insertion/deletion
+std::vector<int>
+map_unmoved_residues( core::pose::Pose const & parent, core::pose::Pose const & pose, float tolerance );
+
+// a -scaffolds entry naming one structure of a silent file, "<file>.silent:<tag>"
+bool
+split_silent_scaffold_fname( std::string const & scaff_fname, std::string & silent_fname, std::string & tag );
+
+// scafftag of a structure in a silent file, prefixed with the file's name since tags are only unique
+// within one file and the scafftag names the per-scaffold cache and output files
+std::string
+silent_scaffold_tag( std::string const & silent_fname, std::string const & tag );
+
+// replaces each *.silent file in opt.scaffold_fnames with one "<file>.silent:<tag>" entry per
+// structure, repeating the matching entries of the other per-scaffold lists. nothing is decoded here,
+// get_info_for_iscaff reads each structure when the scaffold loop gets to it
+void
+expand_silent_scaffold_fnames( RifDockOpt & opt );
+
+// all the structures of a silent file as poses, or a random random_subset of them if > 0
 std::vector<core::pose::PoseOP>
-extract_poses_from_silent_file( std::string const & filename );
+extract_poses_from_silent_file( std::string const & filename, uint64_t random_subset = 0 );
 
 std::string
 pdb_name( std::string const & fname );
@@ -9,6 +9,9 @@
 
 #include <core/import_pose/import_pose.hh>
 
+#include <scheme/dock/fftdock.hh>
+#include <scheme/nest/pmap/TetracontoctachoronMap.hh>
+
 
 namespace devel {
 namespace scheme {
@@ -104,6 +107,85 @@ setup_seeding_positions( RifDockOpt & opt, ProtocolData & pd, ScaffoldProviderOP
 
 
 
+// Seeding positions from an FFT translational scan of the scaffold's simple atoms against
+//  target_field_by_atype, one scan per coarse orientation. The seeds are in the centered
+//  scaffold frame, so the nest director only needs to search locally around each of them.
+shared_ptr<std::vector<EigenXform>>
+setup_fft_seeding_positions(
+    RifDockOpt & opt,
+    ProtocolData & pd,
+    ScaffoldProviderOP & scaffold_provider,
+    std::vector< VoxelArrayPtr > const & target_field_by_atype,
+    Eigen::Vector3f const & target_center
+) {
+    typedef ::scheme::dock::FFTTranslationScorer<float> FFTScorer;
+    typedef ::scheme::nest::pmap::TetracontoctachoronMap<3,Eigen::Matrix3f,uint64_t,float> OriMap;
+
+    ScaffoldDataCacheOP data_cache = scaffold_provider->get_data_cache_slow(ScaffoldIndex());
+    std::vector< SimpleAtom > const & scaff_atoms = *data_cache->scaffold_simple_atoms_p;
+
+    std::vector<FFTScorer::BodyAtom> body;
+    float scaff_radius = 0;
+    for ( SimpleAtom const & a : scaff_atoms ) {
+        if ( a.type() >= target_field_by_atype.size() || ! target_field_by_atype[a.type()] ) continue;
+        body.push_back( std::make_pair( (int)a.type(), a.position() ) );
+        scaff_radius = std::max( scaff_radius, a.position().norm() );
+    }
+    runtime_assert_msg( body.size(), "fft seeding: no scaffold atoms with target fields" );
+
+    float target_extent = 0;
+    for ( VoxelArrayPtr field : target_field_by_atype ) {
+        if ( ! field ) continue;
+        for ( int k = 0; k < 3; k++ ) target_extent = std::max( target_extent, field->ub_[k] - field->lb_[k] );
+    }
+    int n = 1;
+    while ( n * opt.fft_seed_resl < target_extent + 2*scaff_radius && n < 256 ) n *= 2;
+
+    FFTScorer scorer( target_center, opt.fft_seed_resl, n );
+    for ( auto const & a : body ) {
+        if ( scorer.has_channel( a.first ) ) continue;
+        VoxelArrayPtr field = target_field_by_atype[a.first];
+        scorer.set_target_channel( a.first, [field]( float x, float y, float z ){ return field->at( x, y, z ); }, 10.0 );
+    }
+
+    OriMap ori_map( OriMap::get_nside_for_rot_resl_deg( opt.fft_seed_ori_resl ) );
+    std::vector<FFTScorer::Mat3> rotations( ori_map.num_cells() );
+    OriMap::Params params( 0.5, 0.5, 0.5 );
+    for ( uint64_t i = 0; i < ori_map.num_cells(); i++ ) ori_map.params_to_value( params, i, 0, rotations[i] );
+
+    std::cout << "fft seeding: grid " << n << "^3 at " << opt.fft_seed_resl << "A, " << rotations.size()
+              << " orientations, " << body.size() << " scaffold atoms" << std::endl;
+
+    std::vector<FFTScorer::Hit> hits;
+    int const npeaks_per_ori = std::max( 4, opt.fft_seed_npeaks / (int)rotations.size() + 1 );
+    scorer.search( rotations, body, npeaks_per_ori, 2.0*opt.fft_seed_resl, 0.0, hits );
+    if ( (int)hits.size() > opt.fft_seed_npeaks ) hits.resize( opt.fft_seed_npeaks );
+
+    shared_ptr<std::vector<EigenXform>> seeding_positions = make_shared<std::vector<EigenXform>>();
+    for ( FFTScorer::Hit const & h : hits ) {
+        EigenXform x( EigenXform::Identity() );
+        x.linear() = h.rotation;
+        x.translation() = h.translation;
+        seeding_positions->push_back( x );
+    }
+    if ( hits.size() ) {
+        std::cout << "fft seeding: " << hits.size() << " seeds, scores " << hits.front().score << " to " << hits.back().score << std::endl;
+    } else {
+        std::cout << "fft seeding: no translations scored below 0" << std::endl;
+    }
+
+    if ( opt.write_seed_to_output ) {
+        size_t digits = boost::str(boost::format("%i")%(std::max<size_t>(1,seeding_positions->size())-1)).length();
+        std::string format = "%0" + boost::str(boost::format("%i")%digits) + "i";
+        for ( size_t i = 0; i < seeding_positions->size(); i++ ) {
+            pd.seeding_tags.push_back("_FFT_" + boost::str(boost::format(format)%i));
+        }
+    }
+
+    return seeding_positions;
+}
+
+
 bool 
 parse_exhausitive_searching_file(
     std::string fname, 
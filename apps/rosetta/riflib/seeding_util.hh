@@ -28,6 +28,15 @@ namespace scheme {
 shared_ptr<std::vector<EigenXform>>
 setup_seeding_positions( RifDockOpt & opt, ProtocolData & pd, ScaffoldProviderOP & scaffold_provider, int iscaff );
 
+shared_ptr<std::vector<EigenXform>>
+setup_fft_seeding_positions(
+    RifDockOpt & opt,
+    ProtocolData & pd,
+    ScaffoldProviderOP & scaffold_provider,
+    std::vector< VoxelArrayPtr > const & target_field_by_atype,
+    Eigen::Vector3f const & target_center
+);
+
 bool 
 parse_exhausitive_searching_file(
     std::string fname, 
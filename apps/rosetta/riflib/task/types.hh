@@ -18,12 +18,14 @@
 #include <riflib/RifFactory.hh>
 
 #include <utility/io/ozstream.hh>
+#include <scheme/util/SpanArena.hh>
 
 #ifdef USEGRIDSCORE
 #include <protocols/ligand_docking/GALigandDock/GridScorer.hh>
 #endif
 
 #include <chrono>
+#include <parallel/algorithm>
 
 
 using ::scheme::make_shared;
@@ -34,6 +36,15 @@ typedef int32_t intRot;
 namespace devel {
 namespace scheme {
 
+// The packed (local seqpos, irot) of a result. These live in big shared blocks
+//  filled by a RotamerArena so that packing tens of millions of samples doesn't
+//  mean tens of millions of little vectors, and copying a result is cheap.
+typedef ::scheme::util::ArenaSpan< std::pair<intRot,intRot> > RotamerAssignment;
+typedef ::scheme::util::SpanArena< std::pair<intRot,intRot> > RotamerArena;
+
+// A rigid body move applied on top of the position the director gives a result's
+//  index, set by GridMinTask. Null for the (usual) results that sit on the grid.
+typedef shared_ptr< EigenXform const > PositionDeltaCOP;
 
 
 
@@ -81,15 +92,14 @@ struct tmplSearchPointWithRots {
     uint16_t sasa;
     uint32_t prepack_rank;
     DirectorBigIndex index;
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers_;
+    RotamerAssignment rotamers_;
     core::pose::PoseOP pose_ = nullptr;
-    tmplSearchPointWithRots() : score(9e9), prepack_rank(0), rotamers_(nullptr) {}
-    tmplSearchPointWithRots(DirectorBigIndex i, uint32_t orank) : score(9e9), prepack_rank(orank), index(i), rotamers_(nullptr) {}
-    // ~SearchPointWithRots() { delete rotamers_; }
-    void checkinit() { if( rotamers_==nullptr ) rotamers_ = make_shared< std::vector< std::pair<intRot,intRot> > > ();  }
-    std::vector< std::pair<intRot,intRot> > & rotamers() { checkinit(); return *rotamers_; }
-    std::vector< std::pair<intRot,intRot> > const & rotamers() const { runtime_assert(rotamers_!=nullptr); return *rotamers_; }
-    size_t numrots() const { if(rotamers_==nullptr) return 0; return rotamers_->size(); }
+    PositionDeltaCOP position_delta_ = nullptr;
+    tmplSearchPointWithRots() : score(9e9), prepack_rank(0) {}
+    tmplSearchPointWithRots(DirectorBigIndex i, uint32_t orank) : score(9e9), prepack_rank(orank), index(i) {}
+    void set_rotamers( RotamerArena & arena, std::vector< std::pair<intRot,intRot> > const & rots ) { rotamers_ = arena.store( rots ); }
+    RotamerAssignment const & rotamers() const { runtime_assert((bool)rotamers_); return rotamers_; }
+    size_t numrots() const { return rotamers_.size(); }
     bool operator < (This const & o) const {
         return score < o.score;
     }
@@ -105,6 +115,7 @@ struct tmplSearchPointWithRots {
         index = ot.index;
         rotamers_ = ot.rotamers_;
         pose_ = ot.pose_;
+        position_delta_ = ot.position_delta_;
         sasa = ot.sasa;
         return *this;
     }
@@ -123,10 +134,11 @@ struct tmplRifDockResult {
     uint32_t prepack_rank;
     float cluster_score;
     bool operator< ( This const & o ) const { return score < o.score; }
-    shared_ptr< std::vector< std::pair<intRot,intRot> > > rotamers_;
+    RotamerAssignment rotamers_;
     core::pose::PoseOP pose_ = nullptr;
-    size_t numrots() const { if(rotamers_==nullptr) return 0; return rotamers_->size(); }
-    std::vector< std::pair<intRot,intRot> > const & rotamers() const { assert(rotamers_!=nullptr); return *rotamers_; }
+    PositionDeltaCOP position_delta_ = nullptr;
+    size_t numrots() const { return rotamers_.size(); }
+    RotamerAssignment const & rotamers() const { assert((bool)rotamers_); return rotamers_; }
 
     This& operator=( tmplSearchPoint<DirectorBigIndex> const & ot ) {
         score = ot.score;
@@ -140,6 +152,7 @@ struct tmplRifDockResult {
         index = ot.index;
         rotamers_ = ot.rotamers_;
         pose_ = ot.pose_;
+        position_delta_ = ot.position_delta_;
         sasa = ot.sasa;
         return *this;
     }
@@ -160,6 +173,25 @@ using _SearchPoint = tmplSearchPoint<_DirectorBigIndex<__Director>>;
 typedef _SearchPoint<DirectorBase> SearchPoint;
 
 
+template<class DirectorBigIndex>
+EigenXform const * position_delta( tmplSearchPoint<DirectorBigIndex> const & ) { return nullptr; }
+template<class DirectorBigIndex>
+EigenXform const * position_delta( tmplSearchPointWithRots<DirectorBigIndex> const & p ) { return p.position_delta_.get(); }
+template<class DirectorBigIndex>
+EigenXform const * position_delta( tmplRifDockResult<DirectorBigIndex> const & p ) { return p.position_delta_.get(); }
+
+// director->set_scene for a point's index, then the point's position_delta_ if it has one.
+//  Anything that builds a result's actual placement should go through this.
+template <typename AnyPoint>
+bool
+set_scene_for_point( DirectorBase const & director, AnyPoint const & point, int director_resl,
+                     ::scheme::kinematics::SceneBase<EigenXform,uint64_t> & scene ) {
+    if ( ! director->set_scene( point.index, director_resl, scene ) ) return false;
+    if ( EigenXform const * delta = position_delta( point ) ) scene.set_position( 1, *delta * scene.position( 1 ) );
+    return true;
+}
+
+
 
 struct SasaComparator
 {
@@ -183,6 +215,34 @@ struct ScorePer1000SasaComparator
 };
 
 
+// Sorts by score like std::sort would, but only (score, position) keys get
+//  shuffled around; the permutation is then applied in place by following its
+//  cycles, so each point moves about once and no second copy of points is made.
+//  Much less memory traffic than sorting the big result structs directly.
+template <typename AnyPoint>
+void
+sort_by_score_permutation( std::vector<AnyPoint> & points ) {
+    std::vector< std::pair<float,uint32_t> > keys( points.size() );
+    for ( size_t i = 0; i < points.size(); i++ ) keys[i] = std::pair<float,uint32_t>( points[i].score, i );
+    __gnu_parallel::sort( keys.begin(), keys.end() );
+
+    // keys[i].second is where the point that belongs at i is now; set to i once it's there
+    for ( uint32_t start = 0; start < keys.size(); start++ ) {
+        if ( keys[start].second == start ) continue;
+        AnyPoint held = std::move( points[start] );
+        uint32_t dst = start;
+        while ( keys[dst].second != start ) {
+            uint32_t const src = keys[dst].second;
+            points[dst] = std::move( points[src] );
+            keys[dst].second = dst;
+            dst = src;
+        }
+        points[dst] = std::move( held );
+        keys[dst].second = dst;
+    }
+}
+
+
 
 
 struct RifDockData {
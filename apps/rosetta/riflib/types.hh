@@ -16,6 +16,7 @@
 #include <stdint.h>
 #include <Eigen/Geometry>
 #include <scheme/objective/voxel/VoxelArray.hh>
+#include <scheme/objective/voxel/VoxelOccupancy.hh>
 
 namespace devel {
 namespace scheme {
@@ -26,6 +27,8 @@ namespace scheme {
 	using ::scheme::shared_ptr;
 	using ::scheme::make_shared;
 	using ::scheme::enable_shared_from_this;
+	typedef ::scheme::objective::voxel::VoxelOccupancy<float> VoxelOccupancy;
+	typedef shared_ptr<VoxelOccupancy const> VoxelOccupancyCOP;
 
 
 }
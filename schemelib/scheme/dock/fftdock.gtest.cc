@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "scheme/dock/fftdock.hh"
+
+#include <random>
+
+namespace scheme { namespace dock { namespace test_fftdock {
+
+using std::cout;
+using std::endl;
+
+typedef std::complex<double> Cd;
+typedef FFTTranslationScorer<float> Scorer;
+typedef Scorer::Vec3 Vec3;
+
+TEST( fftdock, fft1d_matches_dft ){
+	std::mt19937 rng(123);
+	std::normal_distribution<> rnorm;
+	for( int n = 1; n <= 64; n *= 2 ){
+		std::vector<Cd> x( n ), X( n );
+		for( auto & v : x ) v = Cd( rnorm(rng), rnorm(rng) );
+		for( int k = 0; k < n; ++k ){
+			X[k] = 0;
+			for( int j = 0; j < n; ++j ) X[k] += x[j] * std::polar( 1.0, -2.0*M_PI*j*k/n );
+		}
+		FFTPlan<double> plan( n );
+		std::vector<Cd> y( x );
+		plan.transform( &y[0], false );
+		for( int k = 0; k < n; ++k ) ASSERT_LT( std::abs( y[k] - X[k] ), 1e-9 );
+		plan.transform( &y[0], true );
+		for( int k = 0; k < n; ++k ) ASSERT_LT( std::abs( y[k]/double(n) - x[k] ), 1e-9 );
+	}
+}
+
+TEST( fftdock, correlation_matches_brute_force ){
+	std::mt19937 rng(456);
+	std::uniform_real_distribution<float> runif;
+	int const n = 16;
+	float const resl = 1.0;
+	Scorer scorer( Vec3(0,0,0), resl, n );
+	auto f0 = []( float x, float y, float z ){ return std::sin(x) + std::cos(0.7f*y) * z; };
+	auto f2 = []( float x, float y, float z ){ return x*y - z; };
+	scorer.set_target_channel( 0, f0 );
+	scorer.set_target_channel( 2, f2 );
+	ASSERT_TRUE(  scorer.has_channel(0) );
+	ASSERT_FALSE( scorer.has_channel(1) );
+
+	std::vector<Scorer::BodyAtom> body;
+	for( int i = 0; i < 12; ++i ){
+		body.push_back( std::make_pair( i%3, Vec3( runif(rng)*8-4, runif(rng)*8-4, runif(rng)*8-4 ) ) );
+	}
+	std::vector<float> scores;
+	std::vector<Scorer::Complex> work, accum;
+	scorer.score_translations( body, scores, work, accum );
+
+	int const margin = scorer.max_offset( body );
+	ASSERT_LE( margin, 4 );
+	for( int iz = margin; iz < n-margin; iz += 3 ){
+	for( int iy = margin; iy < n-margin; iy += 2 ){
+	for( int ix = margin; ix < n-margin; ++ix ){
+		float brute = 0;
+		for( auto const & a : body ){
+			if( a.first == 1 ) continue; // no target for channel 1
+			Vec3 p = scorer.grid_point( ix + std::round(a.second[0]), iy + std::round(a.second[1]), iz + std::round(a.second[2]) );
+			brute += a.first == 0 ? f0( p[0], p[1], p[2] ) : f2( p[0], p[1], p[2] );
+		}
+		ASSERT_NEAR( scores[ ix + n*(iy + n*iz) ], brute, 1e-3*( 1.0 + std::abs(brute) ) );
+	}}}
+}
+
+TEST( fftdock, search_finds_planted_pose ){
+	// target: attractive wells where a rotated, translated body fits exactly
+	std::vector<Scorer::BodyAtom> body;
+	body.push_back( std::make_pair( 0, Vec3(  3, 0, 0 ) ) );
+	body.push_back( std::make_pair( 0, Vec3( -2, 2, 0 ) ) );
+	body.push_back( std::make_pair( 0, Vec3(  0,-1, 3 ) ) );
+	body.push_back( std::make_pair( 0, Vec3(  1, 1,-2 ) ) );
+
+	Scorer::Mat3 rot_true;
+	rot_true = Eigen::AngleAxisf( M_PI/2, Vec3(0,0,1) );
+	Vec3 const trans_true( 3, -2, 4 );
+	std::vector<Vec3> wells;
+	for( auto const & a : body ) wells.push_back( rot_true * a.second + trans_true );
+
+	Scorer scorer( Vec3(0,0,0), 1.0, 32 );
+	scorer.set_target_channel( 0, [&]( float x, float y, float z ){
+		float e = 0;
+		for( auto const & w : wells ) e -= std::exp( -( Vec3(x,y,z) - w ).squaredNorm() );
+		return e;
+	});
+
+	std::vector<Scorer::Mat3> rots;
+	for( int i = 0; i < 4; ++i ){
+		Scorer::Mat3 r;
+		r = Eigen::AngleAxisf( i*M_PI/2, Vec3(0,0,1) );
+		rots.push_back( r );
+	}
+	std::vector<Scorer::Hit> hits;
+	scorer.search( rots, body, 3, 2.0, 0.0, hits );
+	ASSERT_GE( hits.size(), 1 );
+	ASSERT_LT( ( hits.front().rotation - rot_true ).norm(), 1e-5 );
+	ASSERT_LT( ( hits.front().translation - trans_true ).norm(), 1e-5 );
+	ASSERT_NEAR( hits.front().score, -4.0, 1e-3 );
+	for( size_t i = 1; i < hits.size(); ++i ) ASSERT_LE( hits[i-1].score, hits[i].score );
+}
+
+}}}
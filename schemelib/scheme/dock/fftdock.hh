@@ -1,11 +1,270 @@
 #ifndef INCLUDED_scheme_dock_fftdock_HH
 #define INCLUDED_scheme_dock_fftdock_HH
 
-#include <fftw3.h>
+#include "scheme/util/assert.hh"
+
+#include <Eigen/Dense>
+
+#include <algorithm>
+#include <complex>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
 
 namespace scheme {
 namespace dock {
 
+///@brief radix-2 complex fft over power of two sizes, unnormalized in both directions
+template< class Float = float >
+struct FFTPlan {
+	typedef std::complex<Float> Complex;
+
+	int n_ = 0;
+	std::vector<Complex> twiddle_; // exp(-2 pi i k / n), k < n/2
+	std::vector<int> bitrev_;
+
+	FFTPlan() {}
+	FFTPlan( int n ) { init( n ); }
+
+	static bool is_pow2( int n ) { return n > 0 && ( n & (n-1) ) == 0; }
+
+	void init( int n ){
+		ALWAYS_ASSERT_MSG( is_pow2(n), "FFTPlan size must be a power of two" );
+		n_ = n;
+		twiddle_.resize( n/2 );
+		for( int k = 0; k < n/2; ++k ){
+			double const ang = -2.0 * M_PI * k / n;
+			twiddle_[k] = Complex( std::cos(ang), std::sin(ang) );
+		}
+		int lg = 0; while( (1<<lg) < n ) ++lg;
+		bitrev_.resize( n );
+		for( int i = 0; i < n; ++i ){
+			int r = 0;
+			for( int b = 0; b < lg; ++b ) if( i & (1<<b) ) r |= 1 << (lg-1-b);
+			bitrev_[i] = r;
+		}
+	}
+
+	void transform( Complex * x, bool inverse ) const {
+		for( int i = 0; i < n_; ++i ) if( i < bitrev_[i] ) std::swap( x[i], x[bitrev_[i]] );
+		for( int len = 2; len <= n_; len <<= 1 ){
+			int const half = len >> 1, step = n_ / len;
+			for( int i = 0; i < n_; i += len ){
+				for( int j = 0; j < half; ++j ){
+					Complex w = twiddle_[ j*step ];
+					if( inverse ) w = std::conj( w );
+					Complex const u = x[i+j];
+					Complex const v = x[i+j+half] * w;
+					x[i+j]      = u + v;
+					x[i+j+half] = u - v;
+				}
+			}
+		}
+	}
+
+	///@brief 3d transform of an n^3 cube stored x fastest
+	void transform3d( std::vector<Complex> & data, bool inverse ) const {
+		int const n = n_;
+		assert( data.size() == (size_t)n*n*n );
+		std::vector<Complex> line( n );
+		for( int i = 0; i < n*n; ++i ) transform( &data[ (size_t)i*n ], inverse );
+		for( int iz = 0; iz < n; ++iz ){
+			for( int ix = 0; ix < n; ++ix ){
+				for( int iy = 0; iy < n; ++iy ) line[iy] = data[ ix + n*( iy + (size_t)n*iz ) ];
+				transform( &line[0], inverse );
+				for( int iy = 0; iy < n; ++iy ) data[ ix + n*( iy + (size_t)n*iz ) ] = line[iy];
+			}
+		}
+		for( int iy = 0; iy < n; ++iy ){
+			for( int ix = 0; ix < n; ++ix ){
+				for( int iz = 0; iz < n; ++iz ) line[iz] = data[ ix + n*( iy + (size_t)n*iz ) ];
+				transform( &line[0], inverse );
+				for( int iz = 0; iz < n; ++iz ) data[ ix + n*( iy + (size_t)n*iz ) ] = line[iz];
+			}
+		}
+	}
+};
+
+template< class Float >
+struct FFTDockHit {
+	Float score;
+	Eigen::Matrix<Float,3,3> rotation;
+	Eigen::Matrix<Float,3,1> translation;
+	bool operator<( FFTDockHit const & o ) const { return score < o.score; }
+};
+
+///@brief scores every translation of a rigid body against a target at once by fft correlation
+///@detail the target is sampled on an n^3 grid of spacing resl as one real grid per channel
+///        (e.g. per atom type). body atoms are snapped to grid offsets from the body origin, so
+///        score(t) = sum over atoms a of target[ channel(a) ]( t + offset(a) ), for all t, costs
+///        one forward fft per channel present in the body plus one inverse fft. lower is better.
+///        correlation is cyclic: only translations that keep the whole body inside the grid are
+///        reported, so the grid should be padded by the body radius.
+template< class Float = float >
+struct FFTTranslationScorer {
+	typedef std::complex<Float> Complex;
+	typedef Eigen::Matrix<Float,3,1> Vec3;
+	typedef Eigen::Matrix<Float,3,3> Mat3;
+	typedef std::pair<int,Vec3> BodyAtom; // channel, position relative to body origin
+	typedef FFTDockHit<Float> Hit;
+
+	int n_ = 0;
+	Float resl_ = 1.0;
+	Vec3 lb_;
+	FFTPlan<Float> plan_;
+	std::vector< std::vector<Complex> > target_ft_; // per channel, empty if unset
+
+	FFTTranslationScorer() {}
+	FFTTranslationScorer( Vec3 const & center, Float resl, int n ) { init( center, resl, n ); }
+
+	void init( Vec3 const & center, Float resl, int n ){
+		n_ = n;
+		resl_ = resl;
+		lb_ = center - Vec3( resl*(n/2), resl*(n/2), resl*(n/2) );
+		plan_.init( n );
+		target_ft_.clear();
+	}
+
+	size_t grid_size() const { return (size_t)n_*n_*n_; }
+	Vec3 grid_point( int ix, int iy, int iz ) const { return lb_ + resl_ * Vec3( ix, iy, iz ); }
+
+	///@brief sample func(x,y,z) at the grid points, values clamped to max_value
+	template< class Func >
+	void set_target_channel( int ichan, Func const & func, Float max_value = std::numeric_limits<Float>::max() ){
+		if( (int)target_ft_.size() <= ichan ) target_ft_.resize( ichan+1 );
+		std::vector<Complex> & ft = target_ft_[ichan];
+		ft.assign( grid_size(), Complex(0) );
+		for( int iz = 0; iz < n_; ++iz ){
+		for( int iy = 0; iy < n_; ++iy ){
+		for( int ix = 0; ix < n_; ++ix ){
+			Vec3 const p = grid_point( ix, iy, iz );
+			ft[ ix + n_*( iy + (size_t)n_*iz ) ] = Complex( std::min( max_value, (Float)func( p[0], p[1], p[2] ) ) );
+		}}}
+		plan_.transform3d( ft, false );
+	}
+	bool has_channel( int ichan ) const { return ichan < (int)target_ft_.size() && target_ft_[ichan].size(); }
+
+	///@brief largest |offset| in grid units over the body atoms
+	int max_offset( std::vector<BodyAtom> const & body ) const {
+		int m = 0;
+		for( auto const & a : body )
+			for( int k = 0; k < 3; ++k )
+				m = std::max( m, (int)std::abs( std::round( a.second[k] / resl_ ) ) );
+		return m;
+	}
+
+	///@brief scores[ix+n*(iy+n*iz)] is the score with the body origin at grid_point(ix,iy,iz)
+	void score_translations(
+		std::vector<BodyAtom> const & body,
+		std::vector<Float> & scores,
+		std::vector<Complex> & work,
+		std::vector<Complex> & accum
+	) const {
+		accum.assign( grid_size(), Complex(0) );
+		for( int ichan = 0; ichan < (int)target_ft_.size(); ++ichan ){
+			if( !has_channel(ichan) ) continue;
+			work.assign( grid_size(), Complex(0) );
+			bool any = false;
+			for( auto const & a : body ){
+				if( a.first != ichan ) continue;
+				int idx[3];
+				for( int k = 0; k < 3; ++k ){
+					idx[k] = (int)std::round( a.second[k] / resl_ ) % n_;
+					if( idx[k] < 0 ) idx[k] += n_;
+				}
+				work[ idx[0] + n_*( idx[1] + (size_t)n_*idx[2] ) ] += Complex(1);
+				any = true;
+			}
+			if( !any ) continue;
+			plan_.transform3d( work, false );
+			std::vector<Complex> const & tft = target_ft_[ichan];
+			for( size_t i = 0; i < grid_size(); ++i ) accum[i] += std::conj( work[i] ) * tft[i];
+		}
+		plan_.transform3d( accum, true );
+		scores.resize( grid_size() );
+		Float const norm = 1.0 / grid_size();
+		for( size_t i = 0; i < grid_size(); ++i ) scores[i] = accum[i].real() * norm;
+	}
+
+	///@brief best translations with score below thresh, at least min_sep apart
+	void find_peaks(
+		std::vector<Float> const & scores,
+		int margin,
+		int npeaks,
+		Float min_sep,
+		Float thresh,
+		std::vector< std::pair<Float,Vec3> > & peaks
+	) const {
+		std::vector< std::pair<Float,size_t> > cand;
+		for( int iz = margin; iz < n_-margin; ++iz ){
+		for( int iy = margin; iy < n_-margin; ++iy ){
+		for( int ix = margin; ix < n_-margin; ++ix ){
+			size_t const i = ix + n_*( iy + (size_t)n_*iz );
+			if( scores[i] < thresh ) cand.push_back( std::make_pair( scores[i], i ) );
+		}}}
+		std::sort( cand.begin(), cand.end() );
+		peaks.clear();
+		Float const min_sep2 = min_sep * min_sep;
+		for( auto const & c : cand ){
+			if( (int)peaks.size() >= npeaks ) break;
+			Vec3 const p = grid_point( c.second % n_, c.second / n_ % n_, c.second / n_ / n_ );
+			bool too_close = false;
+			for( auto const & q : peaks ) too_close |= ( q.second - p ).squaredNorm() < min_sep2;
+			if( !too_close ) peaks.push_back( std::make_pair( c.first, p ) );
+		}
+	}
+
+	///@brief fft search over the given body orientations, returns the best npeaks_per_ori
+	///       translations for each one, sorted best first
+	void search(
+		std::vector<Mat3> const & rotations,
+		std::vector<BodyAtom> const & body,
+		int npeaks_per_ori,
+		Float min_sep,
+		Float thresh,
+		std::vector<Hit> & hits
+	) const {
+		std::vector< std::vector<Hit> > hits_per_ori( rotations.size() );
+		std::exception_ptr exception = nullptr;
+		#ifdef USE_OPENMP
+		#pragma omp parallel for schedule(dynamic,1)
+		#endif
+		for( int iori = 0; iori < (int)rotations.size(); ++iori ){
+			if( exception ) continue;
+			try {
+				std::vector<BodyAtom> rbody( body );
+				for( auto & a : rbody ) a.second = rotations[iori] * a.second;
+				std::vector<Float> scores;
+				std::vector<Complex> work, accum;
+				score_translations( rbody, scores, work, accum );
+				std::vector< std::pair<Float,Vec3> > peaks;
+				find_peaks( scores, max_offset( rbody ), npeaks_per_ori, min_sep, thresh, peaks );
+				for( auto const & p : peaks ){
+					Hit h;
+					h.score = p.first;
+					h.rotation = rotations[iori];
+					h.translation = p.second;
+					hits_per_ori[iori].push_back( h );
+				}
+			} catch( ... ) {
+				#ifdef USE_OPENMP
+				#pragma omp critical
+				#endif
+				exception = std::current_exception();
+			}
+		}
+		if( exception ) std::rethrow_exception( exception );
+		hits.clear();
+		for( auto const & h : hits_per_ori ) hits.insert( hits.end(), h.begin(), h.end() );
+		std::sort( hits.begin(), hits.end() );
+	}
+
+};
 
 }
 }
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include "scheme/io/ResultArchive.hh"
+
+#include <Eigen/Geometry>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace scheme { namespace io { namespace test_result_archive {
+
+ResultRecord make_record( int i ){
+	ResultRecord r;
+	r.tag = "scaff_" + std::to_string( i );
+	Eigen::Transform<float,3,Eigen::AffineCompact> x( Eigen::AngleAxisf( 0.1*i, Eigen::Vector3f(1,2,3).normalized() ) );
+	x.translation() = Eigen::Vector3f( i, -i, 0.5*i );
+	r.set_xform( x );
+	r.scores.push_back( std::make_pair( "score", -1.5f*i ) );
+	r.scores.push_back( std::make_pair( "sasa", 100.0f + i ) );
+	for( int j = 0; j < i % 7; ++j ) r.rotamers.push_back( std::make_pair( j+1, 10*i+j ) );
+	return r;
+}
+
+void check_equal( ResultRecord const & a, ResultRecord const & b ){
+	ASSERT_EQ( a.tag, b.tag );
+	for( int k = 0; k < 12; ++k ) ASSERT_EQ( a.xform[k], b.xform[k] );
+	ASSERT_EQ( a.scores, b.scores );
+	ASSERT_EQ( a.rotamers, b.rotamers );
+}
+
+TEST( ResultArchive, round_trip_and_append ){
+	std::string const fname = "ResultArchive_test.dat";
+	std::remove( fname.c_str() );
+	{
+		ResultArchiveWriter w;
+		ASSERT_TRUE( w.open( fname ) );
+		std::vector<std::thread> threads;
+		for( int t = 0; t < 4; ++t ) threads.push_back( std::thread( [&w,t]{
+			for( int i = t; i < 100; i += 4 ) w.append( make_record( i ) );
+		}));
+		for( auto & t : threads ) t.join();
+	}
+	{ // a second run appends to the same file
+		ResultArchiveWriter w;
+		ASSERT_TRUE( w.open( fname ) );
+		ASSERT_TRUE( w.append( make_record( 100 ) ) );
+	}
+
+	ResultArchiveReader r;
+	ASSERT_TRUE( r.open( fname ) );
+	ASSERT_FALSE( r.truncated() );
+	ASSERT_EQ( r.size(), 101 );
+	for( int i = 0; i <= 100; ++i ){
+		ResultRecord rec;
+		ASSERT_TRUE( r.find( "scaff_" + std::to_string( i ), rec ) );
+		check_equal( rec, make_record( i ) );
+		ASSERT_EQ( rec.score( "sasa" ), 100.0f + i );
+		ASSERT_EQ( rec.score( "nope", 7.0f ), 7.0f );
+	}
+	ResultRecord last;
+	ASSERT_TRUE( r.get( 100, last ) );
+	ASSERT_EQ( last.tag, "scaff_100" );
+	ASSERT_FALSE( r.get( 101, last ) );
+
+	// a crash mid-write leaves a partial record at the end, which is skipped
+	{
+		std::string buf;
+		ResultArchiveWriter::serialize( make_record( 101 ), buf );
+		std::ofstream out( fname.c_str(), std::ios::binary | std::ios::app );
+		out.write( buf.data(), buf.size() / 2 );
+	}
+	ASSERT_TRUE( r.open( fname ) );
+	ASSERT_TRUE( r.truncated() );
+	ASSERT_EQ( r.size(), 101 );
+
+	std::remove( fname.c_str() );
+	ASSERT_FALSE( r.open( fname ) );
+}
+
+TEST( ResultArchive, rejects_corrupt_counts ){
+	std::string const fname = "ResultArchive_corrupt_test.dat";
+	ResultRecord const rec = make_record( 3 );
+	size_t const nscores_at = 16 + 4 + rec.tag.size() + sizeof(rec.xform);
+	size_t const nrots_at = nscores_at + 4 + ( 4 + 5 + 4 ) + ( 4 + 4 + 4 ); // "score", "sasa"
+	for( size_t at : { nscores_at, nrots_at } ){
+		std::string buf;
+		ResultArchiveWriter::serialize( rec, buf );
+		uint32_t const huge = 0xffffffff;
+		std::memcpy( &buf[at], &huge, sizeof(huge) );
+		{
+			std::ofstream out( fname.c_str(), std::ios::binary );
+			out.write( buf.data(), buf.size() );
+		}
+		ResultArchiveReader r;
+		ASSERT_FALSE( r.open( fname ) ); // not bad_alloc
+	}
+	std::remove( fname.c_str() );
+}
+
+}}}
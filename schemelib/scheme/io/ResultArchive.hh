@@ -0,0 +1,256 @@
+#ifndef INCLUDED_io_ResultArchive_HH
+#define INCLUDED_io_ResultArchive_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SCHEME_RESULT_ARCHIVE_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace scheme { namespace io {
+
+///@brief one docking result: a tag, a rigid body position, named scores and the placed rotamers
+struct ResultRecord {
+	std::string tag;
+	float xform[12] = { 1,0,0, 0,1,0, 0,0,1, 0,0,0 }; // row major rotation, then translation
+	std::vector< std::pair<std::string,float> > scores;
+	std::vector< std::pair<int32_t,int32_t> > rotamers; // seqpos, irot
+
+	template< class Xform >
+	void set_xform( Xform const & x ){
+		for( int i = 0; i < 3; ++i ){
+			for( int j = 0; j < 3; ++j ) xform[3*i+j] = x.linear()(i,j);
+			xform[9+i] = x.translation()[i];
+		}
+	}
+
+	float score( std::string const & name, float missing = 0 ) const {
+		for( auto const & s : scores ) if( s.first == name ) return s.second;
+		return missing;
+	}
+};
+
+///@brief append-only binary file of ResultRecords, one per run instead of a file per result
+///@detail each record is a 16 byte header (magic, version, payload size) followed by the payload.
+///        a record is serialized up front and written with a single write(2) to a file opened with
+///        O_APPEND, so records from several threads or processes land whole, one after another.
+///        (without posix this falls back to stdio, and then only one process may write a file.)
+///        readers index the file by hopping from header to header and stop at a truncated tail
+struct ResultArchiveWriter {
+
+	static uint32_t const Magic = 0x544c5352; // "RSLT"
+	static uint32_t const Version = 1;
+
+	ResultArchiveWriter() {}
+	ResultArchiveWriter( ResultArchiveWriter const & ) = delete;
+	ResultArchiveWriter & operator=( ResultArchiveWriter const & ) = delete;
+	~ResultArchiveWriter() { close(); }
+
+	#ifdef SCHEME_RESULT_ARCHIVE_POSIX
+
+		bool open( std::string const & fname ){
+			close();
+			fd_ = ::open( fname.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644 );
+			return fd_ >= 0;
+		}
+
+		bool is_open() const { return fd_ >= 0; }
+
+		void close(){
+			if( fd_ >= 0 ) ::close( fd_ );
+			fd_ = -1;
+		}
+
+		///@brief thread safe. the record goes out in one write; only a short write (disk full)
+		///       finishes it with a second one, which readers then see as a truncated tail at worst
+		bool append( ResultRecord const & r ){
+			std::string buf;
+			serialize( r, buf );
+			std::lock_guard<std::mutex> lock( mutex_ );
+			if( fd_ < 0 ) return false;
+			size_t done = 0;
+			while( done < buf.size() ){
+				ssize_t const n = ::write( fd_, buf.data() + done, buf.size() - done );
+				if( n < 0 && errno == EINTR ) continue;
+				if( n <= 0 ) return false;
+				done += n;
+			}
+			return true;
+		}
+
+	#else
+
+		bool open( std::string const & fname ){
+			close();
+			file_ = std::fopen( fname.c_str(), "ab" );
+			return file_ != nullptr;
+		}
+
+		bool is_open() const { return file_ != nullptr; }
+
+		void close(){
+			if( file_ ) std::fclose( file_ );
+			file_ = nullptr;
+		}
+
+		///@brief thread safe, but not safe against other processes appending to the same file
+		bool append( ResultRecord const & r ){
+			std::string buf;
+			serialize( r, buf );
+			std::lock_guard<std::mutex> lock( mutex_ );
+			if( !file_ ) return false;
+			return std::fwrite( buf.data(), 1, buf.size(), file_ ) == buf.size() && std::fflush( file_ ) == 0;
+		}
+
+	#endif
+
+	static void serialize( ResultRecord const & r, std::string & buf ){
+		buf.assign( 16, '\0' );
+		put_str( buf, r.tag );
+		buf.append( (char const*)r.xform, sizeof(r.xform) );
+		put<uint32_t>( buf, r.scores.size() );
+		for( auto const & s : r.scores ){
+			put_str( buf, s.first );
+			put<float>( buf, s.second );
+		}
+		put<uint32_t>( buf, r.rotamers.size() );
+		for( auto const & rot : r.rotamers ){
+			put<int32_t>( buf, rot.first );
+			put<int32_t>( buf, rot.second );
+		}
+		uint32_t const hvals[2] = { Magic, Version };
+		uint64_t const payload = buf.size() - 16;
+		std::memcpy( &buf[0], hvals, sizeof(hvals) );
+		std::memcpy( &buf[8], &payload, sizeof(payload) );
+	}
+
+private:
+	template< class T >
+	static void put( std::string & buf, T v ){ buf.append( (char const*)&v, sizeof(T) ); }
+	static void put_str( std::string & buf, std::string const & s ){
+		put<uint32_t>( buf, s.size() );
+		buf.append( s );
+	}
+
+	#ifdef SCHEME_RESULT_ARCHIVE_POSIX
+		int fd_ = -1;
+	#else
+		std::FILE * file_ = nullptr;
+	#endif
+	std::mutex mutex_;
+};
+
+///@brief random access to the records of a ResultArchiveWriter file
+struct ResultArchiveReader {
+
+	std::vector<uint64_t> offsets_; // payload start of each record
+	std::vector<uint64_t> sizes_;
+	std::map< std::string, size_t > tag_index_; // last record with each tag
+	bool truncated_ = false;
+
+	size_t size() const { return offsets_.size(); }
+	bool truncated() const { return truncated_; }
+
+	///@brief false if the file can't be read or isn't an archive
+	bool open( std::string const & fname ){
+		offsets_.clear();
+		sizes_.clear();
+		tag_index_.clear();
+		truncated_ = false;
+		in_.close();
+		in_.clear();
+		in_.open( fname.c_str(), std::ios::binary );
+		if( !in_.good() ) return false;
+		in_.seekg( 0, std::ios::end );
+		uint64_t const nbytes = in_.tellg();
+		uint64_t pos = 0;
+		while( pos < nbytes ){
+			char header[16];
+			if( nbytes - pos < 16 ){ truncated_ = true; break; }
+			in_.seekg( pos );
+			in_.read( header, 16 );
+			uint32_t hvals[2];
+			uint64_t payload;
+			std::memcpy( hvals, header, sizeof(hvals) );
+			std::memcpy( &payload, header+8, sizeof(payload) );
+			if( hvals[0] != ResultArchiveWriter::Magic || hvals[1] != ResultArchiveWriter::Version ){
+				if( pos == 0 ) return false;
+				truncated_ = true;
+				break;
+			}
+			if( payload > nbytes - pos - 16 ){ truncated_ = true; break; }
+			offsets_.push_back( pos + 16 );
+			sizes_.push_back( payload );
+			pos += 16 + payload;
+		}
+		in_.clear();
+		for( size_t i = 0; i < size(); ++i ){
+			ResultRecord r;
+			if( !get( i, r ) ) return false;
+			tag_index_[ r.tag ] = i;
+		}
+		return true;
+	}
+
+	bool get( size_t i, ResultRecord & r ){
+		if( i >= size() ) return false;
+		std::string buf( sizes_[i], '\0' );
+		in_.seekg( offsets_[i] );
+		in_.read( &buf[0], buf.size() );
+		if( !in_.good() ) return false;
+		size_t p = 0;
+		uint32_t n;
+		if( !get_str( buf, p, r.tag ) ) return false;
+		if( !get_raw( buf, p, r.xform, sizeof(r.xform) ) ) return false;
+		// counts come from the file, check them against what's left before allocating anything
+		if( !get_raw( buf, p, &n, sizeof(n) ) || n > ( buf.size() - p ) / ( sizeof(uint32_t) + sizeof(float) ) ) return false;
+		r.scores.resize( n );
+		for( auto & s : r.scores ){
+			if( !get_str( buf, p, s.first ) || !get_raw( buf, p, &s.second, sizeof(float) ) ) return false;
+		}
+		if( !get_raw( buf, p, &n, sizeof(n) ) || n > ( buf.size() - p ) / ( 2 * sizeof(int32_t) ) ) return false;
+		r.rotamers.resize( n );
+		for( auto & rot : r.rotamers ){
+			if( !get_raw( buf, p, &rot.first, sizeof(int32_t) ) || !get_raw( buf, p, &rot.second, sizeof(int32_t) ) ) return false;
+		}
+		return p == buf.size();
+	}
+
+	///@brief false if no record has this tag
+	bool find( std::string const & tag, ResultRecord & r ){
+		auto i = tag_index_.find( tag );
+		return i != tag_index_.end() && get( i->second, r );
+	}
+
+private:
+	static bool get_raw( std::string const & buf, size_t & p, void * dst, size_t n ){
+		if( n > buf.size() - p ) return false;
+		std::memcpy( dst, buf.data() + p, n );
+		p += n;
+		return true;
+	}
+	static bool get_str( std::string const & buf, size_t & p, std::string & s ){
+		uint32_t n;
+		if( !get_raw( buf, p, &n, sizeof(n) ) || n > buf.size() - p ) return false;
+		s.assign( buf.data() + p, n );
+		p += n;
+		return true;
+	}
+
+	std::ifstream in_;
+};
+
+}}
+
+#endif
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include "scheme/io/SilentFileIndex.hh"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace scheme { namespace io { namespace test_silent_index {
+
+std::string const silent =
+	"SEQUENCE: ACDE\n"
+	"SCORE:     score description\n"
+	"REMARK BINARY SILENTFILE\n"
+	"SCORE:     -1.0 first\n"
+	"FOLD_TREE  EDGE 1 4 -1  first\n"
+	"AAAA first\n"
+	"SCORE:     -2.0 second_one\n"
+	"BBBB second_one\n"
+	"SEQUENCE: ACDE\n" // a second file cat'ed on
+	"SCORE:     score description\n"
+	"SCORE:     -3.0 third  \n"
+	"CCCC third";
+
+TEST( SilentFileIndex, build_and_read ){
+	std::istringstream in( silent );
+	SilentFileIndex idx;
+	ASSERT_TRUE( idx.build( in ) );
+	ASSERT_EQ( idx.size(), 3 );
+	ASSERT_EQ( idx.header, "SEQUENCE: ACDE\nSCORE:     score description\nREMARK BINARY SILENTFILE\n" );
+	ASSERT_EQ( idx.entries[0].tag, "first" );
+	ASSERT_EQ( idx.entries[1].tag, "second_one" );
+	ASSERT_EQ( idx.entries[2].tag, "third" );
+
+	std::istringstream in2( silent );
+	ASSERT_EQ( idx.read_structure( in2, 0 ), idx.header + "SCORE:     -1.0 first\nFOLD_TREE  EDGE 1 4 -1  first\nAAAA first\n" );
+	ASSERT_EQ( idx.read_structure( in2, 2 ), idx.header + "SCORE:     -3.0 third  \nCCCC third\n" );
+	ASSERT_EQ( idx.read_structure( in2, 1 ), idx.header + "SCORE:     -2.0 second_one\nBBBB second_one\n" );
+
+	std::istringstream empty( "SEQUENCE: A\nSCORE: score description\n" );
+	ASSERT_FALSE( idx.build( empty ) );
+}
+
+TEST( SilentFileIndex, cache ){
+	std::string const fname = "test_silent_file_index.silent", cache = fname + ".idx";
+	std::remove( cache.c_str() );
+	{
+		std::ofstream out( fname );
+		out << silent;
+	}
+	SilentFileIndex idx;
+	bool from_cache = true;
+	ASSERT_TRUE( idx.load_or_build( fname, cache, &from_cache ) );
+	ASSERT_FALSE( from_cache );
+
+	SilentFileIndex idx2;
+	ASSERT_TRUE( idx2.load_or_build( fname, cache, &from_cache ) );
+	ASSERT_TRUE( from_cache );
+	ASSERT_EQ( idx2.size(), 3 );
+	ASSERT_EQ( idx2.header, idx.header );
+	std::ifstream in( fname );
+	ASSERT_EQ( idx2.read_structure( in, 1 ), idx.header + "SCORE:     -2.0 second_one\nBBBB second_one\n" );
+
+	// a changed file is reindexed
+	{
+		std::ofstream out( fname, std::ios::app );
+		out << "\nSCORE: -4.0 fourth\nDDDD fourth\n";
+	}
+	SilentFileIndex idx3;
+	ASSERT_TRUE( idx3.load_or_build( fname, cache, &from_cache ) );
+	ASSERT_FALSE( from_cache );
+	ASSERT_EQ( idx3.size(), 4 );
+
+	// a damaged cache is rebuilt, not trusted or thrown on
+	for( int damage = 0; damage < 3; ++damage ){
+		std::string bytes;
+		{
+			std::ifstream cin( cache, std::ios::binary );
+			bytes.assign( std::istreambuf_iterator<char>( cin ), std::istreambuf_iterator<char>() );
+		}
+		ASSERT_GT( bytes.size(), 40u );
+		uint64_t const huge = ~uint64_t(0) >> 1;
+		if( damage == 0 ) std::memcpy( &bytes[24], &huge, 8 ); // header length
+		if( damage == 1 ) std::memcpy( &bytes[ 32 + idx3.header.size() ], &huge, 8 ); // entry count
+		if( damage == 2 ) bytes.resize( bytes.size() - 5 ); // cut short
+		{
+			std::ofstream cout( cache, std::ios::binary );
+			cout.write( bytes.data(), bytes.size() );
+		}
+		SilentFileIndex idx4;
+		ASSERT_TRUE( idx4.load_or_build( fname, cache, &from_cache ) );
+		ASSERT_FALSE( from_cache );
+		ASSERT_EQ( idx4.size(), 4 );
+		ASSERT_EQ( idx4.entries[3].tag, "fourth" );
+	}
+
+	ASSERT_FALSE( idx3.load_or_build( "no_such_file.silent", cache ) );
+	std::remove( fname.c_str() );
+	std::remove( cache.c_str() );
+}
+
+}}}
@@ -0,0 +1,219 @@
+#ifndef INCLUDED_io_SilentFileIndex_HH
+#define INCLUDED_io_SilentFileIndex_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "scheme/util/tmp_name.hh"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SCHEME_HAVE_STAT
+#include <sys/stat.h>
+#endif
+
+namespace scheme { namespace io {
+
+///@brief byte offsets of the structures in a rosetta silent file, so single structures can be read
+///       without parsing everything before them
+///@detail a structure starts at a "SCORE:" line (other than the "SCORE: ... description" column header)
+///        and runs until the next structure or header line; its tag is the last word of that line.
+///        header holds the SEQUENCE/SCORE/REMARK lines before the first structure. repeated headers
+///        from concatenated files are skipped. header + one record is itself a valid silent file
+struct SilentFileIndex {
+
+	static uint32_t const Magic = 0x58444953; // "SIDX"
+	static uint32_t const Version = 1;
+
+	struct Entry {
+		std::string tag;
+		uint64_t offset = 0;
+		uint64_t length = 0;
+	};
+
+	std::string header;
+	std::vector<Entry> entries;
+	uint64_t file_size = 0; // of the indexed file, to tell when a cached index is stale
+	int64_t file_mtime = 0;
+
+	size_t size() const { return entries.size(); }
+
+	static bool is_header_line( std::string const & line, bool & is_structure_start ){
+		is_structure_start = false;
+		if( line.compare( 0, 9, "SEQUENCE:" ) == 0 ) return true;
+		if( line.compare( 0, 6, "SCORE:" ) != 0 ) return false;
+		std::string last = last_word( line );
+		if( last == "description" ) return true;
+		is_structure_start = true;
+		return false;
+	}
+
+	static std::string last_word( std::string const & line ){
+		size_t end = line.find_last_not_of( " \t\r" );
+		if( end == std::string::npos ) return "";
+		size_t begin = line.find_last_of( " \t", end );
+		begin = begin == std::string::npos ? 0 : begin + 1;
+		return line.substr( begin, end + 1 - begin );
+	}
+
+	///@brief scans a whole silent file; false if it holds no structures
+	bool build( std::istream & in ){
+		header.clear();
+		entries.clear();
+		std::string line;
+		uint64_t pos = 0;
+		bool in_record = false;
+		while( std::getline( in, line ) ){
+			uint64_t const line_start = pos;
+			pos += line.size() + ( in.eof() ? 0 : 1 );
+			bool starts_structure;
+			if( is_header_line( line, starts_structure ) ){
+				if( entries.empty() ) header += line + "\n";
+				in_record = false;
+			} else if( starts_structure ){
+				Entry e;
+				e.tag = last_word( line );
+				e.offset = line_start;
+				entries.push_back( e );
+				in_record = true;
+			} else if( !in_record && entries.empty() ){
+				header += line + "\n"; // REMARKs and the like
+			}
+			if( in_record ) entries.back().length = pos - entries.back().offset;
+		}
+		return !entries.empty();
+	}
+
+	///@brief header + structure i, ready to hand to a silent file parser. in must be the indexed file
+	std::string read_structure( std::istream & in, size_t i ) const {
+		Entry const & e = entries.at( i );
+		std::string text( header );
+		text.resize( header.size() + e.length );
+		in.clear();
+		in.seekg( e.offset );
+		in.read( &text[ header.size() ], e.length );
+		if( (uint64_t)in.gcount() != e.length ) text.resize( header.size() + in.gcount() );
+		if( text.empty() || text.back() != '\n' ) text += '\n';
+		return text;
+	}
+
+	void save( std::ostream & out ) const {
+		write_pod( out, uint32_t( Magic ) );
+		write_pod( out, uint32_t( Version ) );
+		write_pod( out, file_size );
+		write_pod( out, file_mtime );
+		write_string( out, header );
+		write_pod( out, (uint64_t)entries.size() );
+		for( Entry const & e : entries ){
+			write_string( out, e.tag );
+			write_pod( out, e.offset );
+			write_pod( out, e.length );
+		}
+	}
+
+	bool load( std::istream & in ){
+		uint32_t magic = 0, version = 0;
+		uint64_t n = 0;
+		if( !read_pod( in, magic ) || magic != Magic ) return false;
+		if( !read_pod( in, version ) || version != Version ) return false;
+		if( !read_pod( in, file_size ) || !read_pod( in, file_mtime ) || !read_string( in, header ) ) return false;
+		// n comes from a file that may be damaged or not an index at all; every entry takes at least
+		// 24 bytes, so a count the rest of the file can't hold is rejected before anything is allocated
+		if( !read_pod( in, n ) || n > bytes_left( in ) / 24 ) return false;
+		entries.clear();
+		entries.reserve( n );
+		for( uint64_t i = 0; i < n; ++i ){
+			Entry e;
+			if( !read_string( in, e.tag ) || !read_pod( in, e.offset ) || !read_pod( in, e.length ) ) return false;
+			entries.push_back( e );
+		}
+		return true;
+	}
+
+	///@brief size and modification time of fname, false if it can't be stat'd
+	static bool file_stamp( std::string const & fname, uint64_t & size, int64_t & mtime ){
+		#ifdef SCHEME_HAVE_STAT
+			struct stat st;
+			if( stat( fname.c_str(), &st ) != 0 ) return false;
+			size = st.st_size;
+			mtime = st.st_mtime;
+			return true;
+		#else
+			std::ifstream in( fname, std::ios::binary | std::ios::ate );
+			if( !in.good() ) return false;
+			size = in.tellg();
+			mtime = 0;
+			return true;
+		#endif
+	}
+
+	///@brief uses the index cached in cache_fname if it was made for fname as it is now, otherwise
+	///       indexes fname and (if possible) writes the cache. false if fname can't be read or is empty.
+	///       the cache is written to a temp file and renamed into place, so jobs sharing a scaffold
+	///       library never read a partly written index
+	bool load_or_build( std::string const & fname, std::string const & cache_fname, bool * from_cache = nullptr ){
+		if( from_cache ) *from_cache = false;
+		uint64_t size;
+		int64_t mtime;
+		if( !file_stamp( fname, size, mtime ) ) return false;
+		{
+			std::ifstream in( cache_fname, std::ios::binary );
+			if( in.good() && load( in ) && file_size == size && file_mtime == mtime && !entries.empty() ){
+				if( from_cache ) *from_cache = true;
+				return true;
+			}
+		}
+		std::ifstream in( fname, std::ios::binary );
+		if( !in.good() || !build( in ) ) return false;
+		file_size = size;
+		file_mtime = mtime;
+		// an unwritable directory or a failed write only costs a rescan next time
+		std::string const tmpname = util::unique_tmp_name( cache_fname );
+		{
+			std::ofstream out( tmpname, std::ios::binary );
+			if( !out.good() ) return true;
+			save( out );
+			out.close();
+			if( !out.good() ){ std::remove( tmpname.c_str() ); return true; }
+		}
+		if( std::rename( tmpname.c_str(), cache_fname.c_str() ) != 0 ) std::remove( tmpname.c_str() );
+		return true;
+	}
+
+private:
+	template< class T > static void write_pod( std::ostream & out, T const & t ){
+		out.write( (char const*)&t, sizeof(T) );
+	}
+	template< class T > static bool read_pod( std::istream & in, T & t ){
+		in.read( (char*)&t, sizeof(T) );
+		return in.good();
+	}
+	static void write_string( std::ostream & out, std::string const & s ){
+		write_pod( out, (uint64_t)s.size() );
+		out.write( s.data(), s.size() );
+	}
+	///@brief what's left of a seekable stream, as a bound on sizes read from it
+	static uint64_t bytes_left( std::istream & in ){
+		std::streampos const pos = in.tellg();
+		if( pos == std::streampos(-1) ) return uint64_t(1) << 32;
+		in.seekg( 0, std::ios::end );
+		std::streampos const end = in.tellg();
+		in.seekg( pos );
+		return end > pos ? uint64_t( end - pos ) : 0;
+	}
+	static bool read_string( std::istream & in, std::string & s ){
+		uint64_t n;
+		if( !read_pod( in, n ) || n > bytes_left( in ) ) return false;
+		s.resize( n );
+		in.read( &s[0], n );
+		return n == 0 || in.good();
+	}
+};
+
+}}
+
+#endif
@@ -25,6 +25,10 @@
 	directly setting scene from NEST without boost::any or virtual func calls or multinest:
 	set_scene rate: 1.86553e+07 / sec [       OK ] Director.basic_test (37 ms)
 
+	NestDirector over an OriTransMap NEST can use precomputed rotation tables, see
+	NestDirector::init_ori_cache. CompositeDirector and Scene::replace_body avoid
+	refcount traffic / redundant work when the scaffold doesn't change between samples.
+
 
 */
 
@@ -113,6 +117,10 @@ struct NestDirector
 
 	Nest const & nest() const { return nest_; }
 
+	///@brief precompute per-resolution orientation tables if the Nest's param map supports them
+	///@return number of resolutions cached
+	int init_ori_cache( int max_resl, size_t max_bytes ) { return nest_.init_ori_cache( max_resl, max_bytes ); }
+
 	virtual
 	bool
 	set_scene(
@@ -230,7 +238,8 @@ struct CompositeDirector
 		Scene & scene
 	) const override {
 
-		for ( shared_ptr<Base> director : directors_ ) {
+		// by reference, copying the shared_ptr costs two atomic ops per director per sample
+		for ( shared_ptr<Base> const & director : directors_ ) {
 			bool success = director->set_scene( i, resl, scene );
 			if ( !success ) return false;
 		}
@@ -239,7 +248,7 @@ struct CompositeDirector
 	}
 
 	virtual BigIndex size(int resl, BigIndex sizes) const override {
-		for ( shared_ptr<Base> director : directors_ ) {
+		for ( shared_ptr<Base> const & director : directors_ ) {
 			sizes = director->size(resl, sizes);
 		}
 		return sizes;
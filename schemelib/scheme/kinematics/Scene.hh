@@ -434,6 +434,8 @@ namespace impl {
 			this->update_symmetry( (Index)bodies_.size() );
 		}
 		virtual void replace_body( Index ib, shared_ptr<ConformationBase const> cb) {
+			// ScaffoldDirector calls this for every sample, usually with the scaffold already in place
+			if( static_cast<ConformationBase const*>( bodies_.at(ib).conformation_ptr().get() ) == cb.get() ) return;
 			replace_body(ib, std::dynamic_pointer_cast<ConformationConst>(cb));
 		}
 		// virtual void replace_body( Index ib, boost::any & a) {
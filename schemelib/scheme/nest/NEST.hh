@@ -206,6 +206,10 @@ namespace nest {
 
 		SCHEME_MEMBER_TYPE_DEFAULT_TEMPLATE(Scalar,double)
 
+		////////////////// NEST::set_value will hand undilated indices straight to the parameter map
+		////////////////// iff it has an indices_to_value function (can skip the params round trip)
+		SCHEME_HAS_CONST_MEMBER_FUNCTION_4(indices_to_value)
+
 	}
 
 
@@ -310,6 +314,12 @@ namespace nest {
 			if(index >= size(resl)) return false;
 			Index cell_index = index >> (DIM*resl);
 			Index hier_index = index & ((ONE<<(DIM*resl))-1);
+			return set_value_from_hier( hier_index, cell_index, resl, value,
+				typename impl::has_const_member_fun_indices_to_value<
+					ParamMapType, bool, Indices const &, Index, Index, Value & >::type() );
+		}
+	 private:
+		bool set_value_from_hier(Index hier_index, Index cell_index, Index resl, Value & value, boost::mpl::false_) const {
 			Float scale = 1.0 / Float(ONE<<resl);
 			Params params;
 			for(size_t i = 0; i < DIM; ++i){
@@ -318,6 +328,12 @@ namespace nest {
 			}
 			return this->params_to_value( params, cell_index, resl, value );
 		}
+		bool set_value_from_hier(Index hier_index, Index cell_index, Index resl, Value & value, boost::mpl::true_) const {
+			Indices indices;
+			for(size_t i = 0; i < DIM; ++i) indices[i] = util::undilate<DIM>(hier_index>>i);
+			return this->indices_to_value( indices, cell_index, resl, value );
+		}
+	 public:
 		///@brief set the state of this NEST to Value for index at depth resl
 		///@return false iff invalid index
 		bool set_state(Index index, Index resl){
@@ -71,6 +71,44 @@ TEST( OriTransMap, lookups_multicell_ori ){
 	ASSERT_LE( nfail*1./end, 0.1 );
 }
 
+TEST( OriTransMap, ori_cache_matches_params ){
+
+	typedef Eigen::Transform<float,3,Eigen::AffineCompact> EigenXform;
+	typedef util::SimpleArray<3,float> F3;
+	typedef util::SimpleArray<3,int> I3;
+
+	typedef NEST<6,EigenXform,OriTransMap,util::StoreNothing,uint64_t,float,false> Nest;
+
+	Nest nest( 30.0, F3(-8.0,-8.0,-8.0), F3(8.0,8.0,8.0), I3(4,4,4) );
+	Nest cached( nest );
+	ASSERT_EQ( cached.init_ori_cache( 3, 1ull<<30 ), 4 );
+	ASSERT_EQ( cached.init_ori_cache( 3, 0 ), 0 );
+	ASSERT_EQ( cached.init_ori_cache( 2, 1ull<<30 ), 3 ); // resl 3 not cached, falls back
+
+	typedef Nest::Params Params;
+	for( int resl = 0; resl <= 3; ++resl ){
+		uint64_t end = std::min( (uint64_t)200000, nest.size(resl) );
+		float const scale = 1.0 / float(1ull<<resl);
+		int nvalid = 0;
+		for( uint64_t i = 0; i < end; ++i ){
+			EigenXform x, y, z;
+			bool const valid = nest.get_state( i, resl, x );
+			ASSERT_EQ( valid, cached.get_state( i, resl, y ) );
+
+			// reference: the generic params round trip
+			uint64_t hier = i & ((1ull<<(6*resl))-1);
+			Params params;
+			for( int d = 0; d < 6; ++d ) params[d] = ( (float)util::undilate<6>( hier>>d ) + 0.5 ) * scale;
+			ASSERT_EQ( valid, nest.params_to_value( params, i>>(6*resl), resl, z ) );
+			if( !valid ) continue;
+			++nvalid;
+			ASSERT_TRUE( x.matrix() == z.matrix() );
+			ASSERT_TRUE( y.matrix() == z.matrix() );
+		}
+		ASSERT_GT( nvalid, 0 );
+	}
+}
+
 TEST( OriTransMap, name ){
 	typedef Eigen::Transform<double,3,Eigen::AffineCompact> EigenXform;
 
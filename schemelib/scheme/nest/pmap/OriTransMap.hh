@@ -41,6 +41,14 @@ namespace scheme { namespace nest { namespace pmap {
 		OriMap ori_map_;
 		TransMap trans_map_;
 
+		///@brief precomputed rotation for one orientation sub-index, valid==false if outside the cell
+		struct OriCacheEntry {
+			M rot;
+			bool valid;
+		};
+		///@brief per-resolution rotation tables, indexed by (ori_cell<<3r | i2<<2r | i1<<r | i0)
+		std::vector< std::vector<OriCacheEntry> > ori_cache_;
+
 		OriTransMap(){}
 
 		template< class P, class I >
@@ -63,6 +71,7 @@ namespace scheme { namespace nest { namespace pmap {
 			int const ori_nside = OriMap::get_nside_for_rot_resl_deg( rot_resl_deg );
 			ori_map_.init( ori_nside );
 			trans_map_.init( lb, ub, bs );
+			ori_cache_.clear();
 			// cout << "OriMap: TetracontoctachoronMap, "
 			//      << rot_resl_deg << " nside: " << ori_map_.nside_ << ", covrad: "
 		 //    	 << ori_map_.bin_circumradius(0)*180.0/M_PI << ", size: " << ori_map_.num_cells() << endl;
@@ -94,6 +103,81 @@ namespace scheme { namespace nest { namespace pmap {
 			return true;
 		}
 
+		///@brief precompute rotations for resolutions 0..max_resl, stopping at the first resolution that
+		///       would push the total table size past max_bytes
+		///@note the rotation depends only on the orientation cell and the three orientation indices, so
+		///      these tables let indices_to_value skip the quaternion math entirely
+		///@return number of resolutions cached
+		int init_ori_cache( int max_resl, size_t max_bytes ){
+			ori_cache_.clear();
+			Index const ncori = ori_map_.num_cells();
+			size_t total_bytes = 0;
+			for( int resl = 0; resl <= max_resl; ++resl ){
+				if( 3*resl >= (int)sizeof(Index)*8 ) break;
+				Index const nsub = Index(1) << (3*resl);
+				Index const nentries = ncori * nsub;
+				if( nentries / nsub != ncori ) break; // overflow
+				size_t const nbytes = nentries * sizeof(OriCacheEntry);
+				if( total_bytes + nbytes > max_bytes ) break;
+				total_bytes += nbytes;
+
+				Index const mask = (Index(1)<<resl)-1;
+				Float const scale = 1.0 / Float(Index(1)<<resl);
+				ori_cache_.push_back( std::vector<OriCacheEntry>( nentries ) );
+				std::vector<OriCacheEntry> & table = ori_cache_.back();
+				for( Index key = 0; key < nentries; ++key ){
+					P3 pori;
+					pori[0] = ( static_cast<Float>( key              & mask ) + 0.5 ) * scale;
+					pori[1] = ( static_cast<Float>( key >>    resl   & mask ) + 0.5 ) * scale;
+					pori[2] = ( static_cast<Float>( key >> (2*resl)  & mask ) + 0.5 ) * scale;
+					Index const cori = key >> (3*resl);
+					table[key].valid = ori_map_.params_to_value( pori, cori, resl, table[key].rot );
+				}
+			}
+			return (int)ori_cache_.size();
+		}
+
+		///@brief sets value from the per-dimension indices NEST has already undilated
+		///@detail same result as params_to_value with params = (indices+0.5)/2^resl, but uses the
+		///        orientation tables from init_ori_cache where available
+		///@return false iff invalid parameters
+		bool indices_to_value(
+			Indices const & indices,
+			Index cell_index,
+			Index resl,
+			Value & value
+		) const {
+			Index const ncori  = ori_map_.num_cells();
+			Index const cori   = cell_index % ncori;
+			Index const ctrans = cell_index / ncori;
+			Float const scale = 1.0 / Float(Index(1)<<resl);
+			P3 ptrans;
+			ptrans[0] = ( static_cast<Float>(indices[3]) + 0.5 ) * scale;
+			ptrans[1] = ( static_cast<Float>(indices[4]) + 0.5 ) * scale;
+			ptrans[2] = ( static_cast<Float>(indices[5]) + 0.5 ) * scale;
+			V v;
+			if( resl < ori_cache_.size() ){
+				Index const key = cori << (3*resl) | indices[2] << (2*resl) | indices[1] << resl | indices[0];
+				OriCacheEntry const & entry = ori_cache_[resl][key];
+				if( !entry.valid ) return false;
+				trans_map_.params_to_value( ptrans, ctrans, resl, v );
+				value = Value( entry.rot );
+			} else {
+				P3 pori;
+				pori[0] = ( static_cast<Float>(indices[0]) + 0.5 ) * scale;
+				pori[1] = ( static_cast<Float>(indices[1]) + 0.5 ) * scale;
+				pori[2] = ( static_cast<Float>(indices[2]) + 0.5 ) * scale;
+				M m;
+				if( !ori_map_.params_to_value( pori, cori, resl, m ) ) return false;
+				trans_map_.params_to_value( ptrans, ctrans, resl, v );
+				value = Value( m );
+			}
+			value.translation()[0] = v[0];
+			value.translation()[1] = v[1];
+			value.translation()[2] = v[2];
+			return true;
+		}
+
 		///@brief sets params/cell_index from value
 		///@note necessary for value lookup and neighbor lookup
 		bool value_to_params(
@@ -9,7 +9,11 @@
 #include <random>
 #include "scheme/util/Timer.hh"
 
+#include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <sstream>
+#include <unistd.h>
 
 namespace scheme { namespace objective { namespace hash { namespace xmtest {
 
@@ -56,14 +60,18 @@ TEST( XformMap, stores_correctly ){
 	// 	ASSERT_FALSE( xmap.save( out, "foo" ) );
 	// 	out.close();
 	// }
-	std::ofstream out("test.sxm" , std::ios::binary );
+	char const * tmpdir = std::getenv( "TMPDIR" );
+	std::string const fname = std::string( tmpdir ? tmpdir : "/tmp" ) + "/XformMap_test_" + std::to_string( getpid() ) + ".sxm";
+	std::ofstream out( fname , std::ios::binary );
 	ASSERT_TRUE( xmap.save( out, "foo" ) );
 	out.close();
 
 	XformMap< Xform, double > xmap_loaded;
-	std::ifstream in( "test.sxm"  , std::ios::binary );
-	ASSERT_TRUE( xmap_loaded.load( in ) );
+	std::ifstream in( fname  , std::ios::binary );
+	bool const loaded = xmap_loaded.load( in );
 	in.close();
+	std::remove( fname.c_str() );
+	ASSERT_TRUE( loaded );
 
 	ASSERT_EQ( xmap.cart_resl_, xmap_loaded.cart_resl_ );
 	ASSERT_EQ( xmap.ang_resl_, xmap_loaded.ang_resl_ );	
@@ -78,6 +86,74 @@ TEST( XformMap, stores_correctly ){
 
 }
 
+TEST( XformMap, prefilter ){
+	int NSAMP = 100000;
+
+	std::mt19937 rng(12345);
+	std::uniform_real_distribution<> runif;
+
+	XformMap< Xform, double> xmap( 0.5, 10.0 );
+	std::vector< std::pair<Xform,double> > dat;
+	for(int i = 0; i < NSAMP; ++i){
+		Xform x;
+		numeric::rand_xform( rng, x, 256.0 );
+		double val = runif(rng) + 1.0;
+		xmap.insert(x,val);
+		dat.push_back( std::make_pair(x,val) );
+	}
+	xmap.build_prefilter( 10.0 );
+	ASSERT_TRUE( xmap.has_prefilter() );
+	ASSERT_EQ( (uintptr_t)xmap.prefilter_.words_.data() % 64, 0 );
+	xmap.place_memory( util::MemoryPlacement( false, true ) ); // asserts the bucket array it finds is sane
+
+	// no false negatives, including keys inserted after the build
+	Xform extra;
+	numeric::rand_xform( rng, extra, 256.0 );
+	xmap.insert( extra, 7.0 );
+	ASSERT_EQ( xmap[extra], 7.0 );
+	for(int i = 0; i < dat.size(); ++i) ASSERT_EQ( xmap[dat[i].first], xmap.map_[xmap.get_key(dat[i].first)] );
+
+	int nfalsepos = 0;
+	for(int i = 0; i < NSAMP; ++i){
+		Xform x;
+		numeric::rand_xform( rng, x, 256.0 );
+		x.translation()[0] += 1000.0;
+		ASSERT_EQ( xmap[x], 0.0 );
+		nfalsepos += xmap.prefilter_.maybe_contains( xmap.get_key(x) );
+	}
+	ASSERT_LT( nfalsepos, NSAMP*0.03 );
+
+	// filter round trips through save / load, and plain maps still load
+	std::ostringstream out( std::ios::binary );
+	ASSERT_TRUE( xmap.save( out, "foo" ) );
+	XformMap< Xform, double > xmap_loaded;
+	std::istringstream in( out.str(), std::ios::binary );
+	ASSERT_TRUE( xmap_loaded.load( in ) );
+	ASSERT_TRUE( xmap_loaded.has_prefilter() );
+	for(int i = 0; i < dat.size(); ++i) ASSERT_EQ( xmap_loaded[dat[i].first], xmap[dat[i].first] );
+
+	xmap.prefilter_.clear();
+	std::ostringstream out2( std::ios::binary );
+	ASSERT_TRUE( xmap.save( out2, "foo" ) );
+	XformMap< Xform, double > xmap_loaded2;
+	std::istringstream in2( out2.str(), std::ios::binary );
+	ASSERT_TRUE( xmap_loaded2.load( in2 ) );
+	ASSERT_FALSE( xmap_loaded2.has_prefilter() );
+	ASSERT_EQ( xmap_loaded2.size(), xmap.size() );
+
+	// whatever follows a plain map in the stream is left for the next reader
+	std::ostringstream out3( std::ios::binary );
+	ASSERT_TRUE( xmap.save( out3, "foo" ) );
+	out3 << "trailing data";
+	XformMap< Xform, double > xmap_loaded3;
+	std::istringstream in3( out3.str(), std::ios::binary );
+	ASSERT_TRUE( xmap_loaded3.load( in3 ) );
+	ASSERT_FALSE( xmap_loaded3.has_prefilter() );
+	std::string rest;
+	std::getline( in3, rest );
+	ASSERT_EQ( rest, "trailing data" );
+}
+
 double get_ident_lever_dis( Xform x, double lever_dis ){
 	util::SimpleArray<7,double> x_lever_coord;
 	x_lever_coord[0] = x.translation()[0];
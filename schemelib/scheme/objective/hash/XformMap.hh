@@ -8,6 +8,9 @@
 #include "scheme/numeric/bcc_lattice.hh"
 #include "scheme/objective/hash/XformHash.hh"
 #include "scheme/objective/hash/XformHashNeighbors.hh"
+#include "scheme/util/BlockedBloomFilter.hh"
+#include "scheme/util/MemoryPlacement.hh"
+#include "scheme/util/assert.hh"
 // #include <riflib/RotamerGenerator.hh>
 // #include <riflib/util.hh>
 
@@ -62,10 +65,12 @@ struct XformMap {
     // typedef util::SimpleArray< (1<<ArrayBits), Value >  ValArray;
     // typedef google::dense_hash_map<Key,ValArray> Map;
     typedef google::dense_hash_map<Key,Value> Map;
+	static uint64_t const PREFILTER_MAGIC = 0x314c4642504d5858ull; // "XXMPBFL1"
     Hasher hasher_;
     Map map_;
 	ElementSerializer element_serializer_;
     Float cart_resl_, ang_resl_, cart_bound_;
+	util::BlockedBloomFilter prefilter_; // optional, rejects most empty-bin lookups before probing map_
 	// #ifdef USE_OPENMP
  //    omp_lock_t insert_lock;
 	// #endif
@@ -94,9 +99,34 @@ struct XformMap {
 		// #endif
 	}
 
-	void clear() { map_.clear(); }
+	void clear() { map_.clear(); prefilter_.clear(); }
+
+	///@brief build the membership prefilter from the current keys. must be rebuilt if map_
+	///       is modified directly; insert / insert_min keep it up to date
+	void build_prefilter( float bits_per_key = 10.0 ){
+		prefilter_.init( map_.size(), bits_per_key );
+		for( typename Map::const_iterator i = map_.begin(); i != map_.end(); ++i ){
+			prefilter_.insert( i->first );
+		}
+	}
+	bool has_prefilter() const { return !prefilter_.empty(); }
+
+	///@brief numa / huge page placement of the buckets and the prefilter, see util::MemoryPlacement.
+	///       must be redone if the map is rehashed
+	bool place_memory( util::MemoryPlacement const & placement ) const {
+		// dense_hash_map keeps its buckets in one array, and its iterators know where that array ends.
+		// this leans on sparsehash internals, so make sure the derived range holds the map's own iterators
+		typename Map::const_iterator i = map_.begin(), e = map_.end();
+		typename Map::value_type const * buckets = i.end - map_.bucket_count();
+		ALWAYS_ASSERT_MSG( e.pos == i.end && i.pos >= buckets && i.pos <= i.end,
+			"XformMap::place_memory: unexpected dense_hash_map layout" );
+		bool ok = util::place_memory( buckets, map_.bucket_count()*sizeof(typename Map::value_type), placement );
+		if( has_prefilter() ) ok &= util::place_memory( prefilter_.words_.data(), prefilter_.mem_use(), placement );
+		return ok;
+	}
 
 	bool insert( Key k, Value val ){
+		if( has_prefilter() ) prefilter_.insert( k );
 		map_.insert( std::make_pair(k,val) );
 		return true;
 		// Key k0 = k >> ArrayBits;
@@ -118,6 +148,7 @@ struct XformMap {
 		Key k = hasher_.get_key( x );
 		typename Map::iterator i = map_.find( k );
 		if( i == map_.end() ){
+			if( has_prefilter() ) prefilter_.insert( k );
 			map_.insert( std::make_pair(k,val) );
 		} else {
 			i->second = std::min( i->second, val );
@@ -130,6 +161,7 @@ struct XformMap {
 		// typename Map::const_iterator iter = map_.find(k0);
 		// if( iter == map_.end() ){ return Value(); }
 		// return iter->second[k1];
+		if( has_prefilter() && !prefilter_.maybe_contains(k) ){ return Value(); }
 		typename Map::const_iterator iter = map_.find(k);
 		if( iter == map_.end() ){ return Value(); }
 		return iter->second;
@@ -199,7 +231,7 @@ struct XformMap {
 	size_t size() const { return map_.size(); }//*(1<<ArrayBits); }
 	// size_t total_size() const { return map_.size(); }//*(1<<ArrayBits); }
 
-	size_t mem_use() const { return map_.bucket_count()*(sizeof(Key)+sizeof(Value)); } //*sizeof(ValArray); }
+	size_t mem_use() const { return map_.bucket_count()*(sizeof(Key)+sizeof(Value)) + prefilter_.mem_use(); } //*sizeof(ValArray); }
 
 	size_t count( Value val ) const {
 		// int count = 0;
@@ -261,6 +293,15 @@ struct XformMap {
 			std::cerr << "XfromMap::load failed to unserialize sparsehash" << std::endl;
 			return false;
 		}
+		// optional trailer, older readers stop before it
+		if( has_prefilter() ){
+			uint64_t magic = PREFILTER_MAGIC;
+			out.write( (char*)&magic, sizeof(uint64_t) );
+			if( ! prefilter_.save( out ) ){
+				std::cerr << "XformMap::save failed to write prefilter" << std::endl;
+				return false;
+			}
+		}
 		return true;
 	}
 	bool load( std::istream & in, std::string & description ) {
@@ -315,6 +356,22 @@ struct XformMap {
 			std::cerr << "XfromMap::load failed to unserialize sparsehash" << std::endl;
 			return false;
 		}
+		prefilter_.clear();
+		if( in.peek() != std::char_traits<char>::eof() ){
+			std::streampos const trailer_start = in.tellg();
+			uint64_t magic = 0;
+			in.read( (char*)&magic, sizeof(uint64_t) );
+			if( in.gcount() == sizeof(uint64_t) && magic == PREFILTER_MAGIC ){
+				if( ! prefilter_.load( in ) ){
+					std::cerr << "XformMap::load failed to read prefilter" << std::endl;
+					return false;
+				}
+			} else {
+				// not ours, leave the bytes for whatever reads the stream next
+				in.clear();
+				if( trailer_start != std::streampos(-1) ) in.seekg( trailer_start );
+			}
+		}
 
 		// std::cout << "SIZE IN " << map_.size() << std::endl;
 		return true;
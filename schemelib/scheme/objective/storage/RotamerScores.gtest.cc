@@ -253,6 +253,40 @@ TEST( RotamerScores, test_sort_sat ) {
 	ASSERT_EQ( rs3, rs2 );
 
 }
+
+template< class RS >
+void check_decode( std::mt19937 & rng, bool with_sat ){
+	std::uniform_real_distribution<> uniform( -6.0, 0.0 );
+	std::uniform_int_distribution<> rand_rot(0,500);
+	std::uniform_int_distribution<> rand_sat(-1,20);
+	for( int iter = 0; iter < 1000; ++iter ){
+		RS rs;
+		int const nadd = iter % (RS::N+3);
+		for( int i = 0; i < nadd; ++i ){
+			if( with_sat ) rs.add_rotamer( rand_rot(rng), uniform(rng), rand_sat(rng), rand_sat(rng) );
+			else           rs.add_rotamer( rand_rot(rng), uniform(rng) );
+		}
+		typename RS::Decoded dec;
+		rs.decode( dec );
+		ASSERT_EQ( dec.size(), rs.size() );
+		for( int i = 0; i < dec.size(); ++i ){
+			ASSERT_EQ( dec.rotamer(i), rs.rotamer(i) );
+			ASSERT_EQ( dec.score(i), rs.score(i) );
+			ASSERT_EQ( dec.do_i_satisfy_anything(i), rs.do_i_satisfy_anything(i) );
+		}
+	}
+}
+
+TEST( RotamerScores, decode_matches_accessors ){
+	std::mt19937 rng(1234);
+	check_decode< RotamerScores< 1> >( rng, false );
+	check_decode< RotamerScores<12> >( rng, false );
+	check_decode< RotamerScores<28> >( rng, false );
+	check_decode< RotamerScores<28, RotamerScoreSat<uint16_t,9,-4> > >( rng, true );
+	check_decode< RotamerScores<28, RotamerScoreSat<uint16_t,9,-4> > >( rng, false );
+}
+
+
 // TEST( RotamerScores, test_store_4 ){
 
 // 	RotamerScores<4> rs;
@@ -263,6 +263,22 @@ std::ostream & operator << ( std::ostream & out, RotamerScoreSat<Data,RBits,Div,
 
 
 
+///@brief every entry of a RotamerScores unpacked at once, see RotamerScores::decode
+template< int _N, class _Data >
+struct RotamerScoresDecoded {
+	typedef _Data Data;
+	static int const N = _N;
+	int size_; // entries before the first empty one
+	Data rotamer_[N];
+	float score_[N];
+	uint8_t sat_[N]; // nonzero iff do_i_satisfy_anything
+
+	int size() const { return size_; }
+	Data rotamer( int i ) const { assert(i<N); return rotamer_[i]; }
+	float score( int i ) const { assert(i<N); return score_[i]; }
+	bool do_i_satisfy_anything( int i ) const { assert(i<N); return sat_[i]; }
+};
+
 template<
 	int _N,
 	class _RotamerScore = RotamerScore<>
@@ -274,6 +290,7 @@ struct RotamerScores {
 	typedef _RotamerScore RotScore;
 	typedef typename RotScore::Data Data;
 	typedef RotamerScores< _N, RotScore > THIS;
+	typedef RotamerScoresDecoded< _N, Data > Decoded;
 
 	static int const N = _N;
 	util::SimpleArray<N,RotScore> rotscores_;
@@ -367,6 +384,20 @@ struct RotamerScores {
 
 	bool empty( int i ) const { return rotscores_[i].empty(); }
 
+	///@brief unpack rotamers, scores and satisfaction flags of all N entries in one pass
+	///@detail fixed trip count and no early exit, so the loops vectorize; gives the same
+	///        values as rotamer(i), score(i) and do_i_satisfy_anything(i) for i < out.size()
+	void decode( Decoded & out ) const {
+		Data raw[N];
+		for( int i = 0; i < N; ++i ) raw[i] = rotscores_[i].data_;
+		for( int i = 0; i < N; ++i ) out.rotamer_[i] = raw[i] & RotScore::RotamerMask;
+		for( int i = 0; i < N; ++i ) out.score_[i] = RotScore::data2float( raw[i] >> RotScore::RotamerBits );
+		decode_sat_impl< RotScore::UseSat >( out );
+		int n = N;
+		for( int i = N-1; i >= 0; --i ) n = raw[i] == RotScore::RotamerMask ? i : n;
+		out.size_ = n;
+	}
+
 	static int maxsize(){ return _N; }
 
 	int size() const { int i; for(i=0;i<_N;++i) if( rotscores_[i].empty() ) break; return i; }
@@ -428,6 +459,17 @@ struct RotamerScores {
 	template< bool UseSat, class Array > typename boost::disable_if_c< UseSat, void >::type
 	get_sat_groups_raw_impl( int irot, Array &   ) const { return; }
 
+	template< bool UseSat >	typename boost::enable_if_c< UseSat, void >::type
+	decode_sat_impl( Decoded & out ) const {
+		for( int i = 0; i < N; ++i ){
+			uint8_t any = 0;
+			for( int isat = 0; isat < RotScore::NSat; ++isat ) any |= rotscores_[i].sat_data_[isat].not_empty();
+			out.sat_[i] = any;
+		}
+	}
+	template< bool UseSat >	typename boost::disable_if_c< UseSat, void >::type
+	decode_sat_impl( Decoded & out ) const { for( int i = 0; i < N; ++i ) out.sat_[i] = 0; }
+
     template< bool UseSat > typename boost::enable_if_c< UseSat, int >::type
     get_requirement_num_impl( int irot ) const { return rotscores_[irot].get_requirement_num( ); }
     template< bool UseSat > typename boost::disable_if_c< UseSat, int >::type
@@ -0,0 +1,135 @@
+#ifndef INCLUDED_objective_voxel_GridMinimizer_HH
+#define INCLUDED_objective_voxel_GridMinimizer_HH
+
+#include <Eigen/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace scheme { namespace objective { namespace voxel {
+
+///@brief settings for minimize_rigid_body_on_grids
+struct GridMinOpts {
+	int max_iterations = 50;
+	float max_translation = 1.5; // farthest the centroid may move from where it started
+	float max_rotation_deg = 10.0; // largest total rotation about the centroid
+	float initial_step = 0.25; // largest atom displacement of the first trial step
+	float tolerance = 0.001; // stop once an accepted step gains less than this
+};
+
+template< class Float >
+struct GridMinResult {
+	typedef Eigen::Transform<Float,3,Eigen::AffineCompact> Xform;
+	Float start_score = 0;
+	Float score = 0;
+	int iterations = 0;
+	Xform delta = Xform::Identity(); // maps the input positions onto the minimized ones
+};
+
+///@brief sum of the fields at the positions, each atom looking in fields[types[i]]. null fields score 0
+///       gradient (if not null) gets the per-atom gradients
+template< class Float, class FieldPtr >
+Float score_on_grids(
+	std::vector< Eigen::Matrix<Float,3,1> > const & positions,
+	std::vector< int > const & types,
+	std::vector< FieldPtr > const & fields,
+	std::vector< Eigen::Matrix<Float,3,1> > * gradient = nullptr
+){
+	typedef Eigen::Matrix<Float,3,1> V3;
+	Float score = 0;
+	if( gradient ) gradient->assign( positions.size(), V3::Zero() );
+	for( size_t i = 0; i < positions.size(); ++i ){
+		int const t = types[i];
+		if( t < 0 || t >= (int)fields.size() || !fields[t] ) continue;
+		V3 g;
+		score += fields[t]->interpolate( positions[i], g );
+		if( gradient ) (*gradient)[i] = g;
+	}
+	return score;
+}
+
+///@brief rigid body minimization of a set of atoms in precomputed per-atom-type fields
+///@detail steepest descent on translation plus rotation about the centroid, using the analytic
+///        gradient of the trilinearly interpolated fields. rotation steps are scaled by the radius of
+///        gyration so both parts move atoms by comparable amounts. each step backtracks until the score
+///        improves; the body never leaves the max_translation / max_rotation_deg box around the start
+template< class Float, class FieldPtr >
+GridMinResult<Float> minimize_rigid_body_on_grids(
+	std::vector< Eigen::Matrix<Float,3,1> > const & positions,
+	std::vector< int > const & types,
+	std::vector< FieldPtr > const & fields,
+	GridMinOpts const & opts
+){
+	typedef Eigen::Matrix<Float,3,1> V3;
+	typedef Eigen::Matrix<Float,3,3> M3;
+	GridMinResult<Float> result;
+	if( positions.empty() ) return result;
+
+	V3 cen = V3::Zero();
+	for( auto const & p : positions ) cen += p;
+	cen /= positions.size();
+	Float rg2 = 0;
+	for( auto const & p : positions ) rg2 += ( p - cen ).squaredNorm();
+	Float const rg = std::max( (Float)1.0, std::sqrt( rg2 / positions.size() ) );
+	Float const max_angle = opts.max_rotation_deg * M_PI / 180.0;
+
+	// current pose: q = rot * ( p - cen ) + cen + trans
+	M3 rot = M3::Identity();
+	V3 trans = V3::Zero();
+	std::vector< V3 > moved( positions ), trial( positions ), grad, trial_grad;
+
+	Float score = score_on_grids( moved, types, fields, &grad );
+	result.start_score = score;
+	Float step = opts.initial_step;
+
+	for( int iter = 0; iter < opts.max_iterations; ++iter ){
+		V3 force = V3::Zero(), torque = V3::Zero();
+		V3 const cur_cen = cen + trans;
+		for( size_t i = 0; i < moved.size(); ++i ){
+			force += grad[i];
+			torque += ( moved[i] - cur_cen ).cross( grad[i] );
+		}
+		torque /= rg;
+		Float const gnorm = std::sqrt( force.squaredNorm() + torque.squaredNorm() );
+		if( gnorm < 1e-6 ) break;
+		V3 const dir_t = -force / gnorm, dir_r = -torque / gnorm / rg;
+
+		bool accepted = false, converged = false;
+		for( int ibt = 0; ibt < 8 && !accepted; ++ibt, step *= 0.5 ){
+			V3 const new_trans = trans + step * dir_t;
+			Float const angle = step * dir_r.norm();
+			M3 const drot = angle > 0 ? M3( Eigen::AngleAxis<Float>( angle, dir_r.normalized() ) ) : M3::Identity();
+			M3 const new_rot = drot * rot;
+			if( new_trans.norm() > opts.max_translation ) continue;
+			if( Eigen::AngleAxis<Float>( new_rot ).angle() > max_angle ) continue;
+			for( size_t i = 0; i < positions.size(); ++i ){
+				trial[i] = new_rot * ( positions[i] - cen ) + cen + new_trans;
+			}
+			Float const trial_score = score_on_grids( trial, types, fields, &trial_grad );
+			if( trial_score < score ){
+				Float const gain = score - trial_score;
+				rot = new_rot;
+				trans = new_trans;
+				moved.swap( trial );
+				grad.swap( trial_grad );
+				score = trial_score;
+				accepted = true;
+				step *= 4.0; // undone by the loop's halving, so a good step grows by 2
+				converged = gain < opts.tolerance;
+			}
+		}
+		result.iterations = iter + 1;
+		if( !accepted || converged ) break;
+		step = std::min( step, (Float)opts.initial_step * 4 );
+	}
+
+	result.score = score;
+	result.delta.linear() = rot;
+	result.delta.translation() = cen + trans - rot * cen;
+	return result;
+}
+
+}}}
+
+#endif
@@ -92,4 +92,50 @@ TEST(VoxelArray,io){
 }
 
 
+
+TEST(VoxelArray,interpolate){
+	typedef util::SimpleArray<3,double> F3;
+	VoxelArray<3,double,double> a( F3(-2,-3,-4), F3(3,2,1), F3(0.5,0.5,0.5) );
+	// a linear field is reproduced exactly between voxel centers
+	for(size_t i = 0; i < a.shape()[0]; ++i)
+	for(size_t j = 0; j < a.shape()[1]; ++j)
+	for(size_t k = 0; k < a.shape()[2]; ++k){
+		F3 c = a.indices_to_center( VoxelArray<3,double,double>::Indices(i,j,k) );
+		a[c] = 1.0*c[0] - 2.0*c[1] + 3.0*c[2];
+	}
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<> uniform;
+	for(int iter = 0; iter < 1000; ++iter){
+		F3 p( -1+3*uniform(rng), -2+3*uniform(rng), -3+3*uniform(rng) );
+		F3 grad;
+		double val = a.interpolate( p, grad );
+		ASSERT_NEAR( val, 1.0*p[0] - 2.0*p[1] + 3.0*p[2], 1e-9 );
+		ASSERT_NEAR( grad[0],  1.0, 1e-9 );
+		ASSERT_NEAR( grad[1], -2.0, 1e-9 );
+		ASSERT_NEAR( grad[2],  3.0, 1e-9 );
+	}
+
+	// gradient matches finite differences on a random field
+	for(size_t i = 0; i < a.num_elements(); ++i) a.data()[i] = uniform(rng);
+	for(int iter = 0; iter < 1000; ++iter){
+		F3 p( -2.5+6*uniform(rng), -3.5+6*uniform(rng), -4.5+6*uniform(rng) );
+		F3 grad, dummy;
+		a.interpolate( p, grad );
+		for(int k = 0; k < 3; ++k){
+			F3 lo(p), hi(p);
+			lo[k] -= 1e-6;
+			hi[k] += 1e-6;
+			double fd = ( a.interpolate( hi, dummy ) - a.interpolate( lo, dummy ) ) / 2e-6;
+			ASSERT_NEAR( grad[k], fd, 1e-4 );
+		}
+	}
+
+	// at a voxel center it agrees with at(), far away it is 0
+	F3 grad;
+	F3 c = a.indices_to_center( VoxelArray<3,double,double>::Indices(3,4,5) );
+	ASSERT_NEAR( a.interpolate( c, grad ), a.at( c ), 1e-9 );
+	ASSERT_EQ( a.interpolate( F3(100,0,0), grad ), 0 );
+	ASSERT_EQ( grad[0], 0 );
+}
+
 }}}}
@@ -9,6 +9,7 @@
 
 #include <boost/format.hpp>
 #include <fstream>
+#include <cmath>
 
 #include <random>
 #include<boost/random/uniform_real.hpp>
@@ -86,6 +87,44 @@ struct VoxelArray : boost::multi_array<_Value,_DIM> {
 		else return Value(0);
 	}
 
+	///@brief trilinear interpolation between voxel centers, the gradient wrt v goes in grad
+	///@detail off-grid voxels count as 0 like in at(), so values fade to 0 over the outermost half voxel
+	template<class V, class G>
+	Value interpolate( V const & v, G & grad ) const {
+		BOOST_STATIC_ASSERT((DIM==3));
+		grad[0] = grad[1] = grad[2] = 0;
+		long i0[3];
+		Float fr[3];
+		for(int k = 0; k < 3; ++k){
+			Float t = (v[k]-lb_[k])/cs_[k] - 0.5;
+			if( !( t > -1.0 && t < (Float)this->shape()[k] ) ) return Value(0); // also rejects nan
+			Float fl = std::floor(t);
+			i0[k] = (long)fl;
+			fr[k] = t - fl;
+		}
+		Value val = 0;
+		for(int corner = 0; corner < 8; ++corner){
+			Indices idx;
+			Float w[3], dw[3];
+			bool inside = true;
+			for(int k = 0; k < 3; ++k){
+				int const up = (corner>>k)&1;
+				long const i = i0[k] + up;
+				if( i < 0 || i >= (long)this->shape()[k] ){ inside = false; break; }
+				idx[k] = i;
+				w[k] = up ? fr[k] : 1-fr[k];
+				dw[k] = ( up ? 1 : -1 ) / cs_[k];
+			}
+			if( !inside ) continue;
+			Value const c = this->operator()(idx);
+			val     += w[0] * w[1] * w[2] * c;
+			grad[0] += dw[0]* w[1] * w[2] * c;
+			grad[1] += w[0] * dw[1]* w[2] * c;
+			grad[2] += w[0] * w[1] * dw[2]* c;
+		}
+		return val;
+	}
+
 	// void write(std::ostream & out) const {
 	// 	out.write( (char const*)&lb_, sizeof(Bounds) );
 	// 	out.write( (char const*)&ub_, sizeof(Bounds) );
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "scheme/objective/voxel/VoxelNeighborList.hh"
+
+#include <random>
+
+namespace scheme { namespace objective { namespace voxel { namespace test {
+
+using std::cout;
+using std::endl;
+
+TEST( VoxelNeighborList, matches_nested_vectors ){
+	typedef VoxelNeighborList<uint16_t,float> VNL;
+	typedef VNL::Bounds F3;
+
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> uniform(-10.0,10.0);
+	std::vector<F3> points;
+	for( int i = 0; i < 200; ++i ) points.push_back( F3( uniform(rng), uniform(rng), uniform(rng) ) );
+
+	float const radius = 2.5;
+	for( int unique = 0; unique <= 1; ++unique ){
+		VNL vnl;
+		vnl.init( F3(-12.5), F3(12.5), F3(0.5) );
+
+		// each point touches the voxels near it, twice, so unique has something to remove
+		auto touched = [&]( size_t ipt, std::vector<uint32_t> & out ){
+			for( int rep = 0; rep < 2; ++rep ){
+				for( float x = points[ipt][0]-radius; x <= points[ipt][0]+radius; x += 0.5 ){
+				for( float y = points[ipt][1]-radius; y <= points[ipt][1]+radius; y += 0.5 ){
+				for( float z = points[ipt][2]-radius; z <= points[ipt][2]+radius; z += 0.5 ){
+					if( ( F3(x,y,z) - points[ipt] ).norm() > radius ) continue;
+					out.push_back( vnl.index_to_map_index( vnl.floats_to_index( F3(x,y,z) ) ) );
+				}}}
+			}
+		};
+		vnl.build( points.size(), touched, unique );
+
+		std::vector< std::vector<uint16_t> > ref( vnl.num_voxels() );
+		for( size_t ipt = 0; ipt < points.size(); ++ipt ){
+			std::vector<uint32_t> t;
+			touched( ipt, t );
+			for( uint32_t v : t ){
+				if( unique && ref[v].size() && ref[v].back() == ipt ) continue;
+				ref[v].push_back( ipt );
+			}
+		}
+
+		size_t max_per_voxel = 0, total = 0;
+		VNL::Indices idx;
+		for( idx[0] = 0; idx[0] < vnl.shape_[0]; ++idx[0] ){
+		for( idx[1] = 0; idx[1] < vnl.shape_[1]; ++idx[1] ){
+		for( idx[2] = 0; idx[2] < vnl.shape_[2]; ++idx[2] ){
+			std::vector<uint16_t> const & r = ref[ vnl.index_to_map_index(idx) ];
+			VNL::Span s = vnl.at( vnl.indices_to_center(idx) );
+			ASSERT_EQ( r.size(), s.size() );
+			for( size_t i = 0; i < r.size(); ++i ) ASSERT_EQ( r[i], s[i] );
+			max_per_voxel = std::max( max_per_voxel, r.size() );
+			total += r.size();
+		}}}
+		ASSERT_EQ( max_per_voxel, vnl.max_per_voxel_ );
+		ASSERT_EQ( total, vnl.payload_.size() );
+		ASSERT_GT( total, 0 );
+
+		ASSERT_TRUE( vnl.at( F3(-13,0,0) ).empty() );
+		ASSERT_TRUE( vnl.at( F3(0,0,13) ).empty() );
+		ASSERT_TRUE( vnl.at( F3(0,1e9,0) ).empty() );
+	}
+}
+
+TEST( VoxelNeighborList, empty ){
+	VoxelNeighborList<> vnl;
+	ASSERT_TRUE( vnl.at( 0, 0, 0 ).empty() );
+	ASSERT_TRUE( vnl.at( -1, 5, 1e9 ).empty() );
+	vnl.init( VoxelNeighborList<>::Bounds(0), VoxelNeighborList<>::Bounds(1), VoxelNeighborList<>::Bounds(1) );
+	vnl.build( 0, []( size_t, std::vector<uint32_t> & ){} );
+	ASSERT_TRUE( vnl.at( 0.5, 0.5, 0.5 ).empty() );
+	ASSERT_EQ( vnl.max_per_voxel_, 0 );
+}
+
+}}}}
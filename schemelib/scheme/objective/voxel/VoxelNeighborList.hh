@@ -0,0 +1,144 @@
+#ifndef INCLUDED_objective_voxel_VoxelNeighborList_HH
+#define INCLUDED_objective_voxel_VoxelNeighborList_HH
+
+#include "scheme/util/SimpleArray.hh"
+#include "scheme/util/assert.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <vector>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace scheme { namespace objective { namespace voxel {
+
+///@brief for every voxel of a 3d grid, the list of items (e.g. target atoms or hbond rays) near it
+///@detail lists are stored csr style: the payloads of voxel i are payload_[offsets_[i]] up to
+///        payload_[offsets_[i+1]]. an extra empty list sits after the last voxel, and out of bounds
+///        queries return it, so at() has no branch on the lookup path
+template< class Payload = uint16_t, class Float = float >
+struct VoxelNeighborList {
+	typedef util::SimpleArray<3,size_t> Indices;
+	typedef util::SimpleArray<3,Float> Bounds;
+
+	struct Span {
+		Payload const * begin_, * end_;
+		Payload const * begin() const { return begin_; }
+		Payload const * end() const { return end_; }
+		size_t size() const { return end_ - begin_; }
+		bool empty() const { return begin_ == end_; }
+		Payload operator[]( size_t i ) const { return begin_[i]; }
+	};
+
+	Bounds lb_, ub_, cs_;
+	Indices shape_;
+	std::vector<uint32_t> offsets_;
+	std::vector<Payload> payload_;
+	size_t max_per_voxel_ = 0;
+
+	VoxelNeighborList() { init( Bounds(0), Bounds(0), Bounds(1) ); }
+
+	///@brief grid covering lb to ub, every list empty
+	template< class F1, class F2, class F3 >
+	void init( F1 const & lb, F2 const & ub, F3 const & cs ){
+		for( int i = 0; i < 3; ++i ){
+			lb_[i] = lb[i];
+			ub_[i] = std::max<Float>( lb[i], ub[i] ); // empty bounds give a single voxel
+			cs_[i] = cs[i];
+		}
+		shape_ = floats_to_index( ub_ ) + Indices(1);
+		offsets_.assign( num_voxels()+2, 0 );
+		payload_.clear();
+		max_per_voxel_ = 0;
+	}
+
+	size_t num_voxels() const { return shape_[0] * shape_[1] * shape_[2]; }
+
+	template< class Floats >
+	Indices floats_to_index( Floats const & f ) const {
+		Indices ind;
+		for( int i = 0; i < 3; ++i ) ind[i] = (f[i]-lb_[i])/cs_[i];
+		return ind;
+	}
+
+	size_t index_to_map_index( Indices const & ind ) const {
+		return ( ind[0] * shape_[1] + ind[1] ) * shape_[2] + ind[2];
+	}
+
+	Bounds indices_to_center( Indices const & idx ) const {
+		Bounds c;
+		for( int i = 0; i < 3; ++i ) c[i] = (idx[i]+0.5)*cs_[i] + lb_[i];
+		return c;
+	}
+
+	///@brief fill the lists. visit( item, out ) appends to out the map indices of the voxels item
+	///       touches, in any order. items are visited in parallel; within a voxel the payloads are
+	///       ordered by item, then by the order visit emitted them, same as a serial fill. repeats
+	///       of an item in one voxel are kept unless unique is set
+	template< class Visit >
+	void build( size_t nitems, Visit const & visit, bool unique = false ){
+		ALWAYS_ASSERT_MSG( nitems <= (size_t)std::numeric_limits<Payload>::max(), "VoxelNeighborList: too many items for payload type" );
+		size_t const nvox = num_voxels();
+		std::vector< std::vector<uint32_t> > touched( nitems );
+		std::exception_ptr exception = nullptr;
+		#ifdef USE_OPENMP
+		#pragma omp parallel for schedule(dynamic,1)
+		#endif
+		for( int64_t item = 0; item < (int64_t)nitems; ++item ){
+			if( exception ) continue;
+			try {
+				std::vector<uint32_t> & t = touched[item];
+				visit( (size_t)item, t );
+				if( unique ){
+					std::sort( t.begin(), t.end() );
+					t.erase( std::unique( t.begin(), t.end() ), t.end() );
+				}
+				for( uint32_t v : t ) ALWAYS_ASSERT_MSG( v < nvox, "VoxelNeighborList: voxel index out of bounds" );
+			} catch( ... ) {
+				#ifdef USE_OPENMP
+				#pragma omp critical
+				#endif
+				exception = std::current_exception();
+			}
+		}
+		if( exception ) std::rethrow_exception( exception );
+
+		offsets_.assign( nvox+2, 0 );
+		for( auto const & t : touched ) for( uint32_t v : t ) ++offsets_[v+1];
+		max_per_voxel_ = 0;
+		for( size_t i = 0; i <= nvox; ++i ){
+			max_per_voxel_ = std::max<size_t>( max_per_voxel_, offsets_[i+1] );
+			ALWAYS_ASSERT_MSG( (uint64_t)offsets_[i] + offsets_[i+1] <= std::numeric_limits<uint32_t>::max(), "VoxelNeighborList: too many entries" );
+			offsets_[i+1] += offsets_[i];
+		}
+		payload_.resize( offsets_[nvox] );
+		std::vector<uint32_t> cursor( offsets_.begin(), offsets_.begin()+nvox );
+		for( size_t item = 0; item < nitems; ++item ){
+			for( uint32_t v : touched[item] ) payload_[ cursor[v]++ ] = item;
+		}
+	}
+
+	///@brief the list at the voxel holding v, empty if v is outside the grid
+	template< class V >
+	Span at( V const & v ) const { return at( v[0], v[1], v[2] ); }
+
+	Span at( Float f, Float g, Float h ) const {
+		Float const x = (f-lb_[0])/cs_[0], y = (g-lb_[1])/cs_[1], z = (h-lb_[2])/cs_[2];
+		bool const in = x >= 0 && y >= 0 && z >= 0 && x < shape_[0] && y < shape_[1] && z < shape_[2];
+		size_t const i = in ? ( (size_t)x * shape_[1] + (size_t)y ) * shape_[2] + (size_t)z : num_voxels();
+		Payload const * p = payload_.data();
+		Span s = { p + offsets_[i], p + offsets_[i+1] };
+		return s;
+	}
+
+	size_t mem_use() const { return offsets_.size()*sizeof(uint32_t) + payload_.size()*sizeof(Payload); }
+
+};
+
+}}}
+
+#endif
@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include "scheme/objective/voxel/VoxelOccupancy.hh"
+#include "scheme/objective/voxel/VoxelArray.hh"
+
+#include <random>
+
+namespace scheme { namespace objective { namespace voxel { namespace test {
+
+using std::cout;
+using std::endl;
+
+TEST( VoxelOccupancy, matches_voxel_array ){
+	typedef VoxelArray<3,float,float> VA;
+	typedef VA::Bounds F3;
+
+	// a blob that fills some bricks entirely and leaves others partial or empty
+	VA va( F3(-7,-5,-6), F3(8,9,4.3), F3(0.5) );
+	std::mt19937 rng(0);
+	std::uniform_real_distribution<float> uniform(0.0,1.0);
+	VA::Indices idx;
+	for( idx[0] = 0; idx[0] < va.shape()[0]; ++idx[0] ){
+	for( idx[1] = 0; idx[1] < va.shape()[1]; ++idx[1] ){
+	for( idx[2] = 0; idx[2] < va.shape()[2]; ++idx[2] ){
+		F3 const c = va.indices_to_center( idx );
+		float const r = c.norm();
+		va( idx ) = r < 4 ? 1.0 : ( r < 7 && uniform(rng) < 0.3 ? uniform(rng) : 0.0 );
+	}}}
+
+	VoxelOccupancy<float> nonzero( va, []( float v ){ return v != 0.0; } );
+	VoxelOccupancy<float> above( va, []( float v ){ return v > 0.5; } );
+	VoxelOccupancy<float> below( va, []( float v ){ return v < 0.5; } );
+	ASSERT_FALSE( nonzero.outside_ );
+	ASSERT_TRUE( below.outside_ );
+	ASSERT_GT( nonzero.leaves_.size(), 2 );
+	ASSERT_LT( nonzero.mem_use()*8, va.num_elements()*sizeof(float) );
+
+	std::uniform_real_distribution<float> coord(-10.0,12.0);
+	int nocc = 0;
+	for( int i = 0; i < 200000; ++i ){
+		F3 const p( coord(rng), coord(rng), coord(rng) );
+		float const v = va.at( p[0], p[1], p[2] );
+		ASSERT_EQ( v != 0.0, nonzero.at( p ) );
+		ASSERT_EQ( v > 0.5, above.at( p ) );
+		ASSERT_EQ( v < 0.5, below.at( p[0], p[1], p[2] ) );
+		nocc += nonzero.at( p );
+	}
+	ASSERT_GT( nocc, 0 );
+
+	// edges, including the sliver below lb that VoxelArray still maps to the first voxel
+	for( float d : { -1.01f, -0.99f, -0.3f, 0.0f, 0.2f } ){
+		for( int k = 0; k < 3; ++k ){
+			F3 p( 0.1 );
+			p[k] = va.lb_[k] + d*va.cs_[k];
+			ASSERT_EQ( va.at( p[0], p[1], p[2] ) != 0.0, nonzero.at( p ) );
+			p[k] = va.lb_[k] + ( va.shape()[k] - d )*va.cs_[k];
+			ASSERT_EQ( va.at( p[0], p[1], p[2] ) != 0.0, nonzero.at( p ) );
+		}
+	}
+}
+
+TEST( VoxelOccupancy, empty ){
+	VoxelOccupancy<float> occ;
+	ASSERT_FALSE( occ.at( 0, 0, 0 ) );
+	ASSERT_FALSE( occ.at( -1, 5, 1e9 ) );
+}
+
+}}}}
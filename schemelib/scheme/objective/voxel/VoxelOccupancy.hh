@@ -0,0 +1,107 @@
+#ifndef INCLUDED_objective_voxel_VoxelOccupancy_HH
+#define INCLUDED_objective_voxel_VoxelOccupancy_HH
+
+#include "scheme/util/SimpleArray.hh"
+#include "scheme/util/assert.hh"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace scheme { namespace objective { namespace voxel {
+
+///@brief one bit per voxel of a 3d grid, for yes/no lookups that would otherwise test a float VoxelArray
+///@detail voxels are grouped in 4x4x4 bricks, each held as one 64 bit leaf mask. the top level stores a
+///        leaf index per brick; every all-empty brick shares leaf 0 and every all-full brick shares leaf 1,
+///        so the common case costs 4 bytes per 64 voxels. a lookup is one bounds test, one top level load
+///        and one shift. voxel geometry and out of bounds behaviour match VoxelArray::at
+template< class Float = float >
+struct VoxelOccupancy {
+	typedef util::SimpleArray<3,size_t> Indices;
+	typedef util::SimpleArray<3,Float> Bounds;
+
+	static int const BrickBits = 2; // bricks are 4 voxels on a side
+
+	Bounds lb_, cs_;
+	Indices shape_, brick_shape_;
+	std::vector<uint32_t> brick_leaf_;
+	std::vector<uint64_t> leaves_;
+	bool outside_ = false;
+
+	VoxelOccupancy() { clear(); }
+
+	///@brief occupancy of va where pred( value ) holds. outside the grid, at() gives pred( 0 ) like VoxelArray::at
+	template< class VoxelArray, class Pred >
+	VoxelOccupancy( VoxelArray const & va, Pred const & pred ) { init( va, pred ); }
+
+	void clear(){
+		lb_ = Bounds(0);
+		cs_ = Bounds(1);
+		shape_ = Indices(0);
+		brick_shape_ = Indices(0);
+		brick_leaf_.clear();
+		leaves_.assign( 2, 0 );
+		leaves_[1] = ~uint64_t(0);
+		outside_ = false;
+	}
+
+	template< class VoxelArray, class Pred >
+	void init( VoxelArray const & va, Pred const & pred ){
+		clear();
+		for( int i = 0; i < 3; ++i ){
+			lb_[i] = va.lb_[i];
+			cs_[i] = va.cs_[i];
+			shape_[i] = va.shape()[i];
+			brick_shape_[i] = ( shape_[i] + (1<<BrickBits) - 1 ) >> BrickBits;
+		}
+		outside_ = pred( typename VoxelArray::Value(0) );
+		ALWAYS_ASSERT_MSG( num_bricks() < std::numeric_limits<uint32_t>::max(), "VoxelOccupancy: grid too large" );
+		brick_leaf_.resize( num_bricks() );
+		Indices b, v;
+		for( b[0] = 0; b[0] < brick_shape_[0]; ++b[0] ){
+		for( b[1] = 0; b[1] < brick_shape_[1]; ++b[1] ){
+		for( b[2] = 0; b[2] < brick_shape_[2]; ++b[2] ){
+			uint64_t mask = 0, full = 0;
+			for( int i = 0; i < 64; ++i ){
+				v[0] = ( b[0] << BrickBits ) + ( i >> 4 );
+				v[1] = ( b[1] << BrickBits ) + ( i >> 2 & 3 );
+				v[2] = ( b[2] << BrickBits ) + ( i & 3 );
+				if( v[0] >= shape_[0] || v[1] >= shape_[1] || v[2] >= shape_[2] ) continue; // never looked up
+				full |= uint64_t(1) << i;
+				if( pred( va( v ) ) ) mask |= uint64_t(1) << i;
+			}
+			uint32_t & leaf = brick_leaf_[ brick_index( b[0], b[1], b[2] ) ];
+			if     ( mask == 0    ) leaf = 0;
+			else if( mask == full ) leaf = 1;
+			else { leaf = leaves_.size(); leaves_.push_back( mask ); }
+		}}}
+		ALWAYS_ASSERT_MSG( leaves_.size() < std::numeric_limits<uint32_t>::max(), "VoxelOccupancy: too many leaves" );
+	}
+
+	size_t num_bricks() const { return brick_shape_[0] * brick_shape_[1] * brick_shape_[2]; }
+
+	size_t brick_index( size_t bx, size_t by, size_t bz ) const {
+		return ( bx * brick_shape_[1] + by ) * brick_shape_[2] + bz;
+	}
+
+	///@brief occupancy of the voxel holding v
+	template< class V >
+	bool at( V const & v ) const { return at( v[0], v[1], v[2] ); }
+
+	bool at( Float f, Float g, Float h ) const {
+		Float const x = (f-lb_[0])/cs_[0], y = (g-lb_[1])/cs_[1], z = (h-lb_[2])/cs_[2];
+		// VoxelArray truncates toward zero, so (-1,0) still lands in the first voxel
+		if( !( x > -1 && y > -1 && z > -1 && x < shape_[0] && y < shape_[1] && z < shape_[2] ) ) return outside_;
+		size_t const ix = x, iy = y, iz = z;
+		uint64_t const leaf = leaves_[ brick_leaf_[ brick_index( ix >> BrickBits, iy >> BrickBits, iz >> BrickBits ) ] ];
+		int const bit = ( ix & 3 ) << 4 | ( iy & 3 ) << 2 | ( iz & 3 );
+		return leaf >> bit & 1;
+	}
+
+	size_t mem_use() const { return brick_leaf_.size()*sizeof(uint32_t) + leaves_.size()*sizeof(uint64_t); }
+
+};
+
+}}}
+
+#endif
@@ -104,6 +104,49 @@ TEST( RosettaField, test_faster_atombin_calc ){
 
 
 
+TEST( RosettaField, compute_rosetta_fields_matches_field_cache ){
+	typedef util::SimpleArray<3,float> F3;
+	typedef actor::Atom<F3> Atom;
+	std::vector<Atom> atoms;
+	F3 delta;
+	for( delta[0] = -6; delta[0] <= 6; delta[0]+=6.0 ){
+	for( delta[1] = -6; delta[1] <= 6; delta[1]+=6.0 ){
+	for( delta[2] = -6; delta[2] <= 6; delta[2]+=6.0 ){
+		atoms.push_back( Atom( F3( 0.696,-12.422,3.375) + delta, 7  ));
+		atoms.push_back( Atom( F3( 0.576, -9.666,5.336) + delta, 17 ));
+		atoms.push_back( Atom( F3(-0.523,-10.824,6.189) + delta, -3 )); // attraction off
+		atoms.push_back( Atom( F3(-1.324,-12.123,4.201) + delta, 7  ));
+		atoms.push_back( Atom( F3(-0.608,-12.327,3.072) + delta, 3  ));
+		atoms.push_back( Atom( F3(-1.125,-12.422,1.933) + delta, 13 ));
+		atoms.push_back( Atom( F3(-0.470,-12.087,5.377) + delta, -12345 )); // very repulsive
+		atoms.push_back( Atom( F3( 0.953,-12.267,4.780) + delta, 6  ));
+	}}}
+	RosettaField<Atom,EtableParamsInit> rf(atoms);
+	F3 lb = rf.atom_bins_lb_-6.0f, ub = rf.atom_bins_ub_+6.0f;
+
+	for( int oversample = 1; oversample <= 2; ++oversample ){
+		std::vector<int> atypes { 1, 5, 13, 18 };
+		std::vector< objective::voxel::FieldCache3D<float>* > fields;
+		for( int atype : atypes ){
+			RosettaFieldAtype<Atom,EtableParamsInit> rfa(rf,atype);
+			fields.push_back( new objective::voxel::FieldCache3D<float>( rfa, lb, ub, 0.7, "", true, oversample ) );
+		}
+		rf.compute_rosetta_fields( atypes, fields, oversample );
+		for( int i = 0; i < atypes.size(); ++i ){
+			RosettaFieldAtype<Atom,EtableParamsInit> rfa(rf,atypes[i]);
+			objective::voxel::FieldCache3D<float> ref( rfa, lb, ub, 0.7, "", false, oversample );
+			ASSERT_EQ( ref.num_elements(), fields[i]->num_elements() );
+			int nnonzero = 0;
+			for( size_t j = 0; j < ref.num_elements(); ++j ){
+				ASSERT_EQ( ref.data()[j], fields[i]->data()[j] );
+				nnonzero += ref.data()[j] != 0;
+			}
+			ASSERT_GT( nnonzero, ref.num_elements()/4 );
+			delete fields[i];
+		}
+	}
+}
+
 TEST( RosettaField, test_btn ){
 
 	int NITER = 50;
@@ -6,8 +6,15 @@
 #include "scheme/rosetta/score/EtableParams.hh"
 #include "scheme/numeric/util.hh"
 #include "scheme/types.hh"
+#include <algorithm>
+#include <exception>
+#include <limits>
 #include <vector>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 namespace scheme { namespace rosetta { namespace score {
 
 
@@ -22,6 +29,11 @@ struct RosettaField {
 	boost::multi_array< std::vector<Atom> , 3 > atom_bins_;
 	F3 atom_bins_lb_, atom_bins_ub_;
 	I3 atom_bins_dim_;
+	// flat (csr) copy of atom_bins_ for compute_rosetta_fields, bin atoms are
+	// cell_x_[cell_begin_[b]] ... cell_x_[cell_begin_[b+1]-1]
+	std::vector<int> cell_begin_;
+	std::vector<float> cell_x_, cell_y_, cell_z_;
+	std::vector<int> cell_type_;
 
 	float const bin_witdh_ = 6.001f;
 
@@ -57,6 +69,19 @@ struct RosettaField {
 			tot += atom_bins_.data()[i].size();
 		}
 		BOOST_VERIFY( tot == atoms_.size() );
+
+		// multi_array is row major, so this is the same bin order compute_rosetta_energy visits
+		cell_begin_.assign( 1, 0 );
+		cell_x_.clear(); cell_y_.clear(); cell_z_.clear(); cell_type_.clear();
+		for( int i = 0; i < atom_bins_.num_elements(); ++i){
+			for( auto const & a : atom_bins_.data()[i] ){
+				cell_x_.push_back( a.position()[0] );
+				cell_y_.push_back( a.position()[1] );
+				cell_z_.push_back( a.position()[2] );
+				cell_type_.push_back( a.type() );
+			}
+			cell_begin_.push_back( cell_x_.size() );
+		}
 	}
 	I3 position_to_atombin( F3 p ) const {
 		I3 i = ( p - atom_bins_lb_ ) / bin_witdh_;
@@ -79,8 +104,16 @@ struct RosettaField {
 		if( dis2 > 36.0 ) return 0; //  103s vs 53s
 		float const dis = std::sqrt(dis2);
 		float const inv_dis2 = 1.0f/dis2;
+		return compute_rosetta_energy_pair( a.type(), dis, dis2, inv_dis2, atype );
+	}
+
+	float
+	compute_rosetta_energy_pair(
+		int at,
+		float dis, float dis2, float inv_dis2,
+		int atype
+	) const {
 		float atr0=0,rep0=0,sol0=0;
-		int at = a.type();
 		bool very_repulsive = at==-12345;
 		if( very_repulsive ) at = 5;
 		bool neg_only = at < 0;
@@ -142,6 +175,113 @@ struct RosettaField {
 		return compute_rosetta_energy_safe( f[0], f[1], f[2], atype );
 	}
 
+	///@brief fill fields[i] with the energy of atypes[i], sampled like FieldCache3D
+	///@detail all fields must share lb_, cs_ and shape. the grid is cut into bricks about one
+	///        atom bin wide; each brick gathers the nearby csr bins into contiguous arrays once,
+	///        then every sample point does a straight distance pass over them and evaluates the
+	///        etable for all atypes on the pairs inside the cutoff. bricks run in parallel.
+	///        atoms are summed in the same order as compute_rosetta_energy, so values match it.
+	template< class VoxelArray >
+	void compute_rosetta_fields(
+		std::vector<int> const & atypes,
+		std::vector<VoxelArray*> const & fields,
+		int oversample = 1
+	) const {
+		typedef typename VoxelArray::Indices Indices;
+		ALWAYS_ASSERT( atypes.size() == fields.size() );
+		if( fields.empty() ) return;
+		VoxelArray const & ref = *fields.front();
+		for( auto f : fields ){
+			ALWAYS_ASSERT( f->lb_ == ref.lb_ && f->cs_ == ref.cs_ );
+			for( int k = 0; k < 3; ++k ) ALWAYS_ASSERT( f->shape()[k] == ref.shape()[k] );
+		}
+		int const ntype = atypes.size();
+		int shape[3], brick[3], nbrick[3];
+		for( int k = 0; k < 3; ++k ){
+			shape[k] = ref.shape()[k];
+			brick[k] = std::max( 1, (int)( bin_witdh_ / ref.cs_[k] ) );
+			nbrick[k] = ( shape[k] + brick[k] - 1 ) / brick[k];
+		}
+		float const om = 1.0/oversample;
+		float const oo = om/2.0 - 0.5;
+
+		std::exception_ptr exception = nullptr;
+		#ifdef USE_OPENMP
+		#pragma omp parallel for schedule(dynamic,1)
+		#endif
+		for( int ibrick = 0; ibrick < nbrick[0]*nbrick[1]*nbrick[2]; ++ibrick ){
+			if( exception ) continue;
+			try {
+				int b0[3], b1[3];
+				b0[0] = ibrick / ( nbrick[1]*nbrick[2] ) * brick[0];
+				b0[1] = ibrick / nbrick[2] % nbrick[1] * brick[1];
+				b0[2] = ibrick % nbrick[2] * brick[2];
+				for( int k = 0; k < 3; ++k ) b1[k] = std::min( shape[k], b0[k] + brick[k] );
+
+				// gather atoms from every bin within the cutoff of the brick
+				I3 clo, chi;
+				for( int k = 0; k < 3; ++k ){
+					float const lo = ref.lb_[k] + b0[k]*ref.cs_[k] - 6.0f;
+					float const hi = ref.lb_[k] + b1[k]*ref.cs_[k] + 6.0f;
+					clo[k] = std::max( 0, (int)std::floor( ( lo - atom_bins_lb_[k] ) / bin_witdh_ ) );
+					chi[k] = std::min( atom_bins_dim_[k]-1, (int)std::floor( ( hi - atom_bins_lb_[k] ) / bin_witdh_ ) );
+				}
+				std::vector<float> ax, ay, az, d2;
+				std::vector<int> at;
+				for( int i = clo[0]; i <= chi[0]; ++i ){
+				for( int j = clo[1]; j <= chi[1]; ++j ){
+				for( int l = clo[2]; l <= chi[2]; ++l ){
+					int const b = ( i*atom_bins_dim_[1] + j )*atom_bins_dim_[2] + l;
+					ax.insert( ax.end(), cell_x_.begin()+cell_begin_[b], cell_x_.begin()+cell_begin_[b+1] );
+					ay.insert( ay.end(), cell_y_.begin()+cell_begin_[b], cell_y_.begin()+cell_begin_[b+1] );
+					az.insert( az.end(), cell_z_.begin()+cell_begin_[b], cell_z_.begin()+cell_begin_[b+1] );
+					at.insert( at.end(), cell_type_.begin()+cell_begin_[b], cell_type_.begin()+cell_begin_[b+1] );
+				}}}
+				int const natom = ax.size();
+				d2.resize( natom );
+
+				std::vector<float> E( ntype ), Emin( ntype );
+				for( int i = b0[0]; i < b1[0]; ++i ){
+				for( int j = b0[1]; j < b1[1]; ++j ){
+				for( int l = b0[2]; l < b1[2]; ++l ){
+					F3 const cen = ref.indices_to_center( Indices(i,j,l) );
+					std::fill( Emin.begin(), Emin.end(), std::numeric_limits<float>::max() );
+					for( int o = 0; o < oversample; ++o ){
+					for( int p = 0; p < oversample; ++p ){
+					for( int q = 0; q < oversample; ++q ){
+						float const x = cen[0] + ( o*om + oo ) * ref.cs_[0];
+						float const y = cen[1] + ( p*om + oo ) * ref.cs_[1];
+						float const z = cen[2] + ( q*om + oo ) * ref.cs_[2];
+						for( int ia = 0; ia < natom; ++ia ){
+							float const dx = x-ax[ia];
+							float const dy = y-ay[ia];
+							float const dz = z-az[ia];
+							d2[ia] = dx*dx+dy*dy+dz*dz;
+						}
+						std::fill( E.begin(), E.end(), 0.0f );
+						for( int ia = 0; ia < natom; ++ia ){
+							float const dis2 = d2[ia];
+							if( dis2 > 36.0 ) continue;
+							float const dis = std::sqrt(dis2);
+							float const inv_dis2 = 1.0f/dis2;
+							for( int it = 0; it < ntype; ++it ){
+								E[it] += compute_rosetta_energy_pair( at[ia], dis, dis2, inv_dis2, atypes[it] );
+							}
+						}
+						for( int it = 0; it < ntype; ++it ) Emin[it] = std::min( Emin[it], E[it] );
+					}}}
+					for( int it = 0; it < ntype; ++it ) (*fields[it])( Indices(i,j,l) ) = Emin[it];
+				}}}
+			} catch( ... ) {
+				#ifdef USE_OPENMP
+				#pragma omp critical
+				#endif
+				exception = std::current_exception();
+			}
+		}
+		if( exception ) std::rethrow_exception( exception );
+	}
+
 };
 
 template< class Atom, class EtableInit >
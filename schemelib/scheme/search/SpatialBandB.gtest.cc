@@ -10,6 +10,10 @@
 
 #include <boost/mpl/vector.hpp>
 
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
 namespace scheme { namespace search { namespace spbbtest {
 
 using std::cout;
@@ -138,4 +142,137 @@ TEST( SpatialBandB, test_test_utils ){
 
 }
 
+// 1d nest: 8 cells at resl 0, each split in two at every finer resl. score is the distance from the
+//  cell to the nearest of a few wells, which bounds the score of every child
+struct WellScore {
+	std::vector<std::pair<double,float>> wells_; // position, depth
+	mutable std::atomic<int64_t> nfull_, npartial_;
+	WellScore() : nfull_(0), npartial_(0) {
+		wells_.push_back( std::make_pair( 0.3141, -1.0f ) );
+		wells_.push_back( std::make_pair( 0.7777, -1.1f ) );
+		wells_.push_back( std::make_pair( 0.5020, -0.9f ) );
+	}
+	static double width( int resl ){ return 1.0 / ( 8 << resl ); }
+	float bound( uint64_t index, int resl ) const {
+		double const w = width( resl ), c = ( index + 0.5 ) * w;
+		float best = 9e9;
+		for( auto const & well : wells_ ){
+			double const d = std::max( 0.0, std::fabs( c - well.first ) - w/2 );
+			best = std::min<float>( best, well.second + d );
+		}
+		return best;
+	}
+	template< class Sample >
+	void operator()( Sample & s, int resl, int /*ithread*/, float cut ) const {
+		float const lb = bound( s.index, resl );
+		if( lb > cut ){ s.score = lb; ++npartial_; return; } // can't make the beam, skip the "expensive" part
+		s.score = lb + 1e-6f * ( s.index % 7 ); // never below the bound
+		++nfull_;
+	}
+};
+
+TEST( SpatialBandB, select_and_expand ){
+	typedef BeamSample<> Sample;
+	std::vector<Sample> samples;
+	for( int i = 0; i < 100; ++i ){ samples.push_back( Sample( i ) ); samples.back().score = ( i * 37 ) % 100; }
+	BeamStats<Sample> stats = select_beam( samples, 10 );
+	ASSERT_EQ( stats.nscored, 100 );
+	ASSERT_EQ( stats.nkept, 10 );
+	ASSERT_EQ( stats.best.score, 0 );
+	ASSERT_EQ( stats.worst.score, 10 );
+	for( int i = 0; i < 10; ++i ) ASSERT_LT( samples[i].score, 10 );
+	stats = select_beam( samples, 1000 );
+	ASSERT_EQ( stats.nkept, 100 );
+	ASSERT_EQ( stats.worst.score, 99 );
+
+	std::sort( samples.begin(), samples.end() );
+	std::vector<Sample> children;
+	SpatialBandB<Sample> bandb( FixedBeam( 10 ), 4 );
+	expand_children( samples, 10, []( Sample const & s ){ return s.score < 5; }, 4, bandb.nest_child(), children );
+	ASSERT_EQ( children.size(), 20 );
+	for( int i = 0; i < 20; ++i ) ASSERT_EQ( children[i].index, samples[i/4].index*4 + i%4 );
+}
+
+TEST( SpatialBandB, select_indices ){
+	for( uint64_t n : { 0, 1, 1000, 100003 } ){
+		std::vector<uint64_t> which, expected;
+		auto keep = []( uint64_t i ){ return i%7 == 3 || i%1000 == 999; };
+		for( uint64_t i = 0; i < n; ++i ) if( keep( i ) ) expected.push_back( i );
+		select_indices( n, keep, which );
+		ASSERT_EQ( which, expected );
+	}
+}
+
+TEST( SpatialBandB, locality_order ){
+	// the 8 corners of a cube sort before anything in the neighboring cube
+	ASSERT_LT( zorder_key( 0.9, 0.9, 0.9, 1.0 ), zorder_key( 1.1, 0.0, 0.0, 1.0 ) );
+	ASSERT_EQ( zorder_key( 0.1, 0.2, 0.3, 1.0 ), zorder_key( 0.9, 0.8, 0.7, 1.0 ) );
+	ASSERT_LT( zorder_key( -1.0, -1.0, -1.0, 1.0 ), zorder_key( 0.0, 0.0, 0.0, 1.0 ) );
+	ASSERT_EQ( zorder_key( -1e30, 0, 0, 1.0 ), zorder_key( -1e20, 0, 0, 1.0 ) );
+
+	typedef BeamSample<> Sample;
+	std::vector<Sample> samples;
+	for( int i = 0; i < 5000; ++i ){ samples.push_back( Sample( ( i * 7919 ) % 5000 ) ); samples.back().score = i; }
+	std::vector<Sample> const orig = samples;
+	std::vector<uint64_t> order = locality_order( samples, []( Sample const & s, int ){ return s.index / 10; } );
+	for( int k = 0; k < 5000; ++k ){
+		ASSERT_EQ( samples[k].index, orig[ order[k] ].index );
+		if( k ) ASSERT_LE( samples[k-1].index / 10, samples[k].index / 10 );
+		if( k && samples[k-1].index / 10 == samples[k].index / 10 ) ASSERT_LT( order[k-1], order[k] );
+	}
+	restore_order( samples, order );
+	for( int k = 0; k < 5000; ++k ){
+		ASSERT_EQ( samples[k].index, orig[k].index );
+		ASSERT_EQ( samples[k].score, orig[k].score );
+	}
+}
+
+TEST( SpatialBandB, finds_best_leaf ){
+	typedef BeamSample<> Sample;
+	int const nresl = 12;
+	WellScore score;
+	std::vector<Sample> result[2];
+	for( int bounded = 0; bounded < 2; ++bounded ){
+		SpatialBandB<Sample> bandb( FixedBeam( 6 ), 2 );
+		bandb.bounded_ = bounded;
+		bandb.score_cut_ = 0;
+		int nstages = 0;
+		bandb.end_stage_ = [&]( int resl, BeamStats<Sample> const & stats ){
+			ASSERT_EQ( resl, nstages++ );
+			ASSERT_LE( stats.nkept, 6 );
+		};
+		std::vector<Sample> & samples = result[bounded];
+		for( int i = 0; i < 8; ++i ) samples.push_back( Sample( i ) );
+		BeamStats<Sample> stats = bandb.search( samples, nresl, score, bandb.nest_child() );
+		ASSERT_EQ( nstages, nresl );
+		ASSERT_EQ( samples.size(), 12 ); // 6 parents, 2 children each
+		ASSERT_EQ( stats.nkept, 6 );
+		// the deepest well wins, and its leaf holds the well
+		double const w = WellScore::width( nresl-1 );
+		ASSERT_LE( stats.best.index * w, 0.7777 );
+		ASSERT_GE( ( stats.best.index + 1 ) * w, 0.7777 );
+		samples.resize( stats.nkept );
+		std::sort( samples.begin(), samples.end() );
+	}
+	ASSERT_GT( score.npartial_, 0 );
+	// skipped samples never displace fully scored ones
+	ASSERT_EQ( result[0].size(), result[1].size() );
+	for( size_t i = 0; i < result[0].size(); ++i ){
+		ASSERT_EQ( result[0][i].index, result[1][i].index );
+		ASSERT_EQ( result[0][i].score, result[1][i].score );
+	}
+}
+
+TEST( SpatialBandB, rethrows ){
+	typedef BeamSample<> Sample;
+	std::vector<Sample> samples( 1000 );
+	bool threw = false;
+	try {
+		score_samples( samples, []( Sample & s, int ){ if( s.index == 0 ) throw std::runtime_error( "bad" ); } );
+	} catch( std::runtime_error const & ){
+		threw = true;
+	}
+	ASSERT_TRUE( threw );
+}
+
 }}}
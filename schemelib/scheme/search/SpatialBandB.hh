@@ -1,7 +1,29 @@
+#ifndef INCLUDED_scheme_search_SpatialBandB_HH
+#define INCLUDED_scheme_search_SpatialBandB_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <scheme/kinematics/Director.hh>
+#include <scheme/util/dilated_int.hh>
 
-#include <list>
+#ifdef USE_OPENMP
+#include <omp.h>
+#ifdef __GLIBCXX__
+#include <parallel/algorithm>
+#define SCHEME_BANDB_GNU_PARALLEL
+#endif
+#endif
 
 namespace scheme { namespace search {
 
@@ -34,40 +56,342 @@ struct BoundingObjectiveFunction
 };
 
 
-template< class BigIndex, class Float = float >
-struct SpatialBandBResult {
-	std::vector< std::pair< float, BigIndex > > results;
-};
+namespace bandb {
+	inline int thread_num(){
+		#ifdef USE_OPENMP
+			return omp_get_thread_num();
+		#else
+			return 0;
+		#endif
+	}
+	inline int max_threads(){
+		#ifdef USE_OPENMP
+			return omp_get_max_threads();
+		#else
+			return 1;
+		#endif
+	}
+}
 
-template<
-	class _Xform,
-	class _BigIndex = uint64_t,
-	class _Index = uint64_t
->
-struct SpatialBandB {
-	typedef _Xform Xform;
-	typedef _BigIndex BigIndex;
+///@brief the score 9e9 means "not scored / rejected" throughout the hierarchical searches
+float const BandBNoScore = 9e9;
+
+///@brief minimal sample for SpatialBandB. anything with score, index and operator< works
+template< class _Index = uint64_t >
+struct BeamSample {
 	typedef _Index Index;
-	typedef kinematics::SceneBase<Xform,Index> Scene;
-	typedef scheme::shared_ptr< Scene > SceneP;
-	typedef scheme::shared_ptr< BoundingFunction<Xform,Index> > BoundP;
-	typedef scheme::shared_ptr< kinematics::Director<Xform,Index,Index> > DirectorP;
-	typedef SpatialBandBResult< BigIndex, float > Result;
-	typedef scheme::shared_ptr< Result > ResultP;
+	float score;
+	Index index;
+	BeamSample() : score(BandBNoScore), index() {}
+	BeamSample( Index i ) : score(BandBNoScore), index(i) {}
+	bool operator<( BeamSample const & o ) const { return score < o.score; }
+};
+
+///@brief beam policy: the same beam at every resolution
+struct FixedBeam {
+	uint64_t size_;
+	FixedBeam( uint64_t size = 0 ) : size_( size ) {}
+	uint64_t operator()( int /*resl*/ ) const { return size_; }
+};
+
+///@brief beam policy: a beam per resolution, the last one repeats
+struct PerReslBeam {
+	std::vector<uint64_t> sizes_;
+	PerReslBeam() {}
+	PerReslBeam( std::vector<uint64_t> const & sizes ) : sizes_( sizes ) {}
+	uint64_t operator()( int resl ) const {
+		if( sizes_.empty() ) return 0;
+		return sizes_[ std::min<size_t>( resl, sizes_.size()-1 ) ];
+	}
+};
+
+///@brief the result of select_beam: best is the best sample, worst the first one outside the beam
+///       (or the worst overall when everything fits), which is what the searches report as the promote range
+template< class Sample >
+struct BeamStats {
+	Sample best, worst;
+	uint64_t nscored = 0, nkept = 0;
+};
+
+///@brief each thread's running best keep scores within a stage
+///@detail the worst score a thread has kept, once it has keep of them, bounds the score needed to make
+///        a global beam of that size: keep samples already beat it. scorers can stop early on samples
+///        that can't get under cut( ithread )
+template< class Float = float >
+struct ThreadBeamCut {
+	std::vector< std::priority_queue<Float> > best_;
+	std::vector<Float> cut_;
+	uint64_t keep_ = 0;
+
+	void reset( int nthreads, uint64_t keep ){
+		best_.assign( keep ? nthreads : 0, std::priority_queue<Float>() );
+		cut_.assign( nthreads, BandBNoScore );
+		keep_ = keep;
+	}
+	bool enabled() const { return keep_ > 0; }
+	Float cut( int ithread ) const { return enabled() ? cut_[ithread] : BandBNoScore; }
+
+	///@brief returns the thread's cut after adding score
+	Float add( int ithread, Float score ){
+		if( !enabled() ) return BandBNoScore;
+		std::priority_queue<Float> & best = best_[ithread];
+		if( best.size() < keep_ ){
+			best.push( score );
+		} else if( score < best.top() ){
+			best.pop();
+			best.push( score );
+		}
+		if( best.size() == keep_ ) cut_[ithread] = best.top();
+		return cut_[ithread];
+	}
+};
 
-	BoundP bounding_func_;
-	SceneP scene_;
-	DirectorP director_;
+///@brief score( samples[i], ithread ) for every sample, on all threads. the first exception is rethrown
+///       after the loop. with progress_marks > 0, that many '*' are printed to out along the way
+template< class Samples, class Score >
+void score_samples(
+	Samples & samples,
+	Score const & score,
+	int64_t chunk = 64,
+	int progress_marks = 0,
+	std::ostream & out = std::cout
+){
+	int64_t const n = samples.size();
+	int64_t const out_interval = progress_marks > 0 ? std::max<int64_t>( n/progress_marks, 1 ) : 0;
+	chunk = std::max<int64_t>( chunk, 1 );
+	std::exception_ptr exception = nullptr;
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(dynamic,chunk)
+	#endif
+	for( int64_t i = 0; i < n; ++i ){
+		if( exception ) continue;
+		try {
+			if( out_interval && i%out_interval == 0 ){
+				#ifdef USE_OPENMP
+				#pragma omp critical
+				#endif
+				{ out << '*'; out.flush(); }
+			}
+			score( samples[i], bandb::thread_num() );
+		} catch( ... ) {
+			#ifdef USE_OPENMP
+			#pragma omp critical
+			#endif
+			exception = std::current_exception();
+		}
+	}
+	if( exception ) std::rethrow_exception( exception );
+}
 
+///@brief partition samples so the best keep come first, in no particular order. nothing is removed
+template< class Samples >
+BeamStats< typename Samples::value_type >
+select_beam( Samples & samples, uint64_t keep ){
+	typedef typename Samples::value_type Sample;
+	BeamStats<Sample> stats;
+	stats.nscored = samples.size();
+	if( samples.empty() ) return stats;
+	#ifdef SCHEME_BANDB_GNU_PARALLEL
+		namespace algo = __gnu_parallel;
+	#else
+		namespace algo = std;
+	#endif
+	if( samples.size() > keep ){
+		algo::nth_element( samples.begin(), samples.begin()+keep, samples.end() );
+		stats.nkept = keep;
+		stats.worst = *(samples.begin()+keep);
+		stats.best = keep ? *algo::min_element( samples.begin(), samples.begin()+keep ) : stats.worst;
+	} else {
+		stats.nkept = samples.size();
+		stats.best = *algo::min_element( samples.begin(), samples.end() );
+		stats.worst = *algo::max_element( samples.begin(), samples.end() );
+	}
+	return stats;
+}
+
+///@brief the i in [0,n) for which keep( i ) holds, in order, into out
+///@detail parallel stream compaction: each block of the range is counted, the counts are prefix summed
+///        into output offsets and every block then writes its own slice of the preallocated out.
+///        keep is called twice per index, so it should be cheap and must not throw
+template< class Keep >
+void select_indices( uint64_t n, Keep const & keep, std::vector<uint64_t> & out ){
+	int64_t const nblocks = std::max<int64_t>( 1, std::min<int64_t>( n/1024, 16*bandb::max_threads() ) );
+	std::vector<uint64_t> offsets( nblocks+1, 0 );
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(dynamic,1)
+	#endif
+	for( int64_t ib = 0; ib < nblocks; ++ib ){
+		uint64_t count = 0;
+		for( uint64_t i = n*ib/nblocks; i < n*(ib+1)/nblocks; ++i ) count += keep( i ) ? 1 : 0;
+		offsets[ib+1] = count;
+	}
+	for( int64_t ib = 0; ib < nblocks; ++ib ) offsets[ib+1] += offsets[ib];
+	out.resize( offsets.back() );
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(dynamic,1)
+	#endif
+	for( int64_t ib = 0; ib < nblocks; ++ib ){
+		uint64_t iout = offsets[ib];
+		for( uint64_t i = n*ib/nblocks; i < n*(ib+1)/nblocks; ++i ) if( keep( i ) ) out[iout++] = i;
+	}
+}
 
-	SpatialBandB(){}
+///@brief the children of parents[0,nparents) that pass keep_parent, in parent order. the children of a
+///       parent p are child( p, j, children[...] ) for j < nchildren; they are filled in parallel
+///       straight into children, which is sized once up front
+template< class Samples, class KeepParent, class Child >
+void expand_children(
+	Samples const & parents,
+	uint64_t nparents,
+	KeepParent const & keep_parent,
+	uint64_t nchildren,
+	Child const & child,
+	Samples & children
+){
+	nparents = std::min<uint64_t>( nparents, parents.size() );
+	std::vector<uint64_t> which;
+	select_indices( nparents, [&]( uint64_t i ){ return keep_parent( parents[i] ); }, which );
+	children.resize( which.size() * nchildren );
+	std::exception_ptr exception = nullptr;
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(dynamic,64)
+	#endif
+	for( int64_t i = 0; i < (int64_t)which.size(); ++i ){
+		if( exception ) continue;
+		try {
+			for( uint64_t j = 0; j < nchildren; ++j ){
+				child( parents[ which[i] ], j, children[ i*nchildren + j ] );
+			}
+		} catch( ... ) {
+			#ifdef USE_OPENMP
+			#pragma omp critical
+			#endif
+			exception = std::current_exception();
+		}
+	}
+	if( exception ) std::rethrow_exception( exception );
+}
 
-	ResultP search(){
-		ResultP result = ResultP( new Result );
+///@brief z-order (morton) key of the grid cell holding (x,y,z), 21 bits per axis. sorting points by it
+///       keeps points that are close in space mostly close in the order
+inline uint64_t zorder_key( float x, float y, float z, float cell_size ){
+	int64_t const half = int64_t(1) << 20;
+	float const p[3] = { x, y, z };
+	uint64_t key = 0;
+	for( int i = 0; i < 3; ++i ){
+		float const f = std::floor( p[i] / cell_size );
+		int64_t const c = !( f >= -half ) ? 0 : ( f >= half ? 2*half-1 : int64_t(f) + half ); // nan goes to 0
+		key |= util::dilate<3>( c ) << i;
+	}
+	return key;
+}
 
-		return result;
+///@brief reorders samples by key( sample, ithread ), computed in parallel, so that samples scored in
+///       sequence touch nearby memory. ties keep their relative order. returns the permutation:
+///       samples[k] is the old samples[ order[k] ], for restore_order
+template< class Samples, class Key >
+std::vector<uint64_t> locality_order( Samples & samples, Key const & key, int64_t chunk = 1024 ){
+	std::vector< std::pair<uint64_t,uint64_t> > keyed( samples.size() );
+	for( uint64_t i = 0; i < keyed.size(); ++i ) keyed[i].second = i;
+	score_samples( keyed, [&]( std::pair<uint64_t,uint64_t> & k, int ithread ){
+		k.first = key( samples[ k.second ], ithread );
+	}, chunk );
+	#ifdef SCHEME_BANDB_GNU_PARALLEL
+		__gnu_parallel::sort( keyed.begin(), keyed.end() );
+	#else
+		std::sort( keyed.begin(), keyed.end() );
+	#endif
+	std::vector<uint64_t> order( keyed.size() );
+	Samples reordered( samples.size() );
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(static)
+	#endif
+	for( int64_t k = 0; k < (int64_t)keyed.size(); ++k ){
+		order[k] = keyed[k].second;
+		reordered[k] = samples[ order[k] ];
 	}
+	samples.swap( reordered );
+	return order;
+}
+
+///@brief undoes locality_order
+template< class Samples >
+void restore_order( Samples & samples, std::vector<uint64_t> const & order ){
+	Samples restored( samples.size() );
+	#ifdef USE_OPENMP
+	#pragma omp parallel for schedule(static)
+	#endif
+	for( int64_t k = 0; k < (int64_t)order.size(); ++k ) restored[ order[k] ] = samples[k];
+	samples.swap( restored );
+}
+
+///@brief hierarchical branch and bound over a nested index space (e.g. a NestDirector)
+///@detail at each resolution every sample is scored, the best beam_( resl ) are selected, and each of
+///        those scoring <= score_cut_ is replaced by its nchildren_ children at the next resolution.
+///        scores at coarse resolution must bound the scores of the children for the search to be exact
+///        within the beam. with bounded_ set, the scorer is also handed each thread's ThreadBeamCut for
+///        the stage, and may return early (with any score above the cut) for samples that can't make it.
+///        the samples of the last resolution are left partitioned, best nkept first, and not truncated
+template< class _Sample, class _BeamPolicy = FixedBeam >
+struct SpatialBandB {
+	typedef _Sample Sample;
+	typedef _BeamPolicy BeamPolicy;
+	typedef BeamStats<Sample> Stats;
+
+	BeamPolicy beam_;
+	uint64_t nchildren_ = 64;
+	float score_cut_ = BandBNoScore;
+	bool bounded_ = false;
+	int64_t chunk_ = 64;
+	int progress_marks_ = 0;
+	std::ostream * out_ = &std::cout;
+
+	std::function< void( int resl, uint64_t nsamples ) > begin_stage_;
+	std::function< void( int resl, Stats const & stats ) > end_stage_;
+
+	SpatialBandB() {}
+	SpatialBandB( BeamPolicy const & beam, uint64_t nchildren ) : beam_( beam ), nchildren_( nchildren ) {}
+
+	///@brief score( sample, resl, ithread, cut ) sets sample.score. child( parent, j, out ) fills out with
+	///       the j'th child of parent. returns the stats of the last resolution searched
+	template< class Score, class Child >
+	Stats search( std::vector<Sample> & samples, int nresl, Score const & score, Child const & child ) const {
+		Stats stats;
+		ThreadBeamCut<float> cuts;
+		std::vector<Sample> children;
+		for( int resl = 0; resl < nresl; ++resl ){
+			if( samples.empty() ) return Stats();
+			if( begin_stage_ ) begin_stage_( resl, samples.size() );
+			uint64_t const keep = beam_( resl );
+			cuts.reset( bandb::max_threads(), bounded_ ? keep : 0 );
+			score_samples( samples, [&]( Sample & s, int ithread ){
+				score( s, resl, ithread, cuts.cut( ithread ) );
+				cuts.add( ithread, s.score );
+			}, chunk_, progress_marks_, *out_ );
+			stats = select_beam( samples, keep );
+			if( end_stage_ ) end_stage_( resl, stats );
+			if( resl+1 == nresl ) break;
+			float const score_cut = score_cut_;
+			expand_children( samples, stats.nkept, [score_cut]( Sample const & s ){ return !( s.score > score_cut ); },
+			                 nchildren_, child, children );
+			samples.swap( children );
+			children.clear();
+		}
+		return stats;
+	}
+
+	///@brief child for nest indices: parent*nchildren + j
+	struct NestChild {
+		uint64_t nchildren_;
+		NestChild( uint64_t nchildren ) : nchildren_( nchildren ) {}
+		void operator()( Sample const & parent, uint64_t j, Sample & out ) const {
+			out = Sample( parent.index * nchildren_ + j );
+		}
+	};
+	NestChild nest_child() const { return NestChild( nchildren_ ); }
 
 };
 
 }}
+
+#endif
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include "scheme/util/AsyncTaskQueue.hh"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+namespace scheme { namespace util { namespace test_async_task_queue {
+
+TEST( AsyncTaskQueue, runs_everything_bounded ){
+	for( int nthreads : { 0, 1, 3 } ){
+		std::atomic<int> ran( 0 ), running( 0 ), queued( 0 ), max_queued( 0 );
+		{
+			AsyncTaskQueue q( nthreads, 4 );
+			ASSERT_EQ( q.num_threads(), nthreads );
+			for( int i = 0; i < 200; ++i ){
+				int const nq = ++queued;
+				int prev = max_queued;
+				while( nq > prev && !max_queued.compare_exchange_weak( prev, nq ) );
+				q.push( [&]{
+					--queued;
+					++running;
+					std::this_thread::sleep_for( std::chrono::microseconds( 50 ) );
+					--running;
+					++ran;
+				});
+			}
+			q.finish();
+			ASSERT_EQ( ran, 200 );
+			ASSERT_EQ( running, 0 );
+		}
+		// at most max_queued waiting plus one being handed to each thread
+		ASSERT_LE( max_queued, 4 + nthreads + 1 );
+	}
+}
+
+TEST( AsyncTaskQueue, rethrows ){
+	std::atomic<int> ran( 0 );
+	AsyncTaskQueue q( 2, 8 );
+	q.push( []{ throw std::runtime_error( "bad" ); } );
+	bool threw = false;
+	try {
+		for( int i = 0; i < 1000; ++i ){
+			q.push( [&]{ ++ran; } );
+			std::this_thread::sleep_for( std::chrono::microseconds( 10 ) );
+		}
+		q.finish();
+	} catch( std::runtime_error const & e ){
+		threw = true;
+		ASSERT_EQ( std::string( e.what() ), "bad" );
+	}
+	ASSERT_TRUE( threw );
+	q.finish(); // rethrows only once
+	ASSERT_LT( ran, 1000 );
+}
+
+}}}
@@ -0,0 +1,98 @@
+#ifndef INCLUDED_scheme_util_AsyncTaskQueue_HH
+#define INCLUDED_scheme_util_AsyncTaskQueue_HH
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace scheme { namespace util {
+
+///@brief runs tasks on a few dedicated background threads, fed through a bounded queue
+///@detail push() blocks while max_queued tasks are waiting, so a producer that outruns the workers
+///        stalls instead of buffering without limit. the first exception a task throws is kept and
+///        rethrown by the next push() or by finish(); the remaining tasks still run. with zero
+///        threads push() runs each task right away on the calling thread
+struct AsyncTaskQueue {
+	typedef std::function<void()> Task;
+
+	AsyncTaskQueue( int nthreads, size_t max_queued ) : max_queued_( max_queued ? max_queued : 1 ) {
+		for( int i = 0; i < nthreads; ++i ) threads_.push_back( std::thread( &AsyncTaskQueue::work, this ) );
+	}
+	AsyncTaskQueue( AsyncTaskQueue const & ) = delete;
+	AsyncTaskQueue & operator=( AsyncTaskQueue const & ) = delete;
+	~AsyncTaskQueue() { try { finish(); } catch( ... ) {} }
+
+	int num_threads() const { return threads_.size(); }
+
+	void push( Task task ){
+		if( threads_.empty() ){
+			rethrow();
+			task();
+			return;
+		}
+		std::unique_lock<std::mutex> lock( mutex_ );
+		not_full_.wait( lock, [this]{ return queue_.size() < max_queued_ || exception_; } );
+		if( exception_ ){ lock.unlock(); rethrow(); }
+		queue_.push_back( std::move( task ) );
+		lock.unlock();
+		not_empty_.notify_one();
+	}
+
+	///@brief waits for every queued task, stops the threads and rethrows the first task exception
+	void finish(){
+		{
+			std::lock_guard<std::mutex> lock( mutex_ );
+			done_ = true;
+		}
+		not_empty_.notify_all();
+		for( auto & t : threads_ ) t.join();
+		threads_.clear();
+		rethrow();
+	}
+
+private:
+
+	void rethrow(){
+		std::exception_ptr e;
+		{
+			std::lock_guard<std::mutex> lock( mutex_ );
+			std::swap( e, exception_ );
+		}
+		if( e ) std::rethrow_exception( e );
+	}
+
+	void work(){
+		for(;;){
+			std::unique_lock<std::mutex> lock( mutex_ );
+			not_empty_.wait( lock, [this]{ return !queue_.empty() || done_; } );
+			if( queue_.empty() ) return; // done_ and drained
+			Task task = std::move( queue_.front() );
+			queue_.pop_front();
+			lock.unlock();
+			not_full_.notify_one();
+			try {
+				task();
+			} catch( ... ) {
+				std::lock_guard<std::mutex> elock( mutex_ );
+				if( !exception_ ) exception_ = std::current_exception();
+				not_full_.notify_all();
+			}
+		}
+	}
+
+	size_t max_queued_;
+	std::mutex mutex_;
+	std::condition_variable not_empty_, not_full_;
+	std::deque<Task> queue_;
+	std::vector<std::thread> threads_;
+	std::exception_ptr exception_;
+	bool done_ = false;
+};
+
+}}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef INCLUDED_scheme_util_Benchmark_HH
+#define INCLUDED_scheme_util_Benchmark_HH
+
+#include "scheme/util/Timer.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace scheme { namespace util {
+
+///@brief timings for one named benchmark, reps x (items of work)
+struct BenchmarkResult {
+	std::string name;
+	uint64_t items = 0;
+	std::vector<double> rep_ns; // wall time per repetition
+	double checksum = 0; // value folded out of the work, should not change run to run
+	std::vector< std::pair<std::string,double> > counters; // extra per-benchmark numbers, kept in insertion order
+
+	double ns_per_item( double ns ) const { return items ? ns / items : ns; }
+	double min_ns() const { return *std::min_element( rep_ns.begin(), rep_ns.end() ); }
+	double max_ns() const { return *std::max_element( rep_ns.begin(), rep_ns.end() ); }
+	double median_ns() const {
+		std::vector<double> tmp( rep_ns );
+		std::sort( tmp.begin(), tmp.end() );
+		size_t const n = tmp.size();
+		return n%2 ? tmp[n/2] : 0.5*( tmp[n/2-1] + tmp[n/2] );
+	}
+	BenchmarkResult & counter( std::string const & key, double val ){
+		counters.push_back( std::make_pair( key, val ) );
+		return *this;
+	}
+};
+
+///@brief minimal repeatable micro benchmark runner
+///@detail each benchmark is a callable returning a double checksum; it is run once untimed
+///        as warmup, then reps times. results are reported as ns per item using the median
+///        rep, and written as json with a fixed key order so runs can be diffed / compared
+struct BenchmarkSuite {
+
+	std::string filter_;
+	int reps_;
+	std::vector<BenchmarkResult> results_;
+	std::vector< std::pair<std::string,std::string> > context_;
+
+	BenchmarkSuite( int reps = 5, std::string const & filter = "" ) : filter_(filter), reps_(std::max(1,reps)) {}
+
+	bool selected( std::string const & name ) const {
+		return filter_.empty() || name.find( filter_ ) != std::string::npos;
+	}
+
+	void add_context( std::string const & key, std::string const & val ){
+		context_.push_back( std::make_pair( key, val ) );
+	}
+
+	template< class F >
+	BenchmarkResult *
+	run( std::string const & name, uint64_t items, F func ){
+		if( !selected(name) ) return nullptr;
+		BenchmarkResult r;
+		r.name = name;
+		r.items = items;
+		r.checksum = func(); // warmup
+		for( int irep = 0; irep < reps_; ++irep ){
+			Timer<std::chrono::high_resolution_clock> t;
+			double const check = func();
+			r.rep_ns.push_back( t.elapsed_nano() );
+			if( check != r.checksum ){
+				std::cerr << "WARNING: benchmark " << name << " checksum changed between reps: "
+				          << r.checksum << " vs " << check << std::endl;
+			}
+		}
+		results_.push_back( r );
+		std::cout << std::left << std::setw(44) << name << std::right
+		          << std::fixed << std::setprecision(3)
+		          << " ns/item " << std::setw(12) << r.ns_per_item( r.median_ns() )
+		          << " min "     << std::setw(12) << r.ns_per_item( r.min_ns() )
+		          << " max "     << std::setw(12) << r.ns_per_item( r.max_ns() )
+		          << std::defaultfloat << std::endl;
+		return &results_.back();
+	}
+
+	static std::string json_escape( std::string const & s ){
+		std::string o;
+		for( char c : s ){
+			if( c == '"' || c == '\\' ) o += '\\';
+			o += c;
+		}
+		return o;
+	}
+	static std::string json_num( double v ){
+		char buf[64];
+		std::snprintf( buf, sizeof(buf), "%.6g", v );
+		return buf;
+	}
+
+	void write_json( std::ostream & out ) const {
+		out << "{\n  \"context\": {";
+		for( size_t i = 0; i < context_.size(); ++i ){
+			out << ( i ? ",\n" : "\n" ) << "    \"" << json_escape(context_[i].first) << "\": \""
+			    << json_escape(context_[i].second) << "\"";
+		}
+		out << "\n  },\n  \"benchmarks\": [";
+		for( size_t i = 0; i < results_.size(); ++i ){
+			BenchmarkResult const & r = results_[i];
+			out << ( i ? ",\n" : "\n" ) << "    {\n";
+			out << "      \"name\": \"" << json_escape(r.name) << "\",\n";
+			out << "      \"time_unit\": \"ns\",\n";
+			out << "      \"items\": " << r.items << ",\n";
+			out << "      \"repetitions\": " << r.rep_ns.size() << ",\n";
+			out << "      \"ns_per_item_median\": " << json_num( r.ns_per_item( r.median_ns() ) ) << ",\n";
+			out << "      \"ns_per_item_min\": "    << json_num( r.ns_per_item( r.min_ns()    ) ) << ",\n";
+			out << "      \"ns_per_item_max\": "    << json_num( r.ns_per_item( r.max_ns()    ) ) << ",\n";
+			out << "      \"items_per_second\": "   << json_num( r.items * 1e9 / r.median_ns() ) << ",\n";
+			out << "      \"checksum\": "           << json_num( r.checksum );
+			for( size_t j = 0; j < r.counters.size(); ++j ){
+				out << ",\n      \"" << json_escape(r.counters[j].first) << "\": " << json_num( r.counters[j].second );
+			}
+			out << "\n    }";
+		}
+		out << "\n  ]\n}\n";
+	}
+
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef INCLUDED_scheme_util_BlockedBloomFilter_HH
+#define INCLUDED_scheme_util_BlockedBloomFilter_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+namespace scheme { namespace util {
+
+///@brief std allocator handing out 64 byte aligned storage, so fixed 64 byte blocks sit on one cache line
+template< class T >
+struct CacheLineAllocator {
+	typedef T value_type;
+	static size_t const Alignment = 64;
+
+	CacheLineAllocator() {}
+	template< class U > CacheLineAllocator( CacheLineAllocator<U> const & ) {}
+	template< class U > struct rebind { typedef CacheLineAllocator<U> other; };
+
+	T * allocate( size_t n ){
+		void * p = nullptr;
+		if( posix_memalign( &p, Alignment, std::max<size_t>( 1, n * sizeof(T) ) ) != 0 ) throw std::bad_alloc();
+		return (T*)p;
+	}
+	void deallocate( T * p, size_t ){ std::free( p ); }
+
+	template< class U > bool operator==( CacheLineAllocator<U> const & ) const { return true; }
+	template< class U > bool operator!=( CacheLineAllocator<U> const & ) const { return false; }
+};
+
+///@brief cache-blocked bloom filter over uint64 keys
+///@detail every key maps to one 512 bit (64 byte) block and sets NBits bits inside it,
+///        so a membership test touches a single cache line. no false negatives;
+///        ~1% false positives at 10 bits per key.
+struct BlockedBloomFilter {
+
+	static int const WordsPerBlock = 8;
+	static int const NBits = 6;
+
+	std::vector< uint64_t, CacheLineAllocator<uint64_t> > words_; // aligned, or blocks would straddle two lines
+	uint64_t nblocks_ = 0;
+
+	BlockedBloomFilter() {}
+	BlockedBloomFilter( uint64_t nkeys, float bits_per_key ) { init( nkeys, bits_per_key ); }
+
+	void init( uint64_t nkeys, float bits_per_key ){
+		uint64_t const nbits = std::max( (uint64_t)512, (uint64_t)( nkeys * bits_per_key ) );
+		nblocks_ = ( nbits + 511 ) / 512;
+		words_.assign( nblocks_ * WordsPerBlock, 0 );
+	}
+
+	void clear() { words_.clear(); nblocks_ = 0; }
+	bool empty() const { return nblocks_ == 0; }
+	size_t mem_use() const { return words_.size() * sizeof(uint64_t); }
+
+	static uint64_t mix( uint64_t k ){ // murmur3 finalizer
+		k ^= k >> 33;
+		k *= 0xff51afd7ed558ccdull;
+		k ^= k >> 33;
+		k *= 0xc4ceb9fe1a85ec53ull;
+		k ^= k >> 33;
+		return k;
+	}
+
+	void insert( uint64_t key ){
+		uint64_t const h = mix( key );
+		uint64_t * block = &words_[ ( h % nblocks_ ) * WordsPerBlock ];
+		uint64_t bits = h >> 10;
+		for( int i = 0; i < NBits; ++i, bits >>= 9 ) block[ (bits>>6)&7 ] |= uint64_t(1) << (bits&63);
+	}
+
+	bool maybe_contains( uint64_t key ) const {
+		uint64_t const h = mix( key );
+		uint64_t const * block = &words_[ ( h % nblocks_ ) * WordsPerBlock ];
+		uint64_t bits = h >> 10;
+		bool hit = true;
+		for( int i = 0; i < NBits; ++i, bits >>= 9 ) hit &= ( block[ (bits>>6)&7 ] >> (bits&63) ) & 1;
+		return hit;
+	}
+
+	bool save( std::ostream & out ) const {
+		out.write( (char*)&nblocks_, sizeof(uint64_t) );
+		out.write( (char*)words_.data(), words_.size()*sizeof(uint64_t) );
+		return out.good();
+	}
+	bool load( std::istream & in ){
+		in.read( (char*)&nblocks_, sizeof(uint64_t) );
+		if( !in.good() ){ clear(); return false; }
+		words_.resize( nblocks_ * WordsPerBlock );
+		in.read( (char*)words_.data(), words_.size()*sizeof(uint64_t) );
+		if( !in.good() ){ clear(); return false; }
+		return true;
+	}
+
+};
+
+}}
+
+#endif
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "scheme/util/MappedArrayFile.hh"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <vector>
+
+namespace scheme { namespace util { namespace test_mapped_array_file {
+
+using std::cout;
+using std::endl;
+
+struct Rec {
+	float x[7];
+	int16_t a, b;
+};
+
+TEST( MappedArrayFile, round_trip ){
+	std::map< std::string, std::vector<Rec> > entries;
+	for( int itag = 0; itag < 5; ++itag ){
+		std::vector<Rec> & v = entries[ "tag" + std::to_string(itag) ];
+		v.resize( itag*itag*37 );
+		for( size_t i = 0; i < v.size(); ++i ){
+			for( int k = 0; k < 7; ++k ) v[i].x[k] = itag*1000 + i + k*0.125;
+			v[i].a = i; v[i].b = -itag;
+		}
+	}
+	std::string const fname = "MappedArrayFile_test.dat";
+	ASSERT_TRUE( MappedArrayFile<Rec>::write( fname, entries ) );
+
+	MappedArrayFile<Rec> maf;
+	ASSERT_TRUE( maf.open( fname ) );
+	ASSERT_EQ( maf.size(), entries.size() );
+	for( auto const & e : entries ){
+		ASSERT_TRUE( maf.has( e.first ) );
+		MappedArrayFile<Rec>::View v = maf.get( e.first );
+		ASSERT_EQ( v.size(), e.second.size() );
+		ASSERT_EQ( (size_t)v.begin() % MappedArrayFile<Rec>::Align, 0 );
+		for( size_t i = 0; i < v.size(); ++i ){
+			ASSERT_EQ( 0, std::memcmp( &v[i], &e.second[i], sizeof(Rec) ) );
+		}
+	}
+	ASSERT_FALSE( maf.has( "nope" ) );
+	ASSERT_TRUE( maf.get( "nope" ).empty() );
+
+	// rewriting under an open mapping leaves the old view intact
+	MappedArrayFile<Rec>::View old = maf.get( "tag3" );
+	std::map< std::string, std::vector<Rec> > fewer;
+	fewer["tag1"] = entries["tag1"];
+	ASSERT_TRUE( MappedArrayFile<Rec>::write( fname, fewer ) );
+	ASSERT_EQ( old[5].x[0], entries["tag3"][5].x[0] );
+	MappedArrayFile<Rec> maf2;
+	ASSERT_TRUE( maf2.open( fname ) );
+	ASSERT_EQ( maf2.size(), 1 );
+	maf2.swap( maf );
+	ASSERT_EQ( maf.size(), 1 );
+	ASSERT_EQ( maf2.size(), entries.size() );
+	ASSERT_EQ( old[5].x[0], maf2.get( "tag3" )[5].x[0] );
+
+	std::remove( fname.c_str() );
+}
+
+TEST( MappedArrayFile, rejects_bad_files ){
+	MappedArrayFile<Rec> maf;
+	ASSERT_FALSE( maf.open( "MappedArrayFile_test_does_not_exist.dat" ) );
+	ASSERT_FALSE( maf.is_open() );
+
+	std::string const fname = "MappedArrayFile_test_bad.dat";
+	std::map< std::string, std::vector<Rec> > entries;
+	entries["a"].resize( 100 );
+	ASSERT_TRUE( MappedArrayFile<Rec>::write( fname, entries ) );
+	ASSERT_FALSE( MappedArrayFile<double>().open( fname ) ); // wrong record size
+
+	{ // truncate into the data
+		std::ifstream in( fname.c_str(), std::ios::binary );
+		std::string s( (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>() );
+		std::ofstream out( fname.c_str(), std::ios::binary );
+		out.write( s.data(), s.size()/2 );
+	}
+	ASSERT_FALSE( maf.open( fname ) );
+
+	{
+		std::ofstream out( fname.c_str(), std::ios::binary );
+		out << "this is not an array file, but it is longer than the header is ............................";
+	}
+	ASSERT_FALSE( maf.open( fname ) );
+	std::remove( fname.c_str() );
+}
+
+TEST( MappedArrayFile, unique_tmp_names ){
+	std::string const a = unique_tmp_name( "cache.dat" ), b = unique_tmp_name( "cache.dat" );
+	ASSERT_EQ( a.compare( 0, 14, "cache.dat.tmp." ), 0 );
+	ASSERT_NE( a, b );
+}
+
+}}}
@@ -0,0 +1,222 @@
+#ifndef INCLUDED_scheme_util_MappedArrayFile_HH
+#define INCLUDED_scheme_util_MappedArrayFile_HH
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "scheme/util/tmp_name.hh"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SCHEME_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace scheme { namespace util {
+
+///@brief read-only, zero-copy access to many named arrays of plain-old-data records kept in one file
+///@detail layout: a 64 byte header (magic, version, record size, entry count, index size), then the
+///        index (per entry: byte offset, record count, tag length, tag), then the raw arrays, each
+///        starting on a 64 byte boundary. open() maps the file shared and read-only, so pages are
+///        faulted in lazily and every process on a node reading the same file shares them. where
+///        mmap is unavailable the file is read into memory instead. T must be trivially copyable.
+template< class T >
+struct MappedArrayFile {
+
+	static uint64_t const Version = 1;
+	static uint64_t const Align = 64;
+
+	struct View {
+		T const * data_ = nullptr;
+		size_t size_ = 0;
+		T const * begin() const { return data_; }
+		T const * end() const { return data_ + size_; }
+		size_t size() const { return size_; }
+		bool empty() const { return size_ == 0; }
+		T const & operator[]( size_t i ) const { return data_[i]; }
+	};
+
+	std::map< std::string, View > index_;
+	std::string fname_;
+	char const * base_ = nullptr;
+	size_t nbytes_ = 0;
+	bool mapped_ = false;
+	std::vector<uint64_t> buffer_; // fallback storage when not mapped
+
+	MappedArrayFile() {}
+	MappedArrayFile( MappedArrayFile const & ) = delete;
+	MappedArrayFile & operator=( MappedArrayFile const & ) = delete;
+	~MappedArrayFile() { close(); }
+
+	void swap( MappedArrayFile & o ){
+		index_.swap( o.index_ );
+		fname_.swap( o.fname_ );
+		std::swap( base_, o.base_ );
+		std::swap( nbytes_, o.nbytes_ );
+		std::swap( mapped_, o.mapped_ );
+		buffer_.swap( o.buffer_ ); // views into the buffer stay valid
+	}
+
+	static void magic( char * m ){ std::memcpy( m, "SCHMARRY", 8 ); }
+
+	bool is_open() const { return base_ != nullptr; }
+	bool is_mapped() const { return mapped_; }
+	size_t size() const { return index_.size(); }
+	bool has( std::string const & tag ) const { return index_.count( tag ) != 0; }
+
+	///@brief empty view if tag is absent
+	View get( std::string const & tag ) const {
+		auto i = index_.find( tag );
+		return i == index_.end() ? View() : i->second;
+	}
+
+	void close(){
+		#ifdef SCHEME_HAVE_MMAP
+		if( mapped_ ) munmap( (void*)base_, nbytes_ );
+		#endif
+		index_.clear();
+		fname_.clear();
+		base_ = nullptr;
+		nbytes_ = 0;
+		mapped_ = false;
+		buffer_.clear();
+		buffer_.shrink_to_fit();
+	}
+
+	///@brief false if the file is missing, truncated, or was written for a different record type
+	bool open( std::string const & fname ){
+		close();
+		if( !map_file( fname ) && !read_file( fname ) ) return false;
+		if( !parse_index() ){ close(); return false; }
+		fname_ = fname;
+		return true;
+	}
+
+	///@brief writes entries (tag -> records) to fname. the file is written under a temporary name
+	///       and renamed into place, so readers never see a partial file and existing mappings of an
+	///       older version stay valid
+	template< class Entries >
+	static bool write( std::string const & fname, Entries const & entries ){
+		uint64_t index_bytes = 0;
+		for( auto const & e : entries ) index_bytes += 3*sizeof(uint64_t) + e.first.size();
+		uint64_t offset = aligned( 64 + index_bytes );
+		std::vector<uint64_t> offsets;
+		for( auto const & e : entries ){
+			offsets.push_back( offset );
+			offset = aligned( offset + e.second.size()*sizeof(T) );
+		}
+
+		std::string const tmpname = unique_tmp_name( fname );
+		{
+			std::ofstream out( tmpname.c_str(), std::ios::binary );
+			if( !out.good() ) return false;
+			char header[64];
+			std::memset( header, 0, 64 );
+			magic( header );
+			uint64_t const hvals[4] = { Version, sizeof(T), (uint64_t)entries.size(), index_bytes };
+			std::memcpy( header+8, hvals, sizeof(hvals) );
+			out.write( header, 64 );
+			size_t ientry = 0;
+			for( auto const & e : entries ){
+				uint64_t const ivals[3] = { offsets[ientry++], (uint64_t)e.second.size(), (uint64_t)e.first.size() };
+				out.write( (char const*)ivals, sizeof(ivals) );
+				out.write( e.first.data(), e.first.size() );
+			}
+			uint64_t pos = 64 + index_bytes;
+			ientry = 0;
+			for( auto const & e : entries ){
+				pad( out, pos, offsets[ientry++] );
+				if( e.second.size() ) out.write( (char const*)&e.second[0], e.second.size()*sizeof(T) );
+				pos += e.second.size()*sizeof(T);
+			}
+			pad( out, pos, offset );
+			out.close();
+			if( !out.good() ){ std::remove( tmpname.c_str() ); return false; }
+		}
+		if( std::rename( tmpname.c_str(), fname.c_str() ) != 0 ){
+			std::remove( tmpname.c_str() );
+			return false;
+		}
+		return true;
+	}
+
+	static uint64_t aligned( uint64_t n ){ return ( n + Align - 1 ) / Align * Align; }
+
+	static void pad( std::ostream & out, uint64_t & pos, uint64_t target ){
+		static char const zeros[Align] = {};
+		out.write( zeros, target - pos );
+		pos = target;
+	}
+
+	bool map_file( std::string const & fname ){
+		#ifdef SCHEME_HAVE_MMAP
+		int fd = ::open( fname.c_str(), O_RDONLY );
+		if( fd < 0 ) return false;
+		struct stat st;
+		if( fstat( fd, &st ) != 0 || st.st_size < 64 ){ ::close( fd ); return false; }
+		void * p = mmap( nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+		::close( fd ); // the mapping holds its own reference
+		if( p == MAP_FAILED ) return false;
+		base_ = (char const*)p;
+		nbytes_ = st.st_size;
+		mapped_ = true;
+		return true;
+		#else
+		return false;
+		#endif
+	}
+
+	bool read_file( std::string const & fname ){
+		std::ifstream in( fname.c_str(), std::ios::binary | std::ios::ate );
+		if( !in.good() ) return false;
+		size_t const n = in.tellg();
+		if( n < 64 ) return false;
+		buffer_.resize( ( n + sizeof(uint64_t) - 1 ) / sizeof(uint64_t) );
+		in.seekg( 0 );
+		in.read( (char*)buffer_.data(), n );
+		if( !in.good() ){ buffer_.clear(); return false; }
+		base_ = (char const*)buffer_.data();
+		nbytes_ = n;
+		return true;
+	}
+
+	bool parse_index(){
+		char m[8];
+		magic( m );
+		if( std::memcmp( base_, m, 8 ) != 0 ) return false;
+		uint64_t hvals[4];
+		std::memcpy( hvals, base_+8, sizeof(hvals) );
+		if( hvals[0] != Version || hvals[1] != sizeof(T) ) return false;
+		uint64_t const nentries = hvals[2], index_bytes = hvals[3];
+		if( 64 + index_bytes > nbytes_ ) return false;
+		char const * p = base_ + 64, * const pend = p + index_bytes;
+		for( uint64_t i = 0; i < nentries; ++i ){
+			uint64_t ivals[3];
+			if( p + sizeof(ivals) > pend ) return false;
+			std::memcpy( ivals, p, sizeof(ivals) );
+			p += sizeof(ivals);
+			if( p + ivals[2] > pend ) return false;
+			if( ivals[0] % Align || ivals[0] > nbytes_ || ivals[1] > ( nbytes_ - ivals[0] ) / sizeof(T) ) return false;
+			View v;
+			v.data_ = (T const*)( base_ + ivals[0] );
+			v.size_ = ivals[1];
+			index_[ std::string( p, ivals[2] ) ] = v;
+			p += ivals[2];
+		}
+		return true;
+	}
+
+};
+
+}}
+
+#endif
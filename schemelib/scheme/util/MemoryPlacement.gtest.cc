@@ -0,0 +1,26 @@
+#include <gtest/gtest.h>
+
+#include "scheme/util/MemoryPlacement.hh"
+
+#include <numeric>
+
+namespace scheme { namespace util { namespace test_memory_placement {
+
+TEST( MemoryPlacement, parse_node_list ){
+	ASSERT_EQ( parse_node_list( "0" ), std::vector<int>({ 0 }) );
+	ASSERT_EQ( parse_node_list( "0-3" ), std::vector<int>({ 0, 1, 2, 3 }) );
+	ASSERT_EQ( parse_node_list( "0-1,4,6-7\n" ), std::vector<int>({ 0, 1, 4, 6, 7 }) );
+	ASSERT_TRUE( parse_node_list( "" ).empty() );
+	ASSERT_FALSE( numa_nodes_with_memory().empty() );
+}
+
+TEST( MemoryPlacement, contents_unchanged ){
+	// whether the kernel honors the hints depends on the machine; the data must survive either way
+	std::vector<uint64_t> data( 3 << 20 );
+	std::iota( data.begin(), data.end(), 0 );
+	place_memory( data.data(), data.size()*sizeof(uint64_t), MemoryPlacement( true, true ) );
+	ASSERT_TRUE( advise_huge_pages( data.data(), 100 ) ); // no whole huge page inside, nothing to do
+	for( size_t i = 0; i < data.size(); ++i ) ASSERT_EQ( data[i], i );
+}
+
+}}}
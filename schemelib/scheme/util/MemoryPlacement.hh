@@ -0,0 +1,120 @@
+#ifndef INCLUDED_scheme_util_MemoryPlacement_HH
+#define INCLUDED_scheme_util_MemoryPlacement_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#define SCHEME_HAVE_MEMORY_PLACEMENT
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace scheme { namespace util {
+
+///@brief where the pages of a large, read-mostly table (a rif, a grid) should live
+///@detail interleave spreads the pages round robin over every numa node with memory, so threads on all
+///        sockets see the same average latency instead of all hitting the node of the thread that
+///        happened to load the table. huge_pages asks for transparent huge pages, cutting the tlb misses
+///        of random lookups into multi-GB tables. both are hints: they are silently skipped where the
+///        kernel doesn't support them, and the table contents never change
+struct MemoryPlacement {
+	bool interleave = false;
+	bool huge_pages = false;
+
+	MemoryPlacement() {}
+	MemoryPlacement( bool interleave_in, bool huge_pages_in ) : interleave( interleave_in ), huge_pages( huge_pages_in ) {}
+
+	bool any() const { return interleave || huge_pages; }
+};
+
+///@brief parses a kernel cpu/node list like "0-3,8,10-11"
+inline std::vector<int> parse_node_list( std::string const & list ){
+	std::vector<int> nodes;
+	std::istringstream in( list );
+	std::string range;
+	while( std::getline( in, range, ',' ) ){
+		int lo, hi;
+		char dash;
+		std::istringstream r( range );
+		if( !( r >> lo ) ) continue;
+		if( r >> dash >> hi && dash == '-' ){
+			for( int i = lo; i <= hi; ++i ) nodes.push_back( i );
+		} else {
+			nodes.push_back( lo );
+		}
+	}
+	return nodes;
+}
+
+///@brief the numa nodes that have memory, {0} if that can't be determined
+inline std::vector<int> numa_nodes_with_memory(){
+	for( char const * fname : { "/sys/devices/system/node/has_memory", "/sys/devices/system/node/online" } ){
+		std::ifstream in( fname );
+		std::string list;
+		if( in.good() && std::getline( in, list ) ){
+			std::vector<int> nodes = parse_node_list( list );
+			if( !nodes.empty() ) return nodes;
+		}
+	}
+	return std::vector<int>( 1, 0 );
+}
+
+namespace impl {
+	///@brief the whole aligned blocks inside [p,p+nbytes); false if there are none
+	inline bool aligned_inside( void const * p, size_t nbytes, uintptr_t align, uintptr_t & begin, uintptr_t & end ){
+		begin = ( (uintptr_t)p + align - 1 ) / align * align;
+		end = ( (uintptr_t)p + nbytes ) / align * align;
+		return begin < end;
+	}
+}
+
+///@brief ask for transparent huge pages over the 2MB blocks inside [p,p+nbytes). existing pages are
+///       collapsed by the kernel in the background. ranges too small to hold one need nothing
+inline bool advise_huge_pages( void const * p, size_t nbytes ){
+	#if defined(SCHEME_HAVE_MEMORY_PLACEMENT) && defined(MADV_HUGEPAGE)
+		uintptr_t begin, end;
+		if( !impl::aligned_inside( p, nbytes, uintptr_t(2) << 20, begin, end ) ) return true;
+		return madvise( (void*)begin, end-begin, MADV_HUGEPAGE ) == 0;
+	#else
+		return false;
+	#endif
+}
+
+///@brief interleave the pages inside [p,p+nbytes) over all numa nodes with memory, moving the ones
+///       already touched. nothing to do on single node machines
+inline bool interleave_pages( void const * p, size_t nbytes ){
+	#if defined(SCHEME_HAVE_MEMORY_PLACEMENT) && defined(SYS_mbind)
+		std::vector<int> const nodes = numa_nodes_with_memory();
+		if( nodes.size() < 2 ) return true;
+		uintptr_t begin, end;
+		if( !impl::aligned_inside( p, nbytes, sysconf( _SC_PAGESIZE ), begin, end ) ) return true;
+		int const bits = 8*sizeof(unsigned long);
+		int maxnode = 0;
+		for( int n : nodes ) maxnode = std::max( maxnode, n+1 );
+		std::vector<unsigned long> mask( ( maxnode + bits - 1 ) / bits, 0 );
+		for( int n : nodes ) mask[ n/bits ] |= 1ul << ( n%bits );
+		int const MPOL_INTERLEAVE_ = 3, MPOL_MF_MOVE_ = 1<<1; // from linux/mempolicy.h
+		// the kernel ignores the last bit of maxnode, hence the +1
+		return syscall( SYS_mbind, begin, end-begin, MPOL_INTERLEAVE_, mask.data(), mask.size()*bits+1, MPOL_MF_MOVE_ ) == 0;
+	#else
+		return false;
+	#endif
+}
+
+///@brief applies placement to [p,p+nbytes). false if the kernel refused (or doesn't support) a requested part
+inline bool place_memory( void const * p, size_t nbytes, MemoryPlacement const & placement ){
+	bool ok = true;
+	if( placement.interleave ) ok &= interleave_pages( p, nbytes );
+	if( placement.huge_pages ) ok &= advise_huge_pages( p, nbytes );
+	return ok;
+}
+
+}}
+
+#endif
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "scheme/util/SpanArena.hh"
+
+#include <utility>
+
+namespace scheme { namespace util { namespace test_span_arena {
+
+typedef std::pair<int,int> P;
+
+TEST( SpanArena, store_and_read ){
+	SpanArena<P> arena( 5 );
+	ArenaSpan<P> unset;
+	ASSERT_FALSE( (bool)unset );
+	ASSERT_TRUE( unset.empty() );
+
+	std::vector<P> a{ P(1,2), P(3,4) }, b{ P(5,6), P(7,8) }, big( 9, P(9,9) );
+	ArenaSpan<P> sa = arena.store( a );
+	ArenaSpan<P> sb = arena.store( b );
+	ArenaSpan<P> se = arena.store( std::vector<P>() );
+	ASSERT_TRUE( (bool)se );
+	ASSERT_TRUE( se.empty() );
+	ASSERT_EQ( sa.block_, sb.block_ ); // shares a block
+	ASSERT_EQ( sa.to_vector(), a );
+	ASSERT_EQ( sb.to_vector(), b );
+	ASSERT_EQ( sb.at(1), P(7,8) );
+
+	ArenaSpan<P> sc = arena.store( b ); // doesn't fit, new block
+	ASSERT_NE( sc.block_, sb.block_ );
+	ArenaSpan<P> sbig = arena.store( big ); // bigger than a block
+	ASSERT_EQ( sbig.to_vector(), big );
+	ASSERT_EQ( sa.to_vector(), a ); // earlier spans untouched
+	ASSERT_EQ( sc.to_vector(), b );
+
+	int sum = 0;
+	for( P const & p : sb ) sum += p.first;
+	ASSERT_EQ( sum, 12 );
+}
+
+struct Point { float score; ArenaSpan<P> rots; };
+
+TEST( SpanArena, compact ){
+	std::vector<Point> points;
+	{
+		SpanArena<P> arena( 4 );
+		for( int i = 0; i < 100; ++i ){
+			std::vector<P> rots( i%3, P(i,i) );
+			points.push_back( Point{ (float)i, i%5 ? arena.store( rots ) : ArenaSpan<P>() } );
+		}
+	}
+	std::vector<Point> kept{ points[1], points[42], points[99], points[50] };
+	points.clear();
+	SpanArena<P> arena;
+	compact_spans( kept, &Point::rots, arena );
+	ASSERT_EQ( kept[0].rots.to_vector(), std::vector<P>( 1, P(1,1) ) );
+	ASSERT_EQ( kept[1].rots.to_vector(), std::vector<P>() );
+	ASSERT_TRUE( (bool)kept[1].rots );
+	ASSERT_EQ( kept[2].rots.to_vector(), std::vector<P>( 0, P(99,99) ) );
+	ASSERT_FALSE( (bool)kept[3].rots ); // unset stays unset
+	ASSERT_EQ( kept[0].rots.block_, kept[1].rots.block_ );
+	ASSERT_EQ( kept[0].rots.block_.use_count(), 4 ); // 3 spans + the arena, the old blocks are gone
+}
+
+}}}
@@ -0,0 +1,79 @@
+#ifndef INCLUDED_scheme_util_SpanArena_HH
+#define INCLUDED_scheme_util_SpanArena_HH
+
+#include "scheme/util/assert.hh"
+#include "scheme/types.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace scheme { namespace util {
+
+///@brief a read-only run of values living in a SpanArena block, referenced by offset and length
+///@detail copying one copies a pointer and two ints rather than a vector. a default constructed span
+///        is "unset", which is different from a stored empty one
+template< class T >
+struct ArenaSpan {
+	typedef T value_type;
+	typedef T const * const_iterator;
+
+	shared_ptr< std::vector<T> const > block_;
+	uint32_t offset_ = 0;
+	uint32_t size_ = 0;
+
+	ArenaSpan() {}
+	ArenaSpan( shared_ptr< std::vector<T> const > block, uint32_t offset, uint32_t size )
+		: block_( block ), offset_( offset ), size_( size ) {}
+
+	explicit operator bool() const { return (bool)block_; }
+	size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	T const * begin() const { return block_ ? block_->data() + offset_ : nullptr; }
+	T const * end() const { return begin() + size_; }
+	T const & operator[]( size_t i ) const { return begin()[i]; }
+	T const & at( size_t i ) const { ALWAYS_ASSERT( i < size_ ); return begin()[i]; }
+	std::vector<T> to_vector() const { return std::vector<T>( begin(), end() ); }
+};
+
+///@brief appends runs of values into large shared blocks so each stored run costs no allocation of its own
+///@detail a block is never reallocated once handed out, so spans stay valid for as long as they hold it; a
+///        block is freed when the last span into it goes away. not thread safe, use one arena per thread
+template< class T >
+class SpanArena {
+public:
+	SpanArena( size_t block_size = 4096 ) : block_size_( std::max<size_t>( 1, block_size ) ) {}
+
+	template< class Iter >
+	ArenaSpan<T> store( Iter begin, Iter end ){
+		size_t const n = std::distance( begin, end );
+		if( !block_ || block_->size() + n > block_->capacity() ){
+			block_ = make_shared< std::vector<T> >();
+			block_->reserve( std::max( block_size_, n ) );
+		}
+		uint32_t const offset = block_->size();
+		block_->insert( block_->end(), begin, end );
+		return ArenaSpan<T>( block_, offset, n );
+	}
+
+	template< class Container >
+	ArenaSpan<T> store( Container const & values ){ return store( values.begin(), values.end() ); }
+
+private:
+	size_t block_size_;
+	shared_ptr< std::vector<T> > block_;
+};
+
+///@brief moves every set span of points[i].*member into arena, letting blocks that mostly held dropped
+///       values go. for after a big filter step
+template< class Point, class T >
+void compact_spans( std::vector<Point> & points, ArenaSpan<T> Point::* member, SpanArena<T> & arena ){
+	for( Point & p : points ){
+		ArenaSpan<T> & span = p.*member;
+		if( span ) span = arena.store( span.begin(), span.end() );
+	}
+}
+
+}}
+
+#endif
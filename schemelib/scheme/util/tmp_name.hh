@@ -0,0 +1,34 @@
+#ifndef INCLUDED_scheme_util_tmp_name_HH
+#define INCLUDED_scheme_util_tmp_name_HH
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SCHEME_HAVE_UNISTD
+#include <unistd.h>
+#endif
+
+namespace scheme { namespace util {
+
+///@brief a name next to fname to write into before renaming onto fname
+///@detail carries the host, pid and a random number, so jobs on different nodes filling the same
+///        cache on a shared filesystem never write the same temp file
+inline std::string unique_tmp_name( std::string const & fname ){
+	std::string host = "localhost";
+	long pid = 0;
+	#ifdef SCHEME_HAVE_UNISTD
+		char buf[256] = {};
+		if( gethostname( buf, sizeof(buf)-1 ) == 0 && buf[0] ) host = buf;
+		pid = (long)getpid();
+	#endif
+	std::random_device rd;
+	std::ostringstream oss;
+	oss << fname << ".tmp." << host << "." << pid << "." << std::hex << rd();
+	return oss.str();
+}
+
+}}
+
+#endif
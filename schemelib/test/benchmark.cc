@@ -0,0 +1,312 @@
+// reproducible micro benchmarks for the hot paths used by rif_dock_test
+//
+// usage: bench_libscheme [--json=out.json] [--filter=substring] [--reps=N] [--scale=F]
+//
+// all inputs are synthetic and generated from fixed seeds, so the "checksum" field
+// in the json output should be identical from run to run; a changed checksum means
+// the benchmark is no longer measuring the same work. --scale multiplies problem sizes.
+//
+// score_rotamer_v_target_sat and the HSearch stages need a rosetta database, rotamer
+// index and target; those belong in a rosetta-side driver, which can reuse
+// scheme/util/Benchmark.hh
+
+#include "scheme/util/Benchmark.hh"
+#include "scheme/objective/hash/XformMap.hh"
+#include "scheme/objective/storage/RotamerScores.hh"
+#include "scheme/objective/voxel/VoxelArray.hh"
+#include "scheme/search/HackPack.hh"
+#include "scheme/nest/NEST.hh"
+#include "scheme/nest/pmap/OriTransMap.hh"
+#include "scheme/kinematics/Director.hh"
+#include "scheme/numeric/rand_xform.hh"
+
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace scheme { namespace bench {
+
+using std::cout;
+using std::endl;
+
+typedef Eigen::Transform<float,3,Eigen::AffineCompact> EigenXform;
+typedef objective::storage::RotamerScores< 12, objective::storage::RotamerScore<> > XMapValue;
+typedef objective::hash::XformMap< EigenXform, XMapValue, objective::hash::XformHash_bt24_BCC6 > XMap;
+
+struct Config {
+	std::string json_fname;
+	std::string filter;
+	int reps = 5;
+	double scale = 1.0;
+	int scaled( int n ) const { return std::max( 1, int( n * scale ) ); }
+};
+
+std::string num2str( double d ){ std::ostringstream oss; oss << d; return oss.str(); }
+
+///////////////////////////////////////////////////////////////////////////////
+// XformMap insert / lookup / save / load  (same value and hasher as the RotScore12 RIF)
+///////////////////////////////////////////////////////////////////////////////
+
+void
+bench_xform_map( util::BenchmarkSuite & suite, Config const & conf )
+{
+	int const N = conf.scaled( 1<<19 );
+	std::mt19937 rng( 4242 );
+	std::vector<EigenXform> xhit( N ), xmiss( N );
+	std::vector<XMapValue> vals( N );
+	for( int i = 0; i < N; ++i ){
+		numeric::rand_xform( rng, xhit[i], 64.0f );
+		numeric::rand_xform( rng, xmiss[i], 64.0f );
+		xmiss[i].translation()[0] += 200.0f; // disjoint region, never inserted
+		vals[i].add_rotamer( i % 400, -float(i%97)/10.0f );
+	}
+	std::vector<EigenXform> xlookup( xhit );
+	std::shuffle( xlookup.begin(), xlookup.end(), rng );
+
+	float const load_factors[] = { 0.3f, 0.5f, 0.8f };
+	for( float lf : load_factors ){
+		std::string const tag = "/lf" + num2str(lf);
+		XMap xmap( 0.5, 16.0 );
+		xmap.map_.max_load_factor( lf );
+		for( int i = 0; i < N; ++i ) xmap.insert( xhit[i], vals[i] );
+		double const actual_lf = double( xmap.size() ) / xmap.map_.bucket_count();
+
+		util::BenchmarkResult * r = suite.run( "xformmap/insert" + tag, N, [&](){
+			XMap m( 0.5, 16.0 );
+			m.map_.max_load_factor( lf );
+			for( int i = 0; i < N; ++i ) m.insert( xhit[i], vals[i] );
+			return double( m.size() );
+		});
+		if( r ) r->counter( "load_factor", actual_lf ).counter( "mem_MB", xmap.mem_use()/1024.0/1024.0 );
+
+		r = suite.run( "xformmap/lookup_hit" + tag, N, [&](){
+			double sum = 0;
+			for( int i = 0; i < N; ++i ) sum += xmap[ xlookup[i] ].score(0);
+			return sum;
+		});
+		if( r ) r->counter( "load_factor", actual_lf );
+
+		r = suite.run( "xformmap/lookup_miss" + tag, N, [&](){
+			double sum = 0;
+			for( int i = 0; i < N; ++i ) sum += xmap[ xmiss[i] ].empty(0);
+			return sum;
+		});
+		if( r ) r->counter( "load_factor", actual_lf );
+	}
+
+	// RIF save/load analog, in memory so disk speed doesn't enter into it
+	XMap xmap( 0.5, 16.0 );
+	for( int i = 0; i < N; ++i ) xmap.insert( xhit[i], vals[i] );
+	std::string buf;
+	{
+		std::ostringstream out( std::ios::binary );
+		xmap.save( out, "bench" );
+		buf = out.str();
+	}
+	util::BenchmarkResult * r = suite.run( "xformmap/save", xmap.size(), [&](){
+		std::ostringstream out( std::ios::binary );
+		xmap.save( out, "bench" );
+		return double( out.str().size() );
+	});
+	if( r ) r->counter( "bytes", buf.size() );
+	suite.run( "xformmap/load", xmap.size(), [&](){
+		std::istringstream in( buf, std::ios::binary );
+		XMap m;
+		m.load( in );
+		return double( m.size() );
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VoxelArray::at, as used by the target field grids
+///////////////////////////////////////////////////////////////////////////////
+
+void
+bench_voxel_array( util::BenchmarkSuite & suite, Config const & conf )
+{
+	typedef objective::voxel::VoxelArray<3,float,float> Grid;
+	typedef util::SimpleArray<3,float> F3;
+	Grid grid( F3(-40,-40,-40), F3(40,40,40), F3(0.25,0.25,0.25) );
+	std::mt19937 rng( 1234 );
+	std::uniform_real_distribution<float> runif;
+	for( size_t i = 0; i < grid.num_elements(); ++i ) grid.data()[i] = runif(rng);
+
+	int const N = conf.scaled( 1<<22 );
+	std::vector<F3> pts_random( N ), pts_walk( N );
+	F3 p( 0, 0, 0 );
+	for( int i = 0; i < N; ++i ){
+		pts_random[i] = F3( runif(rng)*80-40, runif(rng)*80-40, runif(rng)*80-40 );
+		// residue-like walk, consecutive lookups are spatially close
+		for( int k = 0; k < 3; ++k ){
+			p[k] += runif(rng)*3.0f - 1.5f;
+			p[k] = std::max( -39.0f, std::min( 39.0f, p[k] ) );
+		}
+		pts_walk[i] = p;
+	}
+	suite.run( "voxelarray/at_random", N, [&](){
+		double sum = 0;
+		for( int i = 0; i < N; ++i ) sum += grid.at( pts_random[i][0], pts_random[i][1], pts_random[i][2] );
+		return sum;
+	});
+	suite.run( "voxelarray/at_walk", N, [&](){
+		double sum = 0;
+		for( int i = 0; i < N; ++i ) sum += grid.at( pts_walk[i][0], pts_walk[i][1], pts_walk[i][2] );
+		return sum;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// HackPack::pack on a synthetic TwoBodyTable
+///////////////////////////////////////////////////////////////////////////////
+
+void
+bench_hackpack( util::BenchmarkSuite & suite, Config const & conf )
+{
+	typedef objective::storage::TwoBodyTable<float> TBT;
+	int const nres = 60, nrot = 300;
+	std::mt19937 rng( 777 );
+	std::uniform_real_distribution<float> runif;
+	shared_ptr<TBT> twob = make_shared<TBT>( nres, nrot );
+	for( int ir = 0; ir < nres; ++ir ){
+		twob->set_onebody( ir, 0, 0.0 ); // "ALA"
+		for( int irot = 1; irot < nrot; ++irot ) twob->set_onebody( ir, irot, runif(rng)*8.0f - 3.0f );
+	}
+	twob->init_onebody_filter( 2.0 );
+	for( int ir = 0; ir < nres; ++ir ){
+		for( int jr = std::max(0,ir-8); jr < ir; ++jr ){
+			twob->init_twobody( ir, jr );
+			TBT::Array2D & a = twob->twobody_[ir][jr];
+			for( size_t k = 0; k < a.num_elements(); ++k ){
+				float const r = runif(rng);
+				a.data()[k] = r < 0.1f ? 10.0f : r*2.0f - 1.0f;
+			}
+		}
+	}
+
+	// rif-like input: 14 designable residues, ~20 candidate rotamers each
+	std::vector< std::pair<int,int> > tmp_rots;
+	std::vector<float> tmp_1be;
+	for( int ir = 2; ir < nres; ir += 4 ){
+		for( int k = 0; k < 20; ++k ){
+			int const irot = 1 + rng() % (nrot-1);
+			tmp_rots.push_back( std::make_pair( ir, irot ) );
+			tmp_1be.push_back( runif(rng)*4.0f - 3.0f );
+		}
+	}
+
+	search::HackPackOpts opts;
+	search::HackPack packer( opts, 0 );
+	int const npack = conf.scaled( 200 );
+	std::vector< std::pair<int32_t,int32_t> > result;
+	suite.run( "hackpack/pack", npack, [&](){
+		packer.rng.seed( 31337 );
+		double sum = 0;
+		for( int ipack = 0; ipack < npack; ++ipack ){
+			packer.reinitialize( twob );
+			for( size_t i = 0; i < tmp_rots.size(); ++i ){
+				packer.add_tmp_rot( tmp_rots[i].first, tmp_rots[i].second, tmp_1be[i] );
+			}
+			result.clear();
+			sum += packer.pack( result );
+		}
+		return sum;
+	});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// NestDirector::set_scene with the 6D OriTransMap nest, with and without ori cache
+///////////////////////////////////////////////////////////////////////////////
+
+struct BenchScene : public kinematics::SceneBase<EigenXform,uint64_t>
+{
+	BenchScene() : kinematics::SceneBase<EigenXform,uint64_t>() {}
+	virtual ~BenchScene(){}
+	void add_position( EigenXform const & x ) {
+		this->positions_.push_back(x);
+		update_symmetry(positions_.size());
+	}
+	virtual shared_ptr<kinematics::SceneBase<EigenXform,uint64_t> > clone_deep() const { return make_shared<BenchScene>(*this); }
+};
+
+void
+bench_director( util::BenchmarkSuite & suite, Config const & conf )
+{
+	typedef nest::NEST< 6, EigenXform, nest::pmap::OriTransMap, util::StoreNothing, uint64_t, float, false > NestOriTrans6D;
+	typedef kinematics::NestDirector< NestOriTrans6D, uint64_t > NestDirector;
+	typedef util::SimpleArray<3,float> F3;
+	typedef util::SimpleArray<3,int> I3;
+
+	NestDirector plain( 30.0, F3(-16,-16,-16), F3(16,16,16), I3(32,32,32), 1 );
+	NestDirector cached( plain );
+	cached.init_ori_cache( 4, size_t(512)*1024*1024 );
+
+	BenchScene scene;
+	scene.add_position( EigenXform::Identity() );
+	scene.add_position( EigenXform::Identity() );
+
+	int const N = conf.scaled( 1<<20 );
+	for( int resl = 2; resl <= 4; resl += 2 ){
+		uint64_t const size = plain.size( resl, 0 );
+		uint64_t const stride = std::max( (uint64_t)1, size / N ) | 1;
+		std::string const tag = "/resl" + num2str(resl);
+		for( int use_cache = 0; use_cache < 2; ++use_cache ){
+			NestDirector const & d = use_cache ? cached : plain;
+			suite.run( std::string("director/set_scene") + (use_cache?"_cached":"") + tag, N, [&](){
+				double sum = 0;
+				for( int i = 0; i < N; ++i ){
+					if( d.set_scene( (i*stride) % size, resl, scene ) ){
+						sum += scene.position(1).translation()[0];
+					}
+				}
+				return sum;
+			});
+		}
+	}
+}
+
+}}
+
+int main( int argc, char *argv[] )
+{
+	using namespace scheme::bench;
+	Config conf;
+	for( int i = 1; i < argc; ++i ){
+		std::string const arg( argv[i] );
+		if(      arg.find("--json="  ) == 0 ) conf.json_fname = arg.substr(7);
+		else if( arg.find("--filter=") == 0 ) conf.filter     = arg.substr(9);
+		else if( arg.find("--reps="  ) == 0 ) conf.reps       = std::stoi( arg.substr(7) );
+		else if( arg.find("--scale=" ) == 0 ) conf.scale      = std::stod( arg.substr(8) );
+		else {
+			std::cerr << "usage: " << argv[0] << " [--json=out.json] [--filter=substring] [--reps=N] [--scale=F]" << std::endl;
+			return 1;
+		}
+	}
+
+	scheme::util::BenchmarkSuite suite( conf.reps, conf.filter );
+	suite.add_context( "suite", "bench_libscheme" );
+	suite.add_context( "reps", num2str(conf.reps) );
+	suite.add_context( "scale", num2str(conf.scale) );
+	#ifdef __VERSION__
+		suite.add_context( "compiler", __VERSION__ );
+	#endif
+	#ifdef NDEBUG
+		suite.add_context( "build", "release" );
+	#else
+		suite.add_context( "build", "debug" );
+	#endif
+
+	bench_xform_map  ( suite, conf );
+	bench_voxel_array( suite, conf );
+	bench_hackpack   ( suite, conf );
+	bench_director   ( suite, conf );
+
+	if( conf.json_fname.size() ){
+		std::ofstream out( conf.json_fname.c_str() );
+		if( !out ){
+			std::cerr << "can't open " << conf.json_fname << std::endl;
+			return 1;
+		}
+		suite.write_json( out );
+	}
+	return 0;
+}